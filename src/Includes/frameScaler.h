@@ -0,0 +1,49 @@
+#ifndef SIMPLEVIDEOEDITOR_FRAMESCALER_H
+#define SIMPLEVIDEOEDITOR_FRAMESCALER_H
+
+#include <QImage>
+#include <QRect>
+#include <QSize>
+#include <QVideoFrame>
+#include <vector>
+
+// Fused YUV -> RGB32 convert + area downscale for the preview worker.
+//
+// QVideoFrame::toImage() converts the whole decoded frame to RGB at full
+// resolution, and the preview then smooth-scales that down again; for a 4K
+// screen recording that is two full-res passes per frame just to show a
+// ~1280px picture. Here the NV12/YUV420P planes are read straight from the
+// mapped frame, box-averaged down to the target size and converted to RGB
+// only at output resolution, written into a caller-owned RGB32 image that is
+// reused across frames.
+class FrameScaler {
+public:
+    // True for frames the fused path handles: NV12/NV21/YUV420P/YV12,
+    // BT.601/BT.709 color, no rotation or mirroring.
+    static bool supports(const QVideoFrame &frame);
+
+    // Scales `frame` to fit `bounds` (aspect kept, like
+    // QImage::scaled(..., Qt::KeepAspectRatio)) into `dst`. `dst` is only
+    // reallocated when the output size changes or it is shared. Returns false
+    // (leaving `dst` untouched) when the frame isn't supported, would need
+    // upscaling, or can't be mapped; the caller falls back to toImage().
+    // `fast` samples one source row per output row instead of averaging all
+    // of them: rougher, but reads a fraction of the frame.
+    bool scale(const QVideoFrame &frame, const QSize &bounds, QImage &dst, bool fast = false);
+
+    // Converts just `rect` (clipped to the frame) at native resolution into
+    // `dst`, reallocated only when the region size changes. Chroma is taken
+    // from the co-sited 2x2 sample, like a nearest upsample. Same fallback
+    // contract as scale(). Stateless, so it is safe from any thread.
+    static bool convertRegion(const QVideoFrame &frame, const QRect &rect, QImage &dst);
+
+private:
+    // Per-call scratch, grow-only. Only the preview worker uses an instance.
+    std::vector<int> m_colStart;     // output column -> first source column (n+1 entries)
+    std::vector<quint16> m_lumaAcc;  // source row sums over one output row's span
+    std::vector<quint16> m_chromaAcc[2];
+    std::vector<float> m_colInv;     // 1 / luma span width per output column
+    std::vector<float> m_chromaColInv;
+};
+
+#endif // SIMPLEVIDEOEDITOR_FRAMESCALER_H
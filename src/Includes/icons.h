@@ -195,6 +195,22 @@ inline QIcon snapshot(const QColor &c) {
     }, c, 8.0);
 }
 
+// magnifier / 1:1 loupe
+inline QIcon magnifier(const QColor &c) {
+    return makeIcon([](QPainter &p, const QRectF &) {
+        p.drawEllipse(QPointF(43, 43), 24, 24);
+        p.drawLine(QPointF(61, 61), QPointF(82, 82));
+    }, c);
+}
+
+// scopes: waveform trace over a baseline
+inline QIcon scopes(const QColor &c) {
+    return makeIcon([](QPainter &p, const QRectF &) {
+        p.drawLine(QPointF(16, 80), QPointF(84, 80));
+        p.drawPolyline(QPolygonF({{16, 62}, {30, 36}, {44, 56}, {58, 24}, {72, 48}, {84, 40}}));
+    }, c, 8.0);
+}
+
 // scissors / split
 inline QIcon split(const QColor &c) {
     return makeIcon([](QPainter &p, const QRectF &) {
@@ -31,6 +31,7 @@
 #include <QStringList>
 #include <QIcon>
 #include "titlebar.h"
+#include "motionTracker.h"
 
 class QHBoxLayout;
 class QShortcut;
@@ -57,7 +58,7 @@ public:
         QString importButtonText = "IMPORT";
         int sidebarWidth = 260;
         QString sidebarPosition = "left";
-        QString toolButtonOrder = "text,blur,pixel,blackout,shape,colorcorrect,autocut,settings,resetcrop,speedramp";
+        QString toolButtonOrder = "text,blur,pixel,blackout,shape,colorcorrect,image,autocut,settings,resetcrop,speedramp,track";
         float defaultCropTop = 0.03f;
         float defaultCropBottom = 0.96f;
         float defaultCropLeft = 0.0f;
@@ -67,6 +68,12 @@ public:
         QString emptyTransportHint = "SPACE PLAY/PAUSE | S SPLIT | CTRL+C EXPORT";
         QString videoTransportHint = "SPACE PLAY/PAUSE | S SPLIT | CTRL+C EXPORT VIDEO";
         QString audioTransportHint = "SPACE PLAY/PAUSE | S SPLIT | CTRL+SHIFT+C EXPORT AUDIO";
+        int previewQualityTier = -1; // -1 = automatic, else a VideoWithCropWidget::QualityTier
+        int scopesRefreshHz = 10;
+        bool autoRenderCache = false;
+        int previewThreads = 0;  // worker pool sizes, 0 = automatic
+        int analysisThreads = 0;
+        int ioThreads = 0;
         QString timelineAccentColor = "#FF7A50";
         QString timelineSecondaryColor = "#FF5C33";
         QString timelineBackgroundColor = "#121217";
@@ -148,12 +155,22 @@ private:
     QString buildAppStyleSheet() const;
     // Overlay clip <-> preview sync (regions shown/edited on the video)
     void syncOverlaysToPreview();
+    // Playback tick: applies only the overlays that started/ended since the
+    // last call, and only when the playhead crossed a schedule boundary.
+    void updatePreviewOverlays(qint64 timelinePosMs);
     void editTextOverlay(int index);
     void editOverlayProperties(int index);
     void openSpeedRampDialog();
+    // Tracks the selected overlay's region from the playhead to the end of
+    // its clip (or cancels a running track).
+    void trackSelectedOverlay();
     void showHistoryMenu();
     // Multi-source playback: seek in timeline time, switching files as needed
     void seekTimeline(qint64 timelinePosMs);
+    // Render cache: while playing through a rendered range, a muted second
+    // player feeds the preview the baked clip in step with `player`.
+    void updateRenderCachePlayback(qint64 timelinePosMs);
+    void stopRenderCachePlayback();
     void updateTimelineChips();
     QLineEdit* exportInput;
     QVBoxLayout* mainLayout;
@@ -190,6 +207,9 @@ private:
     QPushButton* jumpFwdBtn;
     QPushButton* muteBtn;
     QPushButton* snapshotBtn;
+    QPushButton* loupeBtn;
+    QPushButton* scopesBtn;
+    ScopesWidget* scopesPanel;
     QComboBox* speedBox;
     QPushButton* exportBtn;
     QMenu* exportMenu;
@@ -220,12 +240,15 @@ private:
     QLabel* sidebarEmptyLabel;
     QSlider* volSlider;
     QLabel* timecodeLabel;
+    QLabel* previewQualityChip;
     QSlider* timelineZoomSlider;
     QPushButton* timelineFitBtn;
     void updateTimecodeDisplay();
     // Media
     QMediaPlayer* player;
     QAudioOutput* audio;
+    QMediaPlayer* cachePlayer;
+    QString cachePlayerPath; // clip cachePlayer has loaded, empty when live
     bool isUpdating = false;
     QPushButton *toggleFilterBtn;
     QPushButton *blurBtn;
@@ -234,7 +257,12 @@ private:
     QPushButton *textBtn;
     QPushButton *shapeBtn;
     QPushButton *colorCorrectBtn;
+    QPushButton *imageBtn;
     QPushButton *speedRampBtn;
+    QPushButton *trackMotionBtn;
+    MotionTracker *motionTracker;
+    int trackingOverlayIdx = -1;  // overlay the running track is for
+    qint64 trackingStartMs = 0;   // timeline time the track started at
     QFrame* clipSidebar;
     QScrollArea* sidebarScroll;
     QWidget* sidebarContent;
@@ -247,6 +275,8 @@ private:
     QProgressBar* exportProgressBar;
     // Which overlay each preview region maps to (index into timeline->overlays)
     QList<int> previewOverlayMap;
+    int previewOverlaySlot = -1;        // schedule slot previewOverlayMap reflects
+    quint64 previewOverlayRevision = 0; // ...and the schedule revision it's from (0: none)
     bool syncingPreview = false;
     // Multi-source playback state
     int activeSourceIdx = 0;
@@ -13,11 +13,23 @@
 #include <QList>
 #include <QString>
 #include <QtConcurrent>
-#include <QMutex>
+#include <QThread>
 #include <QMimeData>
 #include <QDragEnterEvent>
 #include <QDropEvent>
+#include <QtMath>
+#include <QElapsedTimer>
+#include <cstring>
 #include "overlayShapes.h"
+#include "previewEffects.h"
+#include "frameScaler.h"
+#include "tripleBuffer.h"
+#include "videoScopes.h"
+#include "workerPools.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 class VideoWithCropWidget : public QWidget {
     Q_OBJECT
@@ -28,7 +40,7 @@ class VideoWithCropWidget : public QWidget {
 public:
     struct FilterObject {
         float l, t, r, b;
-        int mode;      // 0: Blur, 1: Pixelate, 2: SolidColor, 3: Text, 4: Shape, 5: ColorCorrect
+        int mode;      // 0: Blur, 1: Pixelate, 2: SolidColor, 3: Text, 4: Shape, 5: ColorCorrect, 6: Image
         QString text;  // only used by mode 3
         // mode 4 (shape/arrow)
         int shapeKind = 0;
@@ -38,9 +50,23 @@ public:
         float brightness = 0.0f;
         float contrast = 1.0f;
         float saturation = 1.0f;
+        // mode 6 (image/logo)
+        QString imagePath;
+        float opacity = 1.0f;
+
+        bool operator==(const FilterObject &o) const {
+            return l == o.l && t == o.t && r == o.r && b == o.b && mode == o.mode && text == o.text
+                   && shapeKind == o.shapeKind && shapeColor == o.shapeColor && shapeThickness == o.shapeThickness
+                   && brightness == o.brightness && contrast == o.contrast && saturation == o.saturation
+                   && imagePath == o.imagePath && opacity == o.opacity;
+        }
+        bool operator!=(const FilterObject &o) const { return !(*this == o); }
     };
 
     QVideoSink* sink;
+    // Frames from the timeline's render cache: overlays already baked into
+    // the pixels, so they are shown without compositing (see setBakedOverlays).
+    QVideoSink* bakedSink;
     QImage lastFrame;
     QPointF lastMousePos;
     QList<FilterObject> filterObjects;
@@ -58,160 +84,771 @@ public:
     enum Edge { None, Center, TopLeft, TopRight, BottomLeft, BottomRight };
     Edge activeEdge = None;
 
-    // PERFORMANCE: Atomic flag and mutex for off-thread frame processing
-    QAtomicInt m_isProcessing{0};
-    // Set when a rescale request arrives while the worker is busy, so the
-    // last request is never silently dropped (matters when paused: no new
-    // frame would ever re-trigger the composite).
-    QAtomicInt m_pendingRescale{0};
-    QMutex m_frameMutex;
+    // Where preview frames go: received from the sink, composited by the
+    // worker, presented by paintEvent. Frames dropped before compositing were
+    // superseded while the worker was busy; frames dropped before painting
+    // were composited but replaced before the GUI got to paint them.
+    struct PreviewStats {
+        quint64 received = 0;
+        quint64 composited = 0;
+        quint64 presented = 0;
+        quint64 droppedBeforeComposite = 0;
+        quint64 droppedBeforePaint = 0;
+    };
+
+    // Preview quality tiers, best first. During playback the worker's governor
+    // steps down a tier while composites overrun the frame interval and back
+    // up once there is headroom again; paused frames always render at Full.
+    // A tier can also be pinned from the settings dialog.
+    enum QualityTier { QualityFull = 0, QualityStandard, QualityFast, QualityDraft, QualityTierCount };
+    struct TierSettings {
+        qreal scale;       // internal resolution relative to the on-screen size
+        bool useDpr;       // scale by the screen's device pixel ratio too
+        bool fastScaling;  // sample instead of filtering when downscaling
+        int blurPower;     // box blur passes per axis
+    };
+    static TierSettings tierSettings(int tier) {
+        switch (tier) {
+        case QualityStandard: return {1.0, false, false, PreviewEffects::kBlurPower};
+        case QualityFast: return {0.75, false, true, PreviewEffects::kBlurPower};
+        case QualityDraft: return {0.5, false, true, 1};
+        default: return {1.0, true, false, PreviewEffects::kBlurPower};
+        }
+    }
+    static QString tierName(int tier) {
+        switch (tier) {
+        case QualityStandard: return "1X";
+        case QualityFast: return "FAST";
+        case QualityDraft: return "DRAFT";
+        default: return "FULL";
+        }
+    }
+
+    // GUI thread only.
     QVideoFrame m_lastRawFrame;
+    QVideoFrame m_liveFrame;     // newest frame from `sink`, kept while baked
+    bool m_bakedOverlays = false; // show bakedSink frames instead of `sink`
+    bool m_frameBaked = false;    // m_lastRawFrame came from bakedSink
+    // 1:1 magnifier. The worker renders the region under the cursor from
+    // the raw frame at native resolution; paint follows the cursor with
+    // the newest one it has.
+    static constexpr int kLoupeSize = 200; // logical px
+    bool m_loupeEnabled = false;
+    bool m_loupeHover = false;
+    QPoint m_loupePos;
+    QImage m_loupeImage;
+    QPointF m_loupeCursor; // cursor inside m_loupeImage, image px
+    quint64 m_frameSerial = 0; // bumped per sink frame; identifies m_lastRawFrame
+    QElapsedTimer m_frameClock;
+    double m_frameIntervalMs = 1000.0 / 30.0; // smoothed sink frame spacing
+    bool m_playbackActive = false;
+    int m_pinnedTier = -1; // -1: governed
+    int m_shownTier = -1;
+
+    // PERFORMANCE: decode -> composite -> paint handoff. Two lock-free triple
+    // buffers: the GUI publishes composite requests (frame + overlay state)
+    // to the worker, the worker publishes finished frames back to paintEvent.
+    // Neither side ever waits; newer entries just replace unconsumed ones.
+    struct PreviewRequest {
+        QVideoFrame frame;
+        quint64 serial = 0;
+        QSize targetSize;   // render size (tier scale applied)
+        qreal pixelRatio = 1.0; // render size / on-screen size
+        int tier = QualityFull;
+        bool governed = false;  // playing with no pinned tier: feed the governor
+        double frameIntervalMs = 0;
+        QList<FilterObject> filters;
+        bool baked = false;          // render-cache frame, not the source's
+        QPointF loupeCenter{-1, -1}; // normalized; negative: no loupe
+        QSize loupeSize;             // device px (shown 1:1)
+        qreal loupeRatio = 1.0;
+    };
+    TripleBuffer<PreviewRequest> m_requests;
+    // Set while a worker task is draining requests (at most one at a time).
+    QAtomicInt m_workerActive{0};
+    // The last worker task started. GUI thread only; the destructor waits
+    // on it, since the task still reads m_requests after clearing the flag.
+    QFuture<void> m_workerTask;
+    // Governor output, read by the GUI when building requests.
+    QAtomicInt m_governedTier{QualityFull};
+    // Governor state, worker only.
+    double m_compositeMsAvg = 0;
+    int m_overBudgetRun = 0;
+    int m_headroomRun = 0;
+    // Effect-kernel scratch (color tables, ...). Only the worker touches it.
+    PreviewEffects::Workspace m_effects;
+    // One more per concurrent band job of the parallel compositor (job i
+    // always runs on m_bandEffects[i]), grown on demand.
+    std::vector<std::unique_ptr<PreviewEffects::Workspace>> m_bandEffects;
+    // Below this many overlays a frame is composited on the worker alone;
+    // fanning out a couple of regions costs more than it saves.
+    static constexpr int kParallelMinFilters = 4;
+    // Worker-side frame state. m_baseFrame is the scaled, unfiltered frame,
+    // rebuilt only when the raw frame or the target size changes; overlay
+    // edits on a paused frame recomposite from it without rescaling.
+    FrameScaler m_frameScaler;
+    QImage m_baseFrame;
+    quint64 m_baseSerial = 0;
+    QSize m_baseBounds;
+    bool m_baseFast = false;
+    QSize m_baseSourceSize;
+    quint64 m_lastCompositedSerial = 0;
+    // Composited output, handed to paintEvent through a triple buffer. Each
+    // slot remembers which frame and filter list it holds, so the next pass
+    // into it only redoes the pixels whose filters changed since then.
+    struct CompositeSlot {
+        QImage image;
+        quint64 frameSerial = 0;
+        int tier = QualityFull;
+        QList<FilterObject> filters;
+        quint64 compositedCount = 0; // worker's `composited` total when made
+        QImage loupe;                // native-resolution region, null if none
+        QPointF loupeCursor;
+    };
+    TripleBuffer<CompositeSlot> m_composites;
+    QImage m_loupeSource; // worker: raw region converted for the loupe
+    // Fed by the worker after each publish; analyses run on their own task.
+    ScopeAnalyzer m_scopes;
+    quint64 m_presentedSerial = 0; // GUI thread only
+
+    std::atomic<quint64> m_statReceived{0};
+    std::atomic<quint64> m_statComposited{0};
+    std::atomic<quint64> m_statPresented{0};
+    std::atomic<quint64> m_statDroppedBeforeComposite{0};
+    std::atomic<quint64> m_statDroppedBeforePaint{0};
 
     explicit VideoWithCropWidget(QWidget* parent = nullptr) : QWidget(parent) {
         sink = new QVideoSink(this);
+        bakedSink = new QVideoSink(this);
         setMouseTracking(true);
         setFocusPolicy(Qt::StrongFocus);
         setAcceptDrops(true); // effect buttons can be dragged straight onto the video
         this->setAttribute(Qt::WA_StyledBackground, true);
 
         connect(sink, &QVideoSink::videoFrameChanged, this, [this](const QVideoFrame &frame){
-            if (!frame.isValid()) return;
-            
-            {
-                QMutexLocker locker(&m_frameMutex);
-                m_lastRawFrame = frame;
-            }
-
-            triggerScale();
+            receiveFrame(frame, false);
+        });
+        connect(bakedSink, &QVideoSink::videoFrameChanged, this, [this](const QVideoFrame &frame){
+            receiveFrame(frame, true);
         });
     }
 
-    // Per-pixel brightness/contrast/saturation, applied in place to a cropped
-    // sub-image (mirrors ffmpeg's eq= filter used for the same overlay at export).
-    static void applyColorCorrection(QImage &img, float brightness, float contrast, float saturation) {
-        if (qFuzzyIsNull(brightness) && qFuzzyCompare(contrast, 1.0f) && qFuzzyCompare(saturation, 1.0f)) return;
-        img = img.convertToFormat(QImage::Format_ARGB32);
-        const int h = img.height();
-        const int w = img.width();
-        for (int y = 0; y < h; ++y) {
-            auto *line = reinterpret_cast<QRgb *>(img.scanLine(y));
-            for (int x = 0; x < w; ++x) {
-                const QRgb px = line[x];
-                int r = qRed(px), g = qGreen(px), b = qBlue(px);
-                r = qBound(0, qRound((r - 128) * contrast + 128 + brightness * 255), 255);
-                g = qBound(0, qRound((g - 128) * contrast + 128 + brightness * 255), 255);
-                b = qBound(0, qRound((b - 128) * contrast + 128 + brightness * 255), 255);
-                const double gray = 0.299 * r + 0.587 * g + 0.114 * b;
-                r = qBound(0, qRound(gray + (r - gray) * saturation), 255);
-                g = qBound(0, qRound(gray + (g - gray) * saturation), 255);
-                b = qBound(0, qRound(gray + (b - gray) * saturation), 255);
-                line[x] = qRgba(r, g, b, qAlpha(px));
-            }
+    ~VideoWithCropWidget() override {
+        // The worker holds `this`; let the task run out (nothing new can be
+        // published any more) before the members go away.
+        m_workerTask.waitForFinished();
+    }
+
+    // Switches the preview between the live source (overlays composited per
+    // frame) and bakedSink. The live frame keeps showing, overlays included,
+    // until the first baked frame arrives; switching back restores the
+    // newest live frame straight away.
+    void setBakedOverlays(bool on) {
+        if (m_bakedOverlays == on) return;
+        m_bakedOverlays = on;
+        m_frameClock.invalidate();
+        if (!on && m_frameBaked && m_liveFrame.isValid()) {
+            m_lastRawFrame = m_liveFrame;
+            m_frameBaked = false;
+            ++m_frameSerial;
+            triggerScale();
         }
     }
+    bool bakedOverlays() const { return m_bakedOverlays; }
+
+    // Playing: let the governor trade quality for frame rate. Paused:
+    // re-render the current frame at full quality.
+    void setPlaybackActive(bool playing) {
+        if (m_playbackActive == playing) return;
+        m_playbackActive = playing;
+        m_frameClock.invalidate();
+        triggerScale();
+    }
+
+    // -1 lets the governor choose; 0..QualityTierCount-1 pins a tier.
+    void setPinnedQualityTier(int tier) {
+        m_pinnedTier = (tier >= 0 && tier < QualityTierCount) ? tier : -1;
+        m_shownTier = -1; // re-announce: the "pinned" state shows in the UI too
+        triggerScale();
+    }
+
+    int effectiveQualityTier() const {
+        if (m_pinnedTier >= 0) return m_pinnedTier;
+        return m_playbackActive ? m_governedTier.loadRelaxed() : int(QualityFull);
+    }
+
+    void setLoupeEnabled(bool on) {
+        if (m_loupeEnabled == on) return;
+        m_loupeEnabled = on;
+        m_loupeHover = false;
+        m_loupeImage = QImage();
+        if (on) setCursor(Qt::CrossCursor);
+        else unsetCursor();
+        update();
+    }
+    bool loupeEnabled() const { return m_loupeEnabled; }
+
+    // Scopes measured on the composited preview (see ScopesWidget).
+    ScopeAnalyzer *scopeAnalyzer() { return &m_scopes; }
+
+    PreviewStats previewStats() const {
+        PreviewStats stats;
+        stats.received = m_statReceived.load(std::memory_order_relaxed);
+        stats.composited = m_statComposited.load(std::memory_order_relaxed);
+        stats.presented = m_statPresented.load(std::memory_order_relaxed);
+        stats.droppedBeforeComposite = m_statDroppedBeforeComposite.load(std::memory_order_relaxed);
+        stats.droppedBeforePaint = m_statDroppedBeforePaint.load(std::memory_order_relaxed);
+        return stats;
+    }
 
     // PERFORMANCE: baking blur/pixelate/blackout boxes into the frame is expensive
-    // (sub-image copy + two scales per box). This must never run on the UI thread's
+    // (full-region filter passes per box). This must never run on the UI thread's
     // paintEvent, or every repaint during playback (30-60/sec) stalls input handling.
     // It runs here, in the same background worker that already scales the raw frame.
-    static void compositeFilters(QImage &target, const QList<FilterObject> &filters) {
+    // `sourceScale` is preview pixels per source pixel, so blur radius and mosaic
+    // block size can be expressed in source pixels exactly like the export does.
+    // With a non-empty `clip`, only filters whose footprint touches it are
+    // applied (the caller guarantees none straddle its edge).
+    static void compositeFilters(QImage &target, const QList<FilterObject> &filters, double sourceScale,
+                                 PreviewEffects::Workspace &ws, int blurPower = PreviewEffects::kBlurPower,
+                                 const QRect &clip = QRect()) {
         if (filters.isEmpty()) return;
+        // Areas are in image pixels; keep QPainter from scaling them by the
+        // HiDPI ratio the image carries for display.
+        const qreal pixelRatio = target.devicePixelRatio();
+        target.setDevicePixelRatio(1.0);
         QPainter ip(&target);
         for (const auto &obj : filters) {
-            int x = obj.l * target.width();
-            int y = obj.t * target.height();
-            int w = (obj.r - obj.l) * target.width();
-            int h = (obj.b - obj.t) * target.height();
-            QRect area(x, y, w, h);
-            if (w <= 0 || h <= 0) continue;
-
-            if (obj.mode == 0 || obj.mode == 1) {
-                QImage sub = target.copy(area);
-                int scale = (obj.mode == 0) ? 10 : 30;
-                QImage small = sub.scaled(qMax(1, w / scale), qMax(1, h / scale), Qt::IgnoreAspectRatio, Qt::FastTransformation);
-                QImage blurred = small.scaled(w, h, Qt::IgnoreAspectRatio, (obj.mode == 0 ? Qt::SmoothTransformation : Qt::FastTransformation));
-                ip.drawImage(x, y, blurred);
-            } else if (obj.mode == 2) {
-                ip.fillRect(area, Qt::black);
-            } else if (obj.mode == 4) {
-                OverlayShapes::paint(ip, QRectF(area), obj.shapeKind, obj.shapeColor, obj.shapeThickness);
-            } else if (obj.mode == 5) {
-                QImage sub = target.copy(area);
-                applyColorCorrection(sub, obj.brightness, obj.contrast, obj.saturation);
-                ip.drawImage(x, y, sub);
-            } else { // Text overlay: mirrors ffmpeg drawtext (white, dark outline, centered)
-                ip.setRenderHint(QPainter::Antialiasing);
-                ip.setRenderHint(QPainter::TextAntialiasing);
-                QFont font;
-                font.setBold(true);
-                font.setPixelSize(qMax(8, qRound(h * 0.6)));
-                const QString text = obj.text.isEmpty() ? QStringLiteral("Your text") : obj.text;
-
-                QPainterPath path;
-                QFontMetrics fm(font);
-                const QRect textBounds = fm.boundingRect(area, Qt::AlignCenter | Qt::TextWordWrap, text);
-                int lineY = textBounds.top() + fm.ascent();
-                for (const QString &line : text.split('\n')) {
-                    const int lineW = fm.horizontalAdvance(line);
-                    path.addText(area.center().x() - lineW / 2.0, lineY, font, line);
-                    lineY += fm.lineSpacing();
-                }
-                ip.setPen(QPen(QColor(0, 0, 0, 170), qMax(2.0, h * 0.05)));
-                ip.setBrush(Qt::white);
-                ip.drawPath(path);
-                ip.setPen(Qt::NoPen);
-                ip.drawPath(path);
+            const QRect area = filterArea(obj, target.size());
+            if (area.width() <= 0 || area.height() <= 0) continue;
+            if (!clip.isEmpty() && !filterFootprint(obj, area).intersects(clip)) continue;
+            applyFilter(ip, target, obj, area, sourceScale, ws, blurPower);
+        }
+        ip.end();
+        target.setDevicePixelRatio(pixelRatio);
+    }
+
+    // One overlay onto `img`; `area` is in `img` pixels.
+    static void applyFilter(QPainter &ip, QImage &img, const FilterObject &obj, const QRect &area, double sourceScale,
+                            PreviewEffects::Workspace &ws, int blurPower) {
+        const int w = area.width(), h = area.height();
+        if (obj.mode == 0) {
+            // boxblur=20 (power 2) on the source-sized region, scaled to the preview.
+            const int srcRadius = qMin(PreviewEffects::kBlurRadius, int(qMin(w, h) / sourceScale) / 2);
+            const int radius = qMax(1, qRound(srcRadius * sourceScale));
+            PreviewEffects::boxBlur(img, area, radius, blurPower, ws);
+        } else if (obj.mode == 1) {
+            // scale=iw/30:-1 then a neighbor upscale: one cell per 30 source pixels.
+            const int cols = qMax(1, int(w / sourceScale) / PreviewEffects::kPixelateBlock);
+            const int rows = qMax(1, qRound(double(cols) * h / w));
+            PreviewEffects::pixelate(img, area, cols, rows, ws);
+        } else if (obj.mode == 2) {
+            ip.fillRect(area, Qt::black);
+        } else if (obj.mode == 4) {
+            OverlayShapes::paint(ip, QRectF(area), obj.shapeKind, obj.shapeColor, obj.shapeThickness);
+        } else if (obj.mode == 5) {
+            // In place on the frame (mirrors ffmpeg's eq= used for the same
+            // overlay at export); no sub-image copy or format conversion.
+            PreviewEffects::applyColorCorrection(img, area, obj.brightness, obj.contrast, obj.saturation, ws);
+        } else if (obj.mode == 6) {
+            const PreviewEffects::Sprite sprite = imageSprite(obj, area, ws);
+            if (!sprite.image.isNull()) ip.drawImage(area.topLeft(), sprite.image);
+        } else { // Text overlay: mirrors ffmpeg drawtext (white, dark outline, centered)
+            const PreviewEffects::Sprite sprite = textSprite(obj, area, ws);
+            ip.drawImage(area.topLeft() + sprite.offset, sprite.image);
+        }
+    }
+
+    // On-frame footprint of each filter compositeFilters would apply with
+    // `clip`; an empty rect for the ones it would skip.
+    static QVector<QRect> filterFootprints(const QList<FilterObject> &filters, const QSize &size, const QRect &clip) {
+        const QRect frameRect(QPoint(0, 0), size);
+        QVector<QRect> footprints(filters.size());
+        for (int i = 0; i < filters.size(); ++i) {
+            const QRect area = filterArea(filters[i], size);
+            if (area.width() <= 0 || area.height() <= 0) continue;
+            const QRect fp = filterFootprint(filters[i], area);
+            if (clip.isEmpty() || fp.intersects(clip)) footprints[i] = fp.intersected(frameRect);
+        }
+        return footprints;
+    }
+
+    // Full-width row bands that no footprint straddles. Every filter only
+    // reads and writes inside its footprint, so bands can be composited
+    // independently, each applying its own filters in list order, and
+    // together give exactly the serial result.
+    static QVector<QRect> filterBands(const QVector<QRect> &footprints, int width) {
+        QVector<QPair<int, int>> spans;
+        for (const QRect &fp : footprints) {
+            if (!fp.isEmpty()) spans.append({fp.top(), fp.bottom()});
+        }
+        std::sort(spans.begin(), spans.end());
+        QVector<QRect> bands;
+        for (const auto &span : spans) {
+            if (!bands.isEmpty() && span.first <= bands.last().bottom()) {
+                bands.last().setBottom(qMax(bands.last().bottom(), span.second));
+            } else {
+                bands.append(QRect(0, span.first, width, span.second - span.first + 1));
             }
         }
+        return bands;
+    }
+
+    // The filters inside `band`, painted into a QImage that aliases just
+    // those rows of `frame` (starting at `bits`): a QImage takes one QPainter
+    // at a time, but its row slices can each take their own.
+    static void compositeBand(const QImage &frame, uchar *bits, const QRect &band, const QList<FilterObject> &filters,
+                              const QVector<QRect> &footprints, double sourceScale, PreviewEffects::Workspace &ws,
+                              int blurPower) {
+        QImage rows(bits + qsizetype(band.top()) * frame.bytesPerLine(), frame.width(), band.height(),
+                    frame.bytesPerLine(), frame.format());
+        QPainter ip(&rows);
+        for (int i = 0; i < filters.size(); ++i) {
+            if (!footprints[i].intersects(band)) continue;
+            const QRect area = filterArea(filters[i], frame.size()).translated(0, -band.top());
+            applyFilter(ip, rows, filters[i], area, sourceScale, ws, blurPower);
+        }
         ip.end();
     }
 
-    void triggerScale() {
-        if (!m_lastRawFrame.isValid()) return;
-        if (!m_isProcessing.testAndSetRelaxed(0, 1)) {
-            m_pendingRescale.storeRelaxed(1);
-            return;
+    // compositeFilters for an image holding just the part of a `frameSize`
+    // frame that starts at `origin`. Only filters whose footprint lies wholly
+    // inside it come out the same as on the full frame.
+    static void compositeRegion(QImage &img, const QPoint &origin, const QSize &frameSize,
+                                const QList<FilterObject> &filters, double sourceScale, PreviewEffects::Workspace &ws,
+                                int blurPower = PreviewEffects::kBlurPower) {
+        const QRect bounds(origin, img.size());
+        QPainter ip(&img);
+        for (const auto &obj : filters) {
+            const QRect area = filterArea(obj, frameSize);
+            if (area.width() <= 0 || area.height() <= 0) continue;
+            if (!filterFootprint(obj, area).intersects(bounds)) continue;
+            applyFilter(ip, img, obj, area.translated(-origin), sourceScale, ws, blurPower);
         }
+        ip.end();
+    }
 
-        QRect tr = calculateTargetRect();
-        QSize targetSize = tr.size();
-        if (targetSize.isEmpty()) {
-            m_isProcessing = 0;
+    // Worker-side entry point: compositeFilters, fanned out over the preview
+    // pool by row band when there are enough overlays to pay for it.
+    void compositeRegions(QImage &target, const QList<FilterObject> &filters, double sourceScale, int blurPower,
+                          const QRect &clip) {
+        QThreadPool *pool = WorkerPools::pool(WorkerPools::Preview);
+        QVector<QRect> footprints, bands;
+        if (filters.size() >= kParallelMinFilters) {
+            footprints = filterFootprints(filters, target.size(), clip);
+            bands = filterBands(footprints, target.width());
+        }
+        const int jobCount = qMin(int(bands.size()), pool->maxThreadCount());
+        if (jobCount < 2) {
+            compositeFilters(target, filters, sourceScale, m_effects, blurPower, clip);
             return;
         }
-        const QList<FilterObject> filtersSnapshot = filterObjects;
 
-        (void)QtConcurrent::run(QThreadPool::globalInstance(), [this, targetSize, filtersSnapshot]() {
-            QVideoFrame localFrame;
-            {
-                QMutexLocker locker(&m_frameMutex);
-                localFrame = m_lastRawFrame;
+        // Tallest bands first, each to the job with the fewest rows so far.
+        struct BandJob {
+            QVector<QRect> bands;
+            int rows = 0;
+            PreviewEffects::Workspace *ws = nullptr;
+        };
+        QVector<QRect> byHeight = bands;
+        std::sort(byHeight.begin(), byHeight.end(), [](const QRect &a, const QRect &b) { return a.height() > b.height(); });
+        QVector<BandJob> jobs(jobCount);
+        for (const QRect &band : byHeight) {
+            BandJob &job = *std::min_element(jobs.begin(), jobs.end(),
+                                             [](const BandJob &a, const BandJob &b) { return a.rows < b.rows; });
+            job.bands.append(band);
+            job.rows += band.height();
+        }
+        while (int(m_bandEffects.size()) < jobCount) m_bandEffects.push_back(std::make_unique<PreviewEffects::Workspace>());
+        for (int i = 0; i < jobCount; ++i) jobs[i].ws = m_bandEffects[i].get();
+
+        uchar *bits = target.bits(); // detach (if ever shared) here, not on the pool
+        const QImage &frame = target;
+        QtConcurrent::blockingMap(pool, jobs, [&](BandJob &job) {
+            for (const QRect &band : job.bands) {
+                compositeBand(frame, bits, band, filters, footprints, sourceScale, *job.ws, blurPower);
+            }
+        });
+    }
+
+    static QRect filterArea(const FilterObject &obj, const QSize &size) {
+        const int x = obj.l * size.width();
+        const int y = obj.t * size.height();
+        const int w = (obj.r - obj.l) * size.width();
+        const int h = (obj.b - obj.t) * size.height();
+        return QRect(x, y, w, h);
+    }
+
+    static qreal textOutlineWidth(const QRect &area) { return qMax(2.0, area.height() * 0.05); }
+
+    static QPainterPath textOverlayPath(const FilterObject &obj, const QRect &area) {
+        QFont font;
+        font.setBold(true);
+        font.setPixelSize(qMax(8, qRound(area.height() * 0.6)));
+        const QString text = obj.text.isEmpty() ? QStringLiteral("Your text") : obj.text;
+
+        QPainterPath path;
+        QFontMetrics fm(font);
+        const QRect textBounds = fm.boundingRect(area, Qt::AlignCenter | Qt::TextWordWrap, text);
+        int lineY = textBounds.top() + fm.ascent();
+        for (const QString &line : text.split('\n')) {
+            const int lineW = fm.horizontalAdvance(line);
+            path.addText(area.center().x() - lineW / 2.0, lineY, font, line);
+            lineY += fm.lineSpacing();
+        }
+        return path;
+    }
+
+    // Text is laid out and stroked once per (text, box size) and then only
+    // blitted: subtitles are recomposited every frame but rarely change. The
+    // layout is translation-invariant, so the sprite is drawn at the origin.
+    static PreviewEffects::Sprite textSprite(const FilterObject &obj, const QRect &area, PreviewEffects::Workspace &ws) {
+        const QString key = QString("%1\x1f%2x%3")
+            .arg(obj.text, QString::number(area.width()), QString::number(area.height()));
+        if (const PreviewEffects::Sprite *hit = ws.textSprites.object(key)) return *hit;
+
+        const QRect localArea(QPoint(0, 0), area.size());
+        const QPainterPath path = textOverlayPath(obj, localArea);
+        const qreal outline = textOutlineWidth(localArea);
+        const QRect bounds = path.boundingRect().adjusted(-outline, -outline, outline, outline).toAlignedRect();
+        PreviewEffects::Sprite sprite;
+        if (bounds.isEmpty()) return sprite;
+        sprite.offset = bounds.topLeft();
+        sprite.image = QImage(bounds.size(), QImage::Format_ARGB32_Premultiplied);
+        sprite.image.fill(Qt::transparent);
+        QPainter sp(&sprite.image);
+        sp.setRenderHint(QPainter::Antialiasing);
+        sp.setRenderHint(QPainter::TextAntialiasing);
+        sp.translate(-bounds.topLeft());
+        sp.setPen(QPen(QColor(0, 0, 0, 170), outline));
+        sp.setBrush(Qt::white);
+        sp.drawPath(path);
+        sp.setPen(Qt::NoPen);
+        sp.drawPath(path);
+        sp.end();
+        // A sprite bigger than the whole cap is still drawn, just not kept.
+        ws.textSprites.insert(key, new PreviewEffects::Sprite(sprite), qMax<qsizetype>(1, sprite.image.sizeInBytes() / 1024));
+        return sprite;
+    }
+
+    // An image overlay's picture scaled to its box with the opacity baked in,
+    // the same scale=w:h + alpha the export applies once to its image input.
+    // Only a box resize or a new opacity makes a new sprite; playback blits.
+    static PreviewEffects::Sprite imageSprite(const FilterObject &obj, const QRect &area, PreviewEffects::Workspace &ws) {
+        const QString key = QString("%1\x1f%2x%3\x1f%4")
+            .arg(obj.imagePath, QString::number(area.width()), QString::number(area.height()),
+                 QString::number(qRound(obj.opacity * 255)));
+        if (const PreviewEffects::Sprite *hit = ws.imageSprites.object(key)) return *hit;
+
+        PreviewEffects::Sprite sprite;
+        const QImage source = PreviewEffects::overlayImage(obj.imagePath);
+        if (source.isNull()) return sprite;
+        sprite.image = QImage(area.size(), QImage::Format_ARGB32_Premultiplied);
+        sprite.image.fill(Qt::transparent);
+        QPainter sp(&sprite.image);
+        sp.setOpacity(qBound(0.0f, obj.opacity, 1.0f));
+        sp.drawImage(0, 0, source.scaled(area.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+        sp.end();
+        ws.imageSprites.insert(key, new PreviewEffects::Sprite(sprite), qMax<qsizetype>(1, sprite.image.sizeInBytes() / 1024));
+        return sprite;
+    }
+
+    // Every pixel a filter can write: its area, plus the stroke (and arrow
+    // head) overhang of shapes and the outline of text, which may spill
+    // outside the box.
+    static QRect filterFootprint(const FilterObject &obj, const QRect &area) {
+        if (obj.mode == 4) {
+            int m = obj.shapeThickness / 2 + 2;
+            if (obj.shapeKind == OverlayShapes::Arrow) m += qCeil(qMax(10.0, area.width() * 0.18));
+            return area.adjusted(-m, -m, m, m);
+        }
+        if (obj.mode == 3) {
+            const int m = qCeil(textOutlineWidth(area) / 2) + 2;
+            return area.united(textOverlayPath(obj, area).boundingRect().toAlignedRect()).adjusted(-m, -m, m, m);
+        }
+        return area;
+    }
+
+    // Region of a frame of `size` that must be recomposited to turn a
+    // composite made with `before` into one made with `after`: the old and new
+    // footprints of every changed filter, grown until no filter straddles the
+    // edge (a blur half inside would otherwise be redone from clipped input).
+    static QRect changedRegion(const QList<FilterObject> &before, const QList<FilterObject> &after, const QSize &size) {
+        const QRect frameRect(QPoint(0, 0), size);
+        if (before.size() != after.size()) return frameRect;
+        QRect dirty;
+        for (int i = 0; i < after.size(); ++i) {
+            if (before[i] == after[i]) continue;
+            dirty |= filterFootprint(before[i], filterArea(before[i], size));
+            dirty |= filterFootprint(after[i], filterArea(after[i], size));
+        }
+        if (dirty.isEmpty()) return QRect();
+        return growToFootprints(after, size, dirty);
+    }
+
+    // `region` grown until no footprint of `filters` straddles its edge,
+    // clipped to the frame.
+    static QRect growToFootprints(const QList<FilterObject> &filters, const QSize &size, QRect region) {
+        for (bool grown = true; grown;) {
+            grown = false;
+            for (const auto &obj : filters) {
+                const QRect fp = filterFootprint(obj, filterArea(obj, size));
+                if (fp.intersects(region) && !region.contains(fp)) {
+                    region |= fp;
+                    grown = true;
+                }
             }
+        }
+        return region.intersected(QRect(QPoint(0, 0), size));
+    }
+
+    static void copyPixels(QImage &dst, const QImage &src, const QRect &area) {
+        const int bytes = area.width() * 4;
+        for (int y = area.top(); y <= area.bottom(); ++y) {
+            memcpy(dst.scanLine(y) + area.left() * 4, src.constScanLine(y) + area.left() * 4, bytes);
+        }
+    }
+
+    // Worker only: rescales `frame` into m_baseFrame.
+    bool rebuildBaseFrame(const QVideoFrame &frame, const QSize &bounds, bool fast) {
+        QSize sourceSize(frame.width(), frame.height());
+        // Fast path: map the YUV planes and convert + downscale in one go.
+        // Anything it doesn't handle takes the generic full-res conversion.
+        if (!m_frameScaler.scale(frame, bounds, m_baseFrame, fast)) {
+            const QImage sourceImage = frame.toImage();
+            if (sourceImage.isNull()) return false;
+            sourceSize = sourceImage.size();
+            m_baseFrame = sourceImage.scaled(bounds, Qt::KeepAspectRatio,
+                                             fast ? Qt::FastTransformation : Qt::SmoothTransformation);
+            if (!PreviewEffects::isKernelFormat(m_baseFrame)) m_baseFrame.convertTo(QImage::Format_RGB32);
+        }
+        m_baseSourceSize = sourceSize;
+        return true;
+    }
+
+    void receiveFrame(const QVideoFrame &frame, bool baked) {
+        if (!frame.isValid()) return;
+        if (!baked) m_liveFrame = frame;
+        // Live frames keep coming through until the first baked one lands.
+        if (baked ? !m_bakedOverlays : m_frameBaked) return;
 
-            QImage sourceImage = localFrame.toImage();
-            if (sourceImage.isNull()) {
-                m_isProcessing = 0;
-                return;
+        m_lastRawFrame = frame;
+        m_frameBaked = baked;
+        ++m_frameSerial;
+        m_statReceived.fetch_add(1, std::memory_order_relaxed);
+        // Frame spacing as actually delivered (tracks playback rate
+        // changes); it's the budget the governor holds composites to.
+        if (m_frameClock.isValid()) {
+            const double elapsed = qBound(4.0, m_frameClock.nsecsElapsed() / 1e6, 200.0);
+            m_frameIntervalMs = m_frameIntervalMs * 0.9 + elapsed * 0.1;
+        }
+        m_frameClock.start();
+
+        triggerScale();
+    }
+
+    // GUI thread: queue a composite of the current frame with the current
+    // overlays and target size. Never blocks; coalesces with any request the
+    // worker hasn't picked up yet.
+    void triggerScale() {
+        if (!m_lastRawFrame.isValid()) return;
+        const QSize displaySize = calculateTargetRect().size();
+        if (displaySize.isEmpty()) return;
+
+        const int tier = effectiveQualityTier();
+        const TierSettings quality = tierSettings(tier);
+        const qreal scale = quality.scale * (quality.useDpr ? devicePixelRatioF() : 1.0);
+        const QSize renderSize(qMax(1, qRound(displaySize.width() * scale)), qMax(1, qRound(displaySize.height() * scale)));
+        if (tier != m_shownTier) {
+            m_shownTier = tier;
+            emit qualityTierChanged(tier);
+        }
+
+        PreviewRequest &request = m_requests.back();
+        request.frame = m_lastRawFrame;
+        request.serial = m_frameSerial;
+        request.targetSize = renderSize;
+        request.pixelRatio = scale;
+        request.tier = tier;
+        request.governed = m_playbackActive && m_pinnedTier < 0;
+        request.frameIntervalMs = m_frameIntervalMs;
+        request.filters = m_frameBaked ? QList<FilterObject>() : filterObjects;
+        request.baked = m_frameBaked;
+        request.loupeCenter = QPointF(-1, -1);
+        if (m_loupeEnabled && m_loupeHover && !lastFrame.isNull()) {
+            const QRect imageRect = displayedFrameRect(calculateTargetRect(), lastFrame);
+            const qreal dpr = devicePixelRatioF();
+            request.loupeCenter = QPointF(qreal(m_loupePos.x() - imageRect.x()) / qMax(1, imageRect.width()),
+                                          qreal(m_loupePos.y() - imageRect.y()) / qMax(1, imageRect.height()));
+            request.loupeSize = QSize(qRound(kLoupeSize * dpr), qRound(kLoupeSize * dpr));
+            request.loupeRatio = dpr;
+        }
+        m_requests.publish();
+        // Don't let the recycled slot pin a decoder surface until next time.
+        m_requests.back().frame = QVideoFrame();
+
+        if (m_workerActive.testAndSetAcquire(0, 1)) {
+            m_workerTask = WorkerPools::run(WorkerPools::Preview, [this]() { runWorker(); });
+        }
+    }
+
+    // Worker: drain requests until none are pending. The re-check after
+    // clearing m_workerActive closes the window where a request published
+    // just before the clear would otherwise wait for the next frame.
+    void runWorker() {
+        for (;;) {
+            while (m_requests.consume()) {
+                compositeRequest(m_requests.front());
+                m_requests.front().frame = QVideoFrame();
             }
+            m_workerActive.storeRelease(0);
+            if (!m_requests.hasFresh() || !m_workerActive.testAndSetAcquire(0, 1)) return;
+        }
+    }
+
+    void compositeRequest(const PreviewRequest &request) {
+        const quint64 serial = request.serial;
+        const QSize &targetSize = request.targetSize;
+        const QList<FilterObject> &filters = request.filters;
+        const TierSettings quality = tierSettings(request.tier);
+        QElapsedTimer passTimer;
+        passTimer.start();
+
+        // Rescale only for a new frame or a new target size; overlay edits
+        // on a paused frame reuse the cached base.
+        if (serial != m_baseSerial || targetSize != m_baseBounds || quality.fastScaling != m_baseFast
+            || m_baseFrame.isNull()) {
+            if (!rebuildBaseFrame(request.frame, targetSize, quality.fastScaling)) return;
+            m_baseSerial = serial;
+            m_baseBounds = targetSize;
+            m_baseFast = quality.fastScaling;
+        }
 
-            const int sourceWidth = sourceImage.width();
-            const int sourceHeight = sourceImage.height();
-            QImage img = sourceImage.scaled(targetSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-            compositeFilters(img, filtersSnapshot);
+        CompositeSlot &out = m_composites.back();
+        QRect dirty = m_baseFrame.rect();
+        if (out.frameSerial == m_baseSerial && out.tier == request.tier && out.image.size() == m_baseFrame.size()
+            && out.image.format() == m_baseFrame.format()) {
+            dirty = changedRegion(out.filters, filters, m_baseFrame.size());
+        } else if (out.image.size() != m_baseFrame.size() || out.image.format() != m_baseFrame.format()) {
+            out.image = QImage(m_baseFrame.size(), m_baseFrame.format());
+        }
+        // Paint maps the image back onto its on-screen rect through this.
+        if (out.image.devicePixelRatio() != request.pixelRatio) out.image.setDevicePixelRatio(request.pixelRatio);
+        if (!dirty.isEmpty()) {
+            copyPixels(out.image, m_baseFrame, dirty);
+            compositeRegions(out.image, filters, double(m_baseFrame.width()) / m_baseSourceSize.width(),
+                             quality.blurPower, dirty);
+        }
+        out.frameSerial = m_baseSerial;
+        out.tier = request.tier;
+        out.filters = filters;
+        if (request.governed && serial != m_lastCompositedSerial) {
+            governQuality(passTimer.nsecsElapsed() / 1e6, request.frameIntervalMs, request.tier);
+        }
+        // After the governor's measurement: the loupe is an inspection aid
+        // and shouldn't push the main preview down a tier.
+        renderLoupe(request, out);
 
-            {
-                QMutexLocker locker(&m_frameMutex);
-                lastFrame = img;
+        if (serial != m_lastCompositedSerial) {
+            // Serials are consecutive per sink frame, so a gap is frames that
+            // were replaced in the request buffer before we got to them.
+            if (m_lastCompositedSerial != 0 && serial > m_lastCompositedSerial + 1) {
+                m_statDroppedBeforeComposite.fetch_add(serial - m_lastCompositedSerial - 1, std::memory_order_relaxed);
             }
+            m_lastCompositedSerial = serial;
+            m_statComposited.fetch_add(1, std::memory_order_relaxed);
+        }
+        out.compositedCount = m_statComposited.load(std::memory_order_relaxed);
+        const QImage published = out.image; // shallow: the slot is the GUI's after publish()
+        m_composites.publish();
+        m_scopes.offer(published);
 
-            m_isProcessing = 0;
-            QMetaObject::invokeMethod(this, [this, sourceWidth, sourceHeight]() {
+        // Render-cache frames are preview sized; the export geometry stays
+        // whatever the source last reported.
+        const int sourceWidth = request.baked ? 0 : m_baseSourceSize.width();
+        const int sourceHeight = request.baked ? 0 : m_baseSourceSize.height();
+        QMetaObject::invokeMethod(this, [this, sourceWidth, sourceHeight]() {
+            if (sourceWidth > 0 && sourceHeight > 0) {
                 setProperty("actualWidth", sourceWidth);
                 setProperty("actualHeight", sourceHeight);
-                update();
-                if (m_pendingRescale.fetchAndStoreRelaxed(0)) triggerScale();
-            }, Qt::QueuedConnection);
-        });
+            }
+            update();
+        }, Qt::QueuedConnection);
+    }
+
+    // Worker: the loupe region straight from the raw frame, 1:1, with the
+    // overlays composited at source resolution (blur radius and mosaic cells
+    // exactly as exported). Only the pixels the overlays there depend on
+    // are converted, never the whole frame.
+    void renderLoupe(const PreviewRequest &request, CompositeSlot &out) {
+        out.loupe = QImage();
+        if (request.loupeCenter.x() < 0 || request.loupeSize.isEmpty() || m_baseSourceSize.isEmpty()) return;
+        const QSize frameSize = m_baseSourceSize;
+        const QPoint center(qRound(request.loupeCenter.x() * frameSize.width()),
+                            qRound(request.loupeCenter.y() * frameSize.height()));
+        QRect view(QPoint(0, 0), request.loupeSize.boundedTo(frameSize));
+        view.moveCenter(center);
+        // Near the frame edges keep the loupe full rather than centered.
+        view.moveLeft(qBound(0, view.left(), frameSize.width() - view.width()));
+        view.moveTop(qBound(0, view.top(), frameSize.height() - view.height()));
+
+        // A filter reaching into the view needs all of its input, and so on
+        // for whatever overlaps that.
+        const QRect region = growToFootprints(request.filters, frameSize, view);
+        if (!FrameScaler::convertRegion(request.frame, region, m_loupeSource)) {
+            // Formats the fused path can't read: full conversion, cropped.
+            const QImage full = request.frame.toImage();
+            if (full.size() != frameSize) return;
+            m_loupeSource = full.copy(region).convertToFormat(QImage::Format_RGB32);
+        }
+        compositeRegion(m_loupeSource, region.topLeft(), frameSize, request.filters, 1.0, m_effects);
+        out.loupe = m_loupeSource.copy(view.translated(-region.topLeft()));
+        out.loupe.setDevicePixelRatio(request.loupeRatio);
+        out.loupeCursor = QPointF(center - view.topLeft());
+    }
+
+    // Worker: step the governed tier from the cost of a playback pass (new
+    // frame, full composite) against the frame interval. Down after a few
+    // overrunning frames, up only after a couple of seconds of clear headroom,
+    // so it doesn't oscillate between neighbouring tiers.
+    void governQuality(double passMs, double budgetMs, int tierUsed) {
+        const int tier = m_governedTier.loadRelaxed();
+        if (tierUsed != tier || budgetMs <= 0) return; // measured under a stale tier
+        m_compositeMsAvg = m_compositeMsAvg <= 0 ? passMs : m_compositeMsAvg * 0.8 + passMs * 0.2;
+        int next = tier;
+        if (m_compositeMsAvg > budgetMs * 0.85) {
+            m_headroomRun = 0;
+            if (++m_overBudgetRun >= 3) next = qMin(tier + 1, QualityTierCount - 1);
+        } else if (m_compositeMsAvg < budgetMs * 0.4) {
+            m_overBudgetRun = 0;
+            if (++m_headroomRun >= qRound(2000.0 / budgetMs)) next = qMax(tier - 1, 0);
+        } else {
+            m_overBudgetRun = 0;
+            m_headroomRun = 0;
+        }
+        if (next != tier) {
+            m_governedTier.storeRelaxed(next);
+            m_compositeMsAvg = 0;
+            m_overBudgetRun = 0;
+            m_headroomRun = 0;
+        }
+    }
+
+    // GUI thread: adopt the newest composite, if any, as lastFrame.
+    void takeCompositedFrame() {
+        if (!m_composites.consume()) return;
+        const CompositeSlot &frame = m_composites.front();
+        lastFrame = frame.image;
+        m_loupeImage = m_loupeEnabled ? frame.loupe : QImage();
+        m_loupeCursor = frame.loupeCursor;
+        if (frame.frameSerial != m_presentedSerial) {
+            m_presentedSerial = frame.frameSerial;
+            const quint64 presented = m_statPresented.fetch_add(1, std::memory_order_relaxed) + 1;
+            // Every frame composited up to this one was either presented or
+            // replaced before a paint picked it up.
+            const quint64 lost = frame.compositedCount > presented ? frame.compositedCount - presented : 0;
+            m_statDroppedBeforePaint.store(lost, std::memory_order_relaxed);
+        }
     }
 
     void setPlaceholderState(const QString &title, const QString &body) {
@@ -244,19 +881,20 @@ public:
 
     QRect displayedFrameRect(const QRect &targetRect, const QImage &frame) const {
         if (frame.isNull()) return targetRect;
-        const int xOffset = (targetRect.width() - frame.width()) / 2;
-        const int yOffset = (targetRect.height() - frame.height()) / 2;
-        return QRect(targetRect.topLeft() + QPoint(xOffset, yOffset), frame.size());
+        // The composite may be rendered above (HiDPI) or below (governed
+        // tiers) the on-screen size; its device-independent size is what shows.
+        const QSize shown = frame.deviceIndependentSize().toSize();
+        const int xOffset = (targetRect.width() - shown.width()) / 2;
+        const int yOffset = (targetRect.height() - shown.height()) / 2;
+        return QRect(targetRect.topLeft() + QPoint(xOffset, yOffset), shown);
     }
 
-    // Static buffer to avoid allocation jitter at 60fps
-    QImage previewBuffer;
-
 signals:
     void cropsChanged(float t, float b, float l, float r);
     void filtersChanged(QList<VideoWithCropWidget::FilterObject> filters);
     void filterSelectionChanged(int index);
     void overlayDropped(int type);
+    void qualityTierChanged(int tier);
 
 protected:
     void resizeEvent(QResizeEvent* event) override {
@@ -283,11 +921,8 @@ protected:
         p.setRenderHint(QPainter::SmoothPixmapTransform, false);
         p.fillRect(rect(), m_backgroundColor);
 
-        QImage frameToDraw;
-        {
-            QMutexLocker locker(&m_frameMutex);
-            frameToDraw = lastFrame;
-        }
+        takeCompositedFrame();
+        const QImage &frameToDraw = lastFrame;
 
         if (frameToDraw.isNull()) {
             // ... (title drawing logic remains same)
@@ -312,7 +947,7 @@ protected:
 
         // NOTE: frameToDraw already has blur/pixelate/blackout boxes baked in by the
         // background worker (see triggerScale/compositeFilters) so painting stays cheap.
-        p.drawImage(imageRect.topLeft(), frameToDraw);
+        p.drawImage(imageRect, frameToDraw);
 
         const int cropX = imageRect.x() + qRound(cropL * imageRect.width());
         const int cropY = imageRect.y() + qRound(cropT * imageRect.height());
@@ -334,6 +969,41 @@ protected:
         }
 
         drawSelectionUI(p, imageRect, cropL, cropT, cropR, cropB, m_accentColor, !adjustingFilter);
+
+        if (m_loupeEnabled && m_loupeHover && !m_loupeImage.isNull()) drawLoupe(p);
+    }
+
+    void drawLoupe(QPainter &p) {
+        const QSize size = m_loupeImage.deviceIndependentSize().toSize();
+        // Up and to the right of the cursor, flipped to stay inside the widget.
+        const int gap = 24;
+        QPoint topLeft(m_loupePos.x() + gap, m_loupePos.y() - gap - size.height());
+        if (topLeft.x() + size.width() > width()) topLeft.setX(m_loupePos.x() - gap - size.width());
+        if (topLeft.y() < 0) topLeft.setY(m_loupePos.y() + gap);
+        const QRect box(topLeft, size);
+
+        p.save();
+        QPainterPath clip;
+        clip.addRoundedRect(QRectF(box), 8, 8);
+        p.setClipPath(clip);
+        p.drawImage(box, m_loupeImage);
+        // Where the cursor is within the magnified region.
+        const QPointF mark = QPointF(box.topLeft()) + m_loupeCursor / m_loupeImage.devicePixelRatio();
+        p.setPen(QPen(QColor(255, 255, 255, 200), 1));
+        p.drawLine(QPointF(mark.x() - 8, mark.y()), QPointF(mark.x() - 3, mark.y()));
+        p.drawLine(QPointF(mark.x() + 3, mark.y()), QPointF(mark.x() + 8, mark.y()));
+        p.drawLine(QPointF(mark.x(), mark.y() - 8), QPointF(mark.x(), mark.y() - 3));
+        p.drawLine(QPointF(mark.x(), mark.y() + 3), QPointF(mark.x(), mark.y() + 8));
+        p.setClipping(false);
+        p.setPen(QPen(m_accentColor, 2));
+        p.setBrush(Qt::NoBrush);
+        p.drawRoundedRect(QRectF(box).adjusted(1, 1, -1, -1), 8, 8);
+        QFont badgeFont = p.font();
+        badgeFont.setPointSize(8);
+        badgeFont.setBold(true);
+        p.setFont(badgeFont);
+        p.drawText(box.adjusted(8, 6, -8, -6), Qt::AlignRight | Qt::AlignBottom, "1:1");
+        p.restore();
     }
 
     void drawSelectionUI(QPainter &p, QRect tr, float L, float T, float R, float B, QColor color, bool isActive) {
@@ -365,12 +1035,7 @@ protected:
         this->setFocus();
 
         if (lastFrame.isNull()) return;
-        QImage frame;
-        {
-            QMutexLocker locker(&m_frameMutex);
-            frame = lastFrame;
-        }
-        QRect tr = displayedFrameRect(calculateTargetRect(), frame);
+        QRect tr = displayedFrameRect(calculateTargetRect(), lastFrame);
         QPoint p = e->pos();
         int margin = 20;
 
@@ -417,13 +1082,15 @@ protected:
     }
 
     void mouseMoveEvent(QMouseEvent* e) override {
-        if (activeEdge == None || lastFrame.isNull()) return;
-        QImage frame;
-        {
-            QMutexLocker locker(&m_frameMutex);
-            frame = lastFrame;
+        if (m_loupeEnabled && !lastFrame.isNull()) {
+            m_loupePos = e->pos();
+            m_loupeHover = displayedFrameRect(calculateTargetRect(), lastFrame).contains(m_loupePos);
+            // An overlay drag below queues its own composite.
+            if (m_loupeHover && !(activeEdge != None && adjustingFilter)) triggerScale();
+            update();
         }
-        QRect tr = displayedFrameRect(calculateTargetRect(), frame);
+        if (activeEdge == None || lastFrame.isNull()) return;
+        QRect tr = displayedFrameRect(calculateTargetRect(), lastFrame);
         float curX = qBound(0.0f, static_cast<float>(e->pos().x() - tr.x()) / qMax(1, tr.width()), 1.0f);
         float curY = qBound(0.0f, static_cast<float>(e->pos().y() - tr.y()) / qMax(1, tr.height()), 1.0f);
 
@@ -452,6 +1119,14 @@ protected:
             emit cropsChanged(cropT, cropB, cropL, cropR);
         }
     }
+    void leaveEvent(QEvent *event) override {
+        QWidget::leaveEvent(event);
+        if (m_loupeHover) {
+            m_loupeHover = false;
+            update();
+        }
+    }
+
     void mouseReleaseEvent(QMouseEvent*) override {
         if (adjustingFilter) triggerScale();
         activeEdge = None;
@@ -1,6 +1,7 @@
 #ifndef SIMPLEVIDEOEDITOR_MEDIAUTILS_H
 #define SIMPLEVIDEOEDITOR_MEDIAUTILS_H
 
+#include <QCoreApplication>
 #include <QFileInfo>
 #include <QMimeDatabase>
 #include <QString>
@@ -70,6 +71,16 @@ inline QString importDialogFilter() {
            "All files (*.*)";
 }
 
+// ffmpeg/ffprobe: bundled next to the executable on Windows, from PATH
+// elsewhere.
+inline QString ffToolPath(const QString &tool) {
+#ifdef Q_OS_WIN
+    return QCoreApplication::applicationDirPath() + "/" + tool + ".exe";
+#else
+    return tool;
+#endif
+}
+
 }
 
 #endif
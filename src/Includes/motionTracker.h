@@ -0,0 +1,66 @@
+#ifndef SIMPLEVIDEOEDITOR_MOTIONTRACKER_H
+#define SIMPLEVIDEOEDITOR_MOTIONTRACKER_H
+
+#include <QObject>
+#include <QPointF>
+#include <QRectF>
+#include <QSize>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+// Follows a rectangular region through a stretch of video, so a blur or
+// pixelate overlay can stay on a moving window or username. ffmpeg decodes
+// the stretch to small grayscale frames on stdout; each frame is searched
+// around the region's last position for its last appearance by block
+// matching (sum of absolute differences, coarse-to-fine, SSE2 where
+// available). The whole job runs on the analysis pool.
+class MotionTracker : public QObject {
+    Q_OBJECT
+public:
+    struct Request {
+        QString sourcePath;
+        qint64 sourceStartMs = 0; // source-local
+        qint64 durationMs = 0;
+        QSize sourceSize;         // only the aspect ratio is used
+        QRectF region;            // normalized, as it is at sourceStartMs
+    };
+    // The region's top-left (normalized) `offsetMs` after the start.
+    struct Sample {
+        qint64 offsetMs = 0;
+        QPointF topLeft;
+    };
+
+    // Analysis frame width, tracked frames per second, and how far (in
+    // analysis pixels) the target may move between two of them.
+    static constexpr int kAnalysisWidth = 480;
+    static constexpr int kTrackFps = 30;
+    static constexpr int kSearchRadius = 24;
+
+    explicit MotionTracker(QObject *parent = nullptr);
+    ~MotionTracker() override;
+
+    // False if a job is already running.
+    bool start(const Request &request);
+    void cancel() { m_cancel.store(true); }
+    bool isRunning() const { return m_running.load(); }
+
+    // SAD of two w x h 8-bit blocks; stops early once past `limit`.
+    static quint32 blockSad(const quint8 *a, int strideA, const quint8 *b, int strideB, int w, int h,
+                            quint32 limit = 0xFFFFFFFFu);
+
+signals:
+    void progress(int percent);
+    // `samples` cover the request up to where tracking stopped (simplified:
+    // points a straight line through their neighbours predicts are dropped).
+    // A lost target or a cancel still delivers what was tracked so far.
+    void finished(bool ok, const QVector<MotionTracker::Sample> &samples, const QString &message);
+
+private:
+    void run(const Request &request);
+
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_cancel{false};
+};
+
+#endif // SIMPLEVIDEOEDITOR_MOTIONTRACKER_H
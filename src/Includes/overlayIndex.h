@@ -0,0 +1,76 @@
+#ifndef SIMPLEVIDEOEDITOR_OVERLAYINDEX_H
+#define SIMPLEVIDEOEDITOR_OVERLAYINDEX_H
+
+#include <QList>
+#include <QVector>
+#include <QtGlobal>
+#include <vector>
+
+// Interval tree over the overlay clips' [startMs, endMs) spans, plus the
+// lane each clip is drawn on. Ids are overlay indices: insert() and
+// remove() renumber the ids after them the way QList::insert/removeAt
+// renumber the clips.
+//
+// The tree is a treap ordered by (start, id) with each node carrying the
+// latest end in its subtree, so stabbing and window queries skip every
+// subtree that ends before the query starts: O(log n + hits).
+//
+// Lanes are sticky. rebuild() packs them greedily (first fit in start
+// order); after that an inserted clip takes the lowest lane free over its
+// span, a moved clip keeps its lane while it still fits there, and a lane
+// left empty is closed up. Nothing about a single edit looks at more than
+// the clips overlapping it, bar the id/lane renumbering.
+class OverlayIndex {
+public:
+    struct Span {
+        qint64 startMs = 0;
+        qint64 endMs = 0;
+    };
+
+    void rebuild(const QVector<Span> &spans);
+    void insert(int id, qint64 startMs, qint64 endMs);
+    void remove(int id);
+    void move(int id, qint64 startMs, qint64 endMs);
+
+    int size() const { return int(m_nodeOf.size()); }
+    const QVector<int> &lanes() const { return m_lanes; }
+    int laneCount() const { return int(m_laneLoad.size()); }
+
+    // Ids active at timeMs (startMs <= timeMs < endMs), ascending.
+    QList<int> at(qint64 timeMs) const;
+    // Ids whose span touches [fromMs, toMs], ends included, ascending.
+    QList<int> touching(qint64 fromMs, qint64 toMs) const;
+
+private:
+    struct Node {
+        qint64 start;
+        qint64 end;
+        qint64 maxEnd; // latest end in this subtree
+        int id;
+        quint32 priority;
+        int left;
+        int right;
+    };
+
+    bool before(int a, qint64 start, int id) const;
+    void pull(int t);
+    void split(int t, qint64 start, int id, int &l, int &r);
+    int merge(int l, int r);
+    int erase(int t, qint64 start, int id);
+    int newNode(int id, qint64 start, qint64 end);
+    void link(int node);
+    void unlink(int id);
+    void collect(int t, qint64 from, qint64 to, bool endInclusive, QList<int> &out) const;
+    QVector<bool> lanesUsed(int self, qint64 startMs, qint64 endMs) const;
+    void setLane(int id, int lane);
+
+    std::vector<Node> m_nodes;
+    std::vector<int> m_freeNodes;
+    int m_root = -1;
+    QVector<int> m_nodeOf;   // id -> node
+    QVector<int> m_lanes;    // id -> lane
+    QVector<int> m_laneLoad; // lane -> clip count, never 0
+    quint32 m_seed = 0x9E3779B9u;
+};
+
+#endif // SIMPLEVIDEOEDITOR_OVERLAYINDEX_H
@@ -0,0 +1,101 @@
+#ifndef SIMPLEVIDEOEDITOR_PREVIEWEFFECTS_H
+#define SIMPLEVIDEOEDITOR_PREVIEWEFFECTS_H
+
+#include <QCache>
+#include <QImage>
+#include <QRect>
+#include <QString>
+#include <array>
+#include <vector>
+
+// Pixel kernels for the live preview compositor (VideoWithCropWidget's
+// background worker). They work in place on 0xAARRGGBB images (RGB32 /
+// ARGB32 / ARGB32_Premultiplied with opaque video), never allocate per call,
+// and are written to track the ffmpeg filters export.cpp uses for the same
+// overlays, so the preview stays a faithful picture of the export.
+namespace PreviewEffects {
+
+// Effect parameters export.cpp hands to ffmpeg, in source pixels. The
+// preview scales them by its own downscale factor so a region looks the
+// same size-for-size in the editor as in the exported file.
+constexpr int kBlurRadius = 20;     // boxblur luma_radius (clamped to min(w,h)/2)
+constexpr int kBlurPower = 2;       // boxblur luma_power
+constexpr int kPixelateBlock = 30;  // scale=iw/30 then neighbor upscale
+
+// True when `img` has the 32-bit 0xAARRGGBB layout the kernels expect.
+bool isKernelFormat(const QImage &img);
+
+// Brightness/contrast as a 256-entry luma table, built the same way ffmpeg's
+// eq filter builds its own (eq only touches luma for these two parameters).
+struct ColorLut {
+    int brightnessKey = 0;
+    int contrastKey = 1000;
+    quint64 lastUsed = 0;
+    std::array<quint8, 256> table{};
+};
+
+// Small fixed-size cache so the tables survive across frames: during
+// playback the same handful of color-correct overlays repeat every frame,
+// and rebuilding 256 entries is cheap but not free at 60 fps.
+class ColorLutCache {
+public:
+    const ColorLut &lookup(float brightness, float contrast);
+
+private:
+    static constexpr int kSlots = 8;
+    std::array<ColorLut, kSlots> m_slots{};
+    int m_used = 0;
+    quint64 m_clock = 0;
+};
+
+// A pre-rendered overlay (premultiplied ARGB) and where its top-left sits
+// relative to the overlay box.
+struct Sprite {
+    QImage image;
+    QPoint offset;
+};
+
+// Memory caps for the sprite caches, in KiB (QCache cost units).
+constexpr int kTextSpriteCacheKiB = 16 * 1024;
+constexpr int kImageSpriteCacheKiB = 32 * 1024;
+
+// The image an image/logo overlay shows, decoded (premultiplied ARGB) the
+// first time any worker asks for it and shared from then on, so a file is
+// read once no matter how many frames or band jobs draw it. Null if the file
+// can't be read. Thread-safe.
+QImage overlayImage(const QString &path);
+
+// Scratch state owned by the preview worker and reused across frames.
+struct Workspace {
+    ColorLutCache colorLuts;
+    // Text overlays keyed by text + box size, LRU-evicted under the cap.
+    QCache<QString, Sprite> textSprites{kTextSpriteCacheKiB};
+    // Image overlays scaled to their box, keyed by file + box size + opacity.
+    QCache<QString, Sprite> imageSprites{kImageSpriteCacheKiB};
+    // Blur/mosaic scratch. Grow-only, so steady-state playback never allocates.
+    std::vector<quint32> plane;
+    std::vector<quint32> lineA;
+    std::vector<quint32> lineB;
+    std::vector<qint32> sums;
+    std::vector<int> cellOfColumn;
+    std::vector<quint32> cellColors;
+};
+
+// ffmpeg eq= equivalent over `area` of `img`: luma goes through the
+// brightness/contrast table, chroma is scaled by `saturation` around it.
+// SSE2/AVX2 fixed-point kernel where available, identical scalar fallback.
+void applyColorCorrection(QImage &img, const QRect &area, float brightness, float contrast, float saturation,
+                          Workspace &ws);
+
+// ffmpeg boxblur equivalent over `area`: separable running-sum box filter of
+// length 2*radius+1 with mirrored edges, applied `power` times per axis.
+// The radius is clamped to min(w,h)/2, the same limit boxblur enforces.
+void boxBlur(QImage &img, const QRect &area, int radius, int power, Workspace &ws);
+
+// Block-average mosaic over `area`, split into columns x rows cells the way
+// a nearest-neighbor upscale of a columns x rows image would split it.
+void pixelate(QImage &img, const QRect &area, int columns, int rows, Workspace &ws);
+
+}
+
+#endif // SIMPLEVIDEOEDITOR_PREVIEWEFFECTS_H
@@ -0,0 +1,57 @@
+#ifndef SIMPLEVIDEOEDITOR_SEGMENTINDEX_H
+#define SIMPLEVIDEOEDITOR_SEGMENTINDEX_H
+
+#include <QVector>
+#include <QtGlobal>
+
+// Sorted view of the timeline's segments for O(log n) lookups. Segments are
+// in timeline order and never overlap (every edit keeps them that way), so
+// their starts and their ends are each ascending and a time is found by
+// binary search on either. Prefix sums of source duration and of output
+// duration (after the speed ramps, as the export retimes them) turn
+// "where is this in the exported file" into one search plus one segment.
+class SegmentIndex {
+public:
+    struct Span {
+        qint64 startMs = 0;
+        qint64 endMs = 0;
+        float speedStart = 1.0f;
+        float speedEnd = 1.0f;
+    };
+
+    void rebuild(const QVector<Span> &spans);
+
+    int size() const { return int(m_spans.size()); }
+    qint64 startAt(int i) const { return m_spans[i].startMs; }
+    qint64 endAt(int i) const { return m_spans[i].endMs; }
+
+    // Binary searches; each returns size() when nothing qualifies.
+    int firstStartAtOrAfter(qint64 timeMs) const;
+    int firstStartAfter(qint64 timeMs) const;
+    int firstEndAtOrAfter(qint64 timeMs) const;
+    int firstEndAfter(qint64 timeMs) const;
+
+    // Segment with startMs <= timeMs <= endMs, or -1. A shared edge belongs
+    // to the earlier segment.
+    int indexAt(qint64 timeMs) const;
+
+    qint64 sourceDurationMs() const { return m_sourceBefore.last(); }
+    qint64 outputDurationMs() const { return qRound64(m_outputBefore.last()); }
+    // Position in the exported output of a timeline time. Time in a gap or
+    // before the first segment maps to where the next segment starts.
+    qint64 outputTimeAt(qint64 timeMs) const;
+
+    // Output seconds for the first `offsetSec` of a segment `durationSec`
+    // long whose speed ramps linearly from speedStart to speedEnd. Same
+    // math as the export's setpts expression.
+    static double retimedSec(double offsetSec, double durationSec, double speedStart, double speedEnd);
+
+private:
+    QVector<Span> m_spans;
+    QVector<qint64> m_starts;
+    QVector<qint64> m_ends;
+    QVector<qint64> m_sourceBefore{0}; // [i]: source ms of segments 0..i-1
+    QVector<double> m_outputBefore{0}; // [i]: output ms of segments 0..i-1
+};
+
+#endif // SIMPLEVIDEOEDITOR_SEGMENTINDEX_H
@@ -0,0 +1,97 @@
+#ifndef SIMPLEVIDEOEDITOR_THUMBNAILCACHE_H
+#define SIMPLEVIDEOEDITOR_THUMBNAILCACHE_H
+
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QtGlobal>
+
+// Timeline thumbnails in two tiers.
+//
+// Memory: per source path, frames keyed by source time (the tiles draw the
+// one nearest each slot). Once they outgrow a byte budget the frames shown
+// longest ago go first.
+//
+// Disk: one append-only file per source content and thumbnail size. The
+// content is identified by its size plus a hash of its first and last
+// 64 KiB, so a moved recording still hits and a new one saved over an old
+// path doesn't. Frames are stored as raw RGB888, so loading one is a seek
+// and a read. Finished passes are stored too, so a reopened file knows
+// which ranges are already done and at what spacing.
+//
+// The memory tier and the per-path disk index belong to the GUI thread.
+// The static file functions run on the worker pools.
+class ThumbnailCache {
+public:
+    static constexpr int kWidth = 112;
+    static constexpr int kHeight = 72;
+
+    // One extraction pass: keyframes at least spacingMs apart over
+    // [fromMs, toMs) of the source.
+    struct Pass {
+        QString path;
+        qint64 fromMs = 0;
+        qint64 toMs = 0;
+        qint64 spacingMs = 0;
+    };
+    struct DiskIndex {
+        QString file;
+        QMap<qint64, qint64> offsets; // source ms -> record offset
+        QList<Pass> passes;           // path left empty
+    };
+
+    // Disk tier. Any thread.
+    // Cache file for the source's content; empty if it can't be read.
+    static QString fileFor(const QString &sourcePath);
+    // Indexes `file`, cutting off a record torn by a crash, then prunes the
+    // cache directory down to its budget (least recently opened first).
+    static DiskIndex scan(const QString &file);
+    static QMap<qint64, QImage> load(const QString &file, const QMap<qint64, qint64> &offsets);
+    // Returns where each frame landed.
+    static QMap<qint64, qint64> append(const QString &file, const QMap<qint64, QImage> &frames);
+    static void appendPass(const QString &file, const Pass &pass);
+
+    // Memory tier. GUI thread.
+    bool isKnown(const QString &path) const { return m_sources.contains(path); }
+    bool isAttached(const QString &path) const;
+    void markOpening(const QString &path);
+    void attach(const QString &path, const DiskIndex &index);
+    QString fileOf(const QString &path) const { return m_sources.value(path).file; }
+
+    void insert(const QString &path, const QMap<qint64, QImage> &frames);
+    void addOnDisk(const QString &path, const QMap<qint64, qint64> &offsets);
+    // Result of load(): keeps what came back, forgets what didn't.
+    void loaded(const QString &path, const QMap<qint64, qint64> &requested, const QMap<qint64, QImage> &frames);
+    // Frames on disk but not in memory over [fromMs, toMs), thinned to
+    // spacingMs (frames already in memory count towards the spacing).
+    QMap<qint64, qint64> missing(const QString &path, qint64 fromMs, qint64 toMs, qint64 spacingMs) const;
+    // Marks the frames over [fromMs, toMs) as just shown.
+    void touch(const QString &path, qint64 fromMs, qint64 toMs);
+    // Source times of frames gone from both tiers since the last call:
+    // evicted from memory with no disk copy, or missing when loaded. The
+    // passes that produced them no longer cover those times.
+    QHash<QString, QList<qint64>> takeLost();
+
+    const QHash<QString, QMap<qint64, QImage>> &frames() const { return m_frames; }
+    void clear();
+
+private:
+    struct Source {
+        bool attached = false;
+        QString file;
+        QMap<qint64, qint64> onDisk;
+    };
+
+    void trim();
+
+    QHash<QString, Source> m_sources;
+    QHash<QString, QMap<qint64, QImage>> m_frames;
+    QHash<QString, QMap<qint64, quint64>> m_lastUse; // mirrors m_frames
+    QHash<QString, QList<qint64>> m_lost;
+    quint64 m_clock = 0;
+    qint64 m_bytes = 0;
+};
+
+#endif // SIMPLEVIDEOEDITOR_THUMBNAILCACHE_H
@@ -0,0 +1,186 @@
+#ifndef SIMPLEVIDEOEDITOR_TIMELINEMODEL_H
+#define SIMPLEVIDEOEDITOR_TIMELINEMODEL_H
+
+#include <QColor>
+#include <QList>
+#include <QObject>
+#include <QRectF>
+#include <QString>
+#include <QVector>
+#include <algorithm>
+
+// The composition: segments, sources, overlay clips and markers. There are
+// no widgets here, so it works as well from a headless export or a
+// benchmark as under the timeline.
+//
+// Every change is announced with the rows it touched and, for edits in
+// place, which fields. Views and caches can then update only that part:
+// the overlay lane index moves one clip, and the overlay schedule stays
+// untouched by a colour change. The lists are only readable from outside;
+// every edit goes through a mutator, which announces it, so no view can
+// miss one. Edits in place name the fields they touched. Ranges are
+// inclusive, in indices after the change (for removals, before it).
+class TimelineModel : public QObject {
+    Q_OBJECT
+public:
+    // A stretch of one source placed on the timeline.
+    struct Segment {
+        qint64 startMs;         // timeline time
+        qint64 endMs;           // timeline time
+        int sourceIdx = 0;      // which entry in `sources` this segment plays from
+        float volume = 1.0f;
+        float pitch = 1.0f;
+        bool muted = false;
+        float gain = 1.0f;
+        float cropTop = 0.0f;
+        float cropBottom = 1.0f;
+        float cropLeft = 0.0f;
+        float cropRight = 1.0f;
+        // Linear playback speed ramp across the segment; equal values (the
+        // default) mean plain constant-speed playback.
+        float speedStart = 1.0f;
+        float speedEnd = 1.0f;
+    };
+
+    // A media file placed on the timeline. sources[0] is the primary file;
+    // additional files appended by dropping them onto the timeline follow it.
+    struct SourceClip {
+        QString path;
+        qint64 offsetMs = 0;    // where this source's t=0 sits on the timeline
+        qint64 durationMs = 0;
+        qint64 fileSizeBytes = 0;
+        bool hasVideo = true;
+        bool hasAudio = true;
+    };
+
+    // Where a tracked overlay's region sits (top-left, normalized) at a
+    // timeline time.
+    struct RegionKeyframe {
+        qint64 timeMs = 0;
+        float l = 0.0f;
+        float t = 0.0f;
+    };
+
+    // A time-ranged effect clip that lives on its own lane above the video
+    // track (blur / pixelate / blackout region, text, shape/arrow annotation,
+    // a color-correction region, or an image/logo watermark).
+    struct OverlayClip {
+        int type = 0;           // 0 blur, 1 pixelate, 2 blackout, 3 text, 4 shape, 5 colorcorrect, 6 image
+        qint64 startMs = 0;     // timeline time
+        qint64 endMs = 0;
+        float l = 0.4f, t = 0.4f, r = 0.6f, b = 0.6f; // region on the video, normalized
+        QString text;           // only for type 3
+        // type 4 (shape/arrow annotation)
+        int shapeKind = 0;      // 0 rectangle, 1 ellipse, 2 arrow
+        QColor shapeColor = QColor(255, 255, 255);
+        int shapeThickness = 4;
+        // type 5 (color correction)
+        float brightness = 0.0f; // -1..1
+        float contrast = 1.0f;   // 0..2
+        float saturation = 1.0f; // 0..2
+        // type 6 (image/logo), stretched to the region
+        QString imagePath;
+        float opacity = 1.0f;    // 0..1
+        // Motion track, ascending by time. When present it moves the region
+        // (linearly between keyframes, held before the first and after the
+        // last); the size is always r - l by b - t.
+        QVector<RegionKeyframe> keyframes;
+
+        QRectF regionAt(qint64 timeMs) const {
+            float x = l, y = t;
+            if (!keyframes.isEmpty()) {
+                const auto next = std::lower_bound(keyframes.cbegin(), keyframes.cend(), timeMs,
+                    [](const RegionKeyframe &k, qint64 ms) { return k.timeMs < ms; });
+                if (next == keyframes.cbegin()) {
+                    x = next->l; y = next->t;
+                } else if (next == keyframes.cend()) {
+                    x = keyframes.last().l; y = keyframes.last().t;
+                } else {
+                    const auto prev = next - 1;
+                    const float f = float(timeMs - prev->timeMs) / float(qMax<qint64>(1, next->timeMs - prev->timeMs));
+                    x = prev->l + (next->l - prev->l) * f;
+                    y = prev->t + (next->t - prev->t) * f;
+                }
+            }
+            return QRectF(x, y, r - l, b - t);
+        }
+
+        // A region edit made on the preview at `timeMs`. Untracked clips just
+        // take it; tracked ones keep the new size and get a keyframe there.
+        void setRegionAt(qint64 timeMs, float nl, float nt, float nr, float nb) {
+            if (keyframes.isEmpty()) {
+                l = nl; t = nt; r = nr; b = nb;
+                return;
+            }
+            r = l + (nr - nl);
+            b = t + (nb - nt);
+            auto at = std::lower_bound(keyframes.begin(), keyframes.end(), timeMs,
+                [](const RegionKeyframe &k, qint64 ms) { return k.timeMs < ms; });
+            if (at != keyframes.end() && at->timeMs == timeMs) {
+                at->l = nl; at->t = nt;
+            } else {
+                keyframes.insert(at, RegionKeyframe{timeMs, nl, nt});
+            }
+        }
+    };
+
+
+    enum Field {
+        Timing = 0x01,     // startMs / endMs
+        Geometry = 0x02,   // segment crop; overlay region and keyframes
+        Audio = 0x04,      // gain, volume, pitch, mute
+        Speed = 0x08,      // speed ramp
+        Appearance = 0x10, // overlay text, shape, colour, image, opacity
+        AllFields = 0xff
+    };
+    Q_DECLARE_FLAGS(Fields, Field)
+
+    explicit TimelineModel(QObject *parent = nullptr) : QObject(parent) {}
+
+    const QList<Segment> &segments() const { return m_segments; }
+    const QList<SourceClip> &sources() const { return m_sources; }
+    const QList<OverlayClip> &overlays() const { return m_overlays; }
+    const QList<qint64> &markers() const { return m_markers; }
+
+    void setSegments(const QList<Segment> &segments);
+    void insertSegment(int index, const Segment &segment);
+    void removeSegments(int first, int last);
+    void setSources(const QList<SourceClip> &sources);
+    void appendSource(const SourceClip &source);
+    void setOverlays(const QList<OverlayClip> &overlays);
+    void insertOverlay(int index, const OverlayClip &overlay);
+    void removeOverlays(int first, int last);
+    void setMarkers(const QList<qint64> &markers);
+    // Keeps markers sorted.
+    void addMarker(qint64 timeMs);
+    void removeMarker(int index);
+
+    // Replace one row in place; `fields` says what differs.
+    void setSegment(int index, const Segment &segment, Fields fields);
+    void setSource(int index, const SourceClip &source);
+    void setOverlay(int index, const OverlayClip &overlay, Fields fields);
+
+signals:
+    void segmentsInserted(int first, int last);
+    void segmentsRemoved(int first, int last);
+    void segmentsChanged(int first, int last, TimelineModel::Fields fields);
+    void segmentsReset();
+    void sourcesInserted(int first, int last);
+    void sourcesChanged(int first, int last);
+    void sourcesReset();
+    void overlaysInserted(int first, int last);
+    void overlaysRemoved(int first, int last);
+    void overlaysChanged(int first, int last, TimelineModel::Fields fields);
+    void overlaysReset();
+    void markersChanged();
+
+private:
+    QList<Segment> m_segments;
+    QList<SourceClip> m_sources;
+    QList<OverlayClip> m_overlays;
+    QList<qint64> m_markers;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(TimelineModel::Fields)
+
+#endif // SIMPLEVIDEOEDITOR_TIMELINEMODEL_H
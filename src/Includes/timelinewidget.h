@@ -2,8 +2,6 @@
 #define TIMELINEWIDGET_H
 
 #include <QWidget>
-#include <QMediaPlayer>
-#include <QVideoSink>
 #include <QList>
 #include <QUrl>
 #include <QMap>
@@ -20,9 +18,24 @@
 #include <QString>
 #include <QQueue>
 #include <QColor>
+#include <QRectF>
+#include <QVector>
+#include <QFont>
+#include <QHash>
+#include <QImage>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <algorithm>
+#include <atomic>
 #include "mediaSource.h"
+#include "overlayIndex.h"
+#include "segmentIndex.h"
+#include "timelineModel.h"
+#include "thumbnailCache.h"
+#include "waveformPyramid.h"
 
 class QProcess;
+class QPainter;
 
 class TimelineWidget : public QWidget {
     Q_OBJECT
@@ -60,59 +73,19 @@ public:
         bool includeSourceNameInExport = true;
     };
 
-    // 1. Move Segment inside the class to fix scoping errors
-    struct Segment {
-        qint64 startMs;         // timeline time
-        qint64 endMs;           // timeline time
-        int sourceIdx = 0;      // which entry in `sources` this segment plays from
-        float volume = 1.0f;
-        float pitch = 1.0f;
-        bool muted = false;
-        float gain = 1.0f;
-        float cropTop = 0.0f;
-        float cropBottom = 1.0f;
-        float cropLeft = 0.0f;
-        float cropRight = 1.0f;
-        // Linear playback speed ramp across the segment; equal values (the
-        // default) mean plain constant-speed playback.
-        float speedStart = 1.0f;
-        float speedEnd = 1.0f;
-    };
-
-    // A media file placed on the timeline. sources[0] is the primary file;
-    // additional files appended by dropping them onto the timeline follow it.
-    struct SourceClip {
-        QString path;
-        qint64 offsetMs = 0;    // where this source's t=0 sits on the timeline
-        qint64 durationMs = 0;
-        qint64 fileSizeBytes = 0;
-        bool hasVideo = true;
-        bool hasAudio = true;
-    };
-
-    // A time-ranged effect clip that lives on its own lane above the video
-    // track (blur / pixelate / blackout region, text, shape/arrow annotation,
-    // or a color-correction region).
-    struct OverlayClip {
-        int type = 0;           // 0 blur, 1 pixelate, 2 blackout, 3 text, 4 shape, 5 colorcorrect
-        qint64 startMs = 0;     // timeline time
-        qint64 endMs = 0;
-        float l = 0.4f, t = 0.4f, r = 0.6f, b = 0.6f; // region on the video, normalized
-        QString text;           // only for type 3
-        // type 4 (shape/arrow annotation)
-        int shapeKind = 0;      // 0 rectangle, 1 ellipse, 2 arrow
-        QColor shapeColor = QColor(255, 255, 255);
-        int shapeThickness = 4;
-        // type 5 (color correction)
-        float brightness = 0.0f; // -1..1
-        float contrast = 1.0f;   // 0..2
-        float saturation = 1.0f; // 0..2
-    };
-
-    QList<SourceClip> sources;
-    QList<OverlayClip> overlays;
+    using Segment = TimelineModel::Segment;
+    using SourceClip = TimelineModel::SourceClip;
+    using RegionKeyframe = TimelineModel::RegionKeyframe;
+    using OverlayClip = TimelineModel::OverlayClip;
+
+    // The composition. The lists below are read-only views of the model's
+    // own, named here so the timeline (and MainWindow) read them directly;
+    // edits go through the model's mutators.
+    TimelineModel *const model;
+    const QList<SourceClip> &sources;
+    const QList<OverlayClip> &overlays;
     int selectedOverlayIdx = -1;
-    QList<qint64> markers;
+    const QList<qint64> &markers;
     void toggleMarkerAtPlayhead();
 
     explicit TimelineWidget(QWidget* parent = nullptr);
@@ -120,6 +93,10 @@ public:
     void setMediaSource(const QUrl &url);
     void setDuration(qint64 ms);
     void setCurrentPosition(qint64 ms);
+    // Playback state and rate of the player reporting positions through
+    // setCurrentPosition(); while playing, the playhead is extrapolated
+    // between reports and redrawn at the display's refresh rate.
+    void setPlaybackClock(bool playing, double rate);
 
     int currentAudioTrack = 0;
     int totalAudioTracks = 1;
@@ -144,15 +121,50 @@ public:
     void addOverlayAt(int type, qint64 timeMs);
     void addOverlayAtPlayhead(int type) { addOverlayAt(type, currentPosMs); }
     void deleteSelectedOverlay();
+    // Replaces an overlay's motion track (undoable); an empty list removes it.
+    void setOverlayKeyframes(int index, const QVector<RegionKeyframe> &keyframes);
     QList<int> overlaysAtTime(qint64 timeMs) const;
+    // Overlay activation schedule for playback. A slot is the stretch
+    // between two consecutive overlay boundaries, so the active set only
+    // changes when the slot does; finding it is a binary search. Slot
+    // numbers are only comparable while the revision stays the same.
+    int overlaySlotAt(qint64 timeMs) const;
+    const QList<int> &overlaysInSlot(int slot) const; // ascending overlay index
+    quint64 overlayScheduleRevision() const { ensureOverlaySchedule(); return overlayScheduleRev; }
     QVector<int> computeOverlayLanes() const;
     int overlayLaneCount() const;
 
+    // --- Render cache: overlay-heavy ranges pre-rendered for playback ---
+    // A stretch of one segment where the active overlays cost more than the
+    // live preview compositor should be asked to keep up with. Rendered, it
+    // is a preview-sized clip with the overlays baked in (source time, no
+    // crop or speed: the preview doesn't apply those either) that playback
+    // shows instead of compositing. Keyed by a hash of everything baked into
+    // it, so any edit that touches the range makes it stale by itself.
+    struct RenderRange {
+        enum State { Stale, Rendering, Ready };
+        qint64 startMs = 0;     // timeline time
+        qint64 endMs = 0;
+        int sourceIdx = 0;
+        QByteArray key;
+        QString cachePath;
+        State state = Stale;
+    };
+    // The rendered range under `timeMs`, or null.
+    const RenderRange *readyRenderRangeAt(qint64 timeMs);
+    void renderStaleRanges();
+    void clearRenderCache();
+    // Deletes a cached clip playback couldn't open; its range goes back to
+    // live compositing and isn't re-rendered until its contents change.
+    void discardRenderClip(const QString &cachePath);
+    // Render stale ranges on their own after a few idle seconds.
+    void setAutoRenderCache(bool enabled);
+
     // --- Multi-source timeline ---
     void appendMediaSource(const QString &path);
     int sourceIndexForTimelineTime(qint64 timeMs) const;
     qint64 sourceOffsetMs(int sourceIdx) const {
-        return (sourceIdx >= 0 && sourceIdx < sources.size()) ? sources[sourceIdx].offsetMs : 0;
+        return (sourceIdx >= 0 && sourceIdx < model->sources().size()) ? model->sources()[sourceIdx].offsetMs : 0;
     }
 
     // Metadata for the header chips
@@ -178,6 +190,10 @@ public:
     void copyTrimmedVideoMuted();
     QString customExportName;
     double getTotalSegmentsDuration();
+    // Length of the export and where a timeline time lands in it, speed
+    // ramps applied.
+    qint64 outputDurationMs() const { return ensureSegmentIndex().outputDurationMs(); }
+    qint64 outputTimeAt(qint64 timeMs) const { return ensureSegmentIndex().outputTimeAt(timeMs); }
     bool sourceHasVideo() const { return hasVideoStream; }
     bool sourceHasAudio() const { return hasAudioStream; }
     AutoCutSettings getAutoCutSettings() const { return autoCutSettings; }
@@ -191,19 +207,22 @@ public:
     bool visualStateForCurrentContext(float &t, float &b, float &l, float &r) const;
     void applySpeedRampToSelection(float speedStart, float speedEnd, bool allSegments);
     static void showNotification(const QString &message);
+    // Retires the cached tiles and repaints. Model edits do this by
+    // themselves; call it for anything else the tiles draw (thumbnails,
+    // waveforms, render state, layout). A plain update() keeps the tiles,
+    // and playhead-only changes use updatePlayhead().
+    void invalidateScene();
+    void updatePlayhead();
     QColor m_accentColor = QColor("#3D5AFE"); // Defaults in case QSS fails
     QColor m_secondaryColor = QColor("#FF3232");
     QColor m_backgroundColor = QColor("#080809");
     QColor m_trackColor = QColor("#1A1A1C");
     QColor m_waveformColor = QColor("#88888E");
 
-    float getGainAtPos(qint64 posMs) {
-        for (const auto& seg : segments) {
-            if (posMs >= seg.startMs && posMs <= seg.endMs) {
-                return seg.muted ? 0.0f : seg.gain;
-            }
-        }
-        return 1.0f; // Default if not inside a segment
+    float getGainAtPos(qint64 posMs) const {
+        const int idx = segmentIndexAtTime(posMs);
+        if (idx < 0) return 1.0f; // Default if not inside a segment
+        return model->segments()[idx].muted ? 0.0f : model->segments()[idx].gain;
     }
 
 signals:
@@ -248,7 +267,6 @@ protected:
 
 
 
-    void updateEditorVolume();
 
 private:
     struct TimelineState {
@@ -258,7 +276,7 @@ private:
         QString label;
     };
 
-    QList<Segment> segments;
+    const QList<Segment> &segments;
     QList<TimelineState> undoStack;
     QList<TimelineState> redoStack;
     const int MAX_STACK_SIZE = 50;
@@ -274,21 +292,159 @@ private:
     qint64 overlayDragGrabOffsetMs = 0;
     int overlayIndexAt(const QPoint &pos, OverlayDragMode *edge = nullptr) const;
     qint64 snappedTime(qint64 t, double pxPerMs) const;
+    // What a drag can snap to besides the playhead, sorted: markers, segment
+    // and overlay edges, and audio onsets in timeline time. Built when a
+    // drag starts, minus the clip being dragged, so each move is a binary
+    // search.
+    QVector<qint64> snapTargets;
+    void buildSnapTargets(int skipSegment, int skipOverlay);
+
+    // Every overlay start/end, sorted and unique, and the overlays active
+    // from each one up to the next. Rebuilt on first use after the model
+    // reports a clip added, removed or retimed.
+    mutable QVector<qint64> overlayCuts;
+    mutable QVector<QList<int>> overlaySlots;
+    mutable bool overlayScheduleDirty = true;
+    mutable quint64 overlayScheduleRev = 0;
+    void ensureOverlaySchedule() const;
+
+    // Interval tree and lanes over the overlay clips, kept in step with the
+    // model's overlay signals: inserts, removals and retimes update it in
+    // place; a reset (undo, redo, a new file) sets overlayIndexDirty instead.
+    mutable OverlayIndex overlayIndex;
+    mutable bool overlayIndexDirty = true;
+    const OverlayIndex &ensureOverlayIndex() const;
+
+    // Binary-searchable view of `segments`, rebuilt on first use after the
+    // model reports a segment added, removed, retimed or re-sped, which
+    // bumps segmentRevision.
+    mutable SegmentIndex segmentIndex;
+    quint64 segmentRevision = 1;
+    mutable quint64 segmentIndexRevision = 0;
+    const SegmentIndex &ensureSegmentIndex() const;
+    int segmentEdgeAt(int drawX, double pxPerMs, bool *isStart) const;
 
     void saveState(const QString &label = QString());
 
-    QMediaPlayer* thumbPlayer;
-    QVideoSink* videoSink;
-    QMap<int, QImage> thumbnailCache;
-    // Filmstrip images (10 tiled frames) for appended sources, keyed by source index
-    QMap<int, QImage> sourceFilmstrips;
-    void ensureSourceFilmstrip(int sourceIdx);
-    QQueue<int> thumbnailRequestQueue;
-    bool thumbnailRequestActive = false;
-    QVector<float> audioSamples;
+    // Render cache (renderCache.cpp)
+    static constexpr int renderCacheMaxWidth = 1280;
+    QList<RenderRange> renderRanges;
+    bool renderRangesDirty = true;
+    QSet<QByteArray> failedRenderKeys;
+    QByteArray renderingKey;
+    QProcess *renderProcess = nullptr;
+    QTimer *renderIdleTimer = nullptr;
+    bool renderQueueActive = false;
+    bool autoRenderCache = false;
+    void ensureRenderRanges();
+    void startNextRenderJob();
+    static void drawRenderBar(QPainter &painter, const QList<RenderRange> &ranges, int top, double pxPerMs);
+    QStringList renderCacheArguments(const RenderRange &range, const QString &outputPath) const; // export.cpp
+
+    // --- Timeline tiles (timelineTiles.cpp) ---
+    // Everything but the playhead and the selection (outlines, the selected
+    // overlay and its trim handles) is drawn into kTileWidth-wide strips of
+    // the scrolled content, from an immutable snapshot of the composition,
+    // and reused until invalidateScene() or a zoom/size change. Visible tiles that went stale keep showing
+    // until their replacement arrives from the interface pool; only a tile
+    // with nothing to show yet is drawn on the spot. Tiles a viewport either
+    // side are prefetched, further ones dropped.
+    static constexpr int kTileWidth = 256;
+    struct TileScene {
+        qint64 durationMs = 0;
+        int contentWidth = 0;
+        int rulerHeight = 0;
+        int trackHeight = 0;
+        int vTop = 0;
+        int aTop = 0;
+        int lanesTop = 0;
+        int laneCount = 0;
+        QVector<int> lanes;
+        QColor accent, track, background;
+        QFont font;
+        QList<Segment> segments;
+        QList<SourceClip> sources;
+        QList<OverlayClip> overlays;
+        QList<qint64> markers;
+        QList<RenderRange> renderRanges;
+        // Copies of the widget's indexes, so a tile visits only the clips
+        // that reach into it.
+        SegmentIndex segmentIndex;
+        OverlayIndex overlayIndex;
+        QHash<QString, QMap<qint64, QImage>> thumbnails;
+        QVector<QSharedPointer<const WaveformPyramid>> waveforms; // per source, may be null
+        bool hasWaveforms = false;
+        float waveformPeak = 0.0f;
+    };
+    struct TileGeometry {
+        int contentWidth = 0;
+        int height = 0;
+        qreal dpr = 1.0;
+        bool operator==(const TileGeometry &o) const {
+            return contentWidth == o.contentWidth && height == o.height && dpr == o.dpr;
+        }
+    };
+    struct Tile {
+        QImage image;
+        quint64 revision = 0;
+    };
+    QHash<int, Tile> tiles;
+    TileGeometry tileGeometry;
+    quint64 tileGeneration = 0;    // bumped with tileGeometry; drops late results
+    QSet<int> tilesInFlight;       // one job per tile at a time
+    quint64 sceneRevision = 1;     // bumped by invalidateScene()
+    quint64 tileSceneRevision = 0;
+    QSharedPointer<const TileScene> tileScene;
+    // Where paintEvent draws the playhead. Moved only by updatePlayhead(),
+    // together with the strips it repaints, or by a repaint of everything.
+    qint64 paintedPlayheadMs = 0;
+    // Playhead extrapolation between the player's position reports.
+    QTimer *playheadTimer = nullptr;
+    QElapsedTimer playheadClock;   // since the last report
+    qint64 playheadAnchorMs = 0;   // the last report
+    qint64 playheadHoldMs = -1;    // drawn position not to step back past
+    double playheadRate = 1.0;
+    bool playheadRunning = false;
+    qint64 playheadDrawMs() const;
+    void anchorPlayhead(qint64 reportedMs);
+    QSharedPointer<const TileScene> currentTileScene();
+    void paintTiles(QPainter &painter, const QRect &contentRect);
+    void requestTile(int index, const QSharedPointer<const TileScene> &scene);
+    static QImage renderTile(const TileScene &scene, const TileGeometry &geometry, int index);
+    static void paintStaticLayer(QPainter &painter, const TileScene &scene, int x0, int x1);
+    static void paintOverlayClip(QPainter &painter, const OverlayClip &ov, const QRectF &r, bool selected,
+                                 double pxPerMs);
+    void paintSelection(QPainter &painter, const QRect &contentRect);
+
+    // Keyframe thumbnails per source file, keyed by source time: shown
+    // from memory, reloaded from the disk tier, or extracted by single
+    // ffmpeg passes over the visible range, as dense as the zoom needs.
+    // Finished passes are remembered while their frames last, so panning
+    // back doesn't repeat them.
+    ThumbnailCache thumbnailCache;
+    QList<ThumbnailCache::Pass> thumbnailPasses;
+    QTimer *thumbnailTimer = nullptr;
+    bool thumbnailPassActive = false;
+    bool thumbnailLoadActive = false;
+    ThumbnailCache::Pass thumbnailActivePass;
+    quint64 thumbnailGeneration = 0; // bumped by resetMediaState; drops late results
+    QSharedPointer<std::atomic_bool> thumbnailCancel;
+    void scheduleThumbnails();
+    void requestThumbnails();
+    void openThumbnailCache(const QString &path);
+    void loadThumbnails(const QString &path, const QMap<qint64, qint64> &offsets);
+    void dropLostThumbnailPasses();
+    // One pyramid per decoded (file, audio track), shared by every source
+    // clip of that file and replaced by longer ones while it decodes;
+    // waveformPeak is the loudest of them.
+    QHash<QString, QSharedPointer<const WaveformPyramid>> waveforms;
+    float waveformPeak = 0.0f;
+    static QString waveformKey(const QString &path, int track) { return path + '#' + QString::number(track); }
+    const WaveformPyramid *sourceWaveform(int sourceIdx) const;
+    void refreshWaveformPeak();
+    void requestWaveform(const QString &path, int track, bool announceProbing);
     QUrl currentFileUrl;
     qint64 originalFileSize = 0;
-    float maxAmplitude = 0.01f;
 
     double zoomFactor = 1.0;
     int scrollOffset = 0;
@@ -319,9 +475,6 @@ private:
 
     void loadAudioFast(const QString &path);
     void appendAudioWaveform(const QString &path);
-    void processVideoFrame(const QVideoFrame &frame);
-    void requestTimelineThumbnails();
-    void requestNextTimelineThumbnail();
     int segmentIndexAtTime(qint64 timeMs) const;
     int activeVisualSegmentIndex() const;
     QSet<int> targetVisualSegments() const;
@@ -0,0 +1,52 @@
+#ifndef SIMPLEVIDEOEDITOR_TRIPLEBUFFER_H
+#define SIMPLEVIDEOEDITOR_TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Lock-free single-producer / single-consumer triple buffer.
+//
+// The producer fills back() and publish()es it; the consumer consume()s the
+// newest published slot into front(). Neither side ever waits for the other:
+// a value published before the previous one was consumed simply replaces it
+// (publish() reports that, so callers can count drops). Each side owns its
+// slot exclusively between calls, so slots can hold heavy objects (frames,
+// images) that are rewritten in place instead of reallocated.
+template <typename T>
+class TripleBuffer {
+public:
+    // Producer side.
+    T &back() { return m_slots[m_back]; }
+
+    // Hands back() to the consumer and takes over the spare slot. Returns
+    // true when the value it displaces was never consumed.
+    bool publish() {
+        const int prev = m_middle.exchange(m_back | kFresh, std::memory_order_acq_rel);
+        m_back = prev & kIndexMask;
+        return (prev & kFresh) != 0;
+    }
+
+    // Consumer side. Swaps in the newest published value; false (front()
+    // unchanged) when nothing new was published since the last call.
+    bool consume() {
+        if (!hasFresh()) return false;
+        const int prev = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = prev & kIndexMask;
+        return true;
+    }
+
+    T &front() { return m_slots[m_front]; }
+
+    // Safe from either side.
+    bool hasFresh() const { return (m_middle.load(std::memory_order_acquire) & kFresh) != 0; }
+
+private:
+    static constexpr int kIndexMask = 3;
+    static constexpr int kFresh = 4;
+
+    T m_slots[3];
+    int m_back = 0;                 // producer-owned
+    int m_front = 1;                // consumer-owned
+    std::atomic<int> m_middle{2};   // spare slot index | kFresh
+};
+
+#endif // SIMPLEVIDEOEDITOR_TRIPLEBUFFER_H
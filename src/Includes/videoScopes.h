@@ -0,0 +1,103 @@
+#ifndef SIMPLEVIDEOEDITOR_VIDEOSCOPES_H
+#define SIMPLEVIDEOEDITOR_VIDEOSCOPES_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QObject>
+#include <QWidget>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "tripleBuffer.h"
+
+// Video scopes for the preview: luma waveform, RGB histogram and a Cb/Cr
+// vectorscope, measured on the composited preview frame (so color-correct
+// overlays show up in them) in BT.709, full range.
+namespace VideoScopes {
+
+constexpr int kLevels = 256;
+constexpr int kWaveformColumns = 256;
+constexpr int kVectorSize = 128;      // vectorscope bins per axis
+constexpr int kMaxSampleWidth = 384;  // decimated copy the analysis runs on
+
+// One finished analysis. The two 2-D scopes are already rendered to small
+// premultiplied images (the widget just scales them), the histogram is
+// left as counts.
+struct ScopeFrame {
+    QImage waveform;     // kWaveformColumns x kLevels, luma 255 on the top row
+    QImage vectorscope;  // kVectorSize^2, Cb left -> right, Cr bottom -> top
+    std::array<std::array<quint32, kLevels>, 3> histogram{}; // R, G, B
+    quint32 histogramPeak = 0; // tallest bin, ignoring the clipped 0/255 ends
+    bool valid = false;
+};
+
+}
+
+// Runs the scopes next to (never inside) the preview worker. The worker
+// offer()s each composited frame; at most rate() times a second that takes
+// a decimated copy and starts one analysis task on the thread pool. A frame
+// offered too early, or while the previous analysis is still running, is
+// ignored, so the preview never waits on the scopes.
+class ScopeAnalyzer : public QObject {
+    Q_OBJECT
+public:
+    explicit ScopeAnalyzer(QObject *parent = nullptr);
+    ~ScopeAnalyzer() override;
+
+    // Analyses per second; 0 switches the scopes off.
+    void setRate(int perSecond);
+    int rate() const { return m_rate.load(std::memory_order_relaxed); }
+
+    // Preview worker thread only.
+    void offer(const QImage &frame);
+
+    // GUI thread: swap in the newest finished analysis (false if none since
+    // the last call) and read it.
+    bool takeLatest() { return m_results.consume(); }
+    const VideoScopes::ScopeFrame &latest() { return m_results.front(); }
+
+signals:
+    // From the analysis task; connect with the default (queued) connection.
+    void updated();
+
+private:
+    void analyze();
+
+    std::atomic<int> m_rate{0};
+    // Worker-side throttle.
+    QElapsedTimer m_clock;
+    qint64 m_lastSampleMs = -1;
+    // Set from the moment a sample is taken until its analysis is published;
+    // m_sample belongs to the analysis task while it is set.
+    QAtomicInt m_busy{0};
+    QImage m_sample;
+    // Analysis scratch, grow-only.
+    std::vector<quint8> m_luma;
+    std::vector<quint8> m_cb;
+    std::vector<quint8> m_cr;
+    std::vector<int> m_columnBin;
+    std::vector<quint32> m_waveCounts;
+    std::vector<quint32> m_vectorCounts;
+    TripleBuffer<VideoScopes::ScopeFrame> m_results;
+};
+
+// Waveform | histogram | vectorscope strip shown under the preview. Keeps
+// the analyzer running at the configured rate only while it is visible.
+class ScopesWidget : public QWidget {
+    Q_OBJECT
+public:
+    explicit ScopesWidget(ScopeAnalyzer *analyzer, QWidget *parent = nullptr);
+    void setRefreshRate(int perSecond);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    ScopeAnalyzer *m_analyzer;
+    int m_refreshRate = 10;
+};
+
+#endif // SIMPLEVIDEOEDITOR_VIDEOSCOPES_H
@@ -0,0 +1,93 @@
+#ifndef SIMPLEVIDEOEDITOR_WAVEFORMPYRAMID_H
+#define SIMPLEVIDEOEDITOR_WAVEFORMPYRAMID_H
+
+#include <QVector>
+#include <QtGlobal>
+#include <vector>
+
+// Min/max/RMS summary of one source's audio track at a ladder of
+// resolutions, like a texture mipmap. Level 0 holds one bin per
+// kBaseBinSamples of the 8 kHz mono decode (2.5 ms); each level above
+// folds kFanIn bins of the one below. A query for any time span reads the
+// coarsest level whose bins still fit inside it, so it touches a handful
+// of bins whether it is one pixel of a deep zoom or one pixel of a
+// four-hour overview.
+//
+// Built by append()ing PCM as it is decoded (upper levels grow as soon as
+// a group below them is complete), then finish()ed. Not thread-safe; build
+// it on one thread, then share it read-only. A copy taken mid-build is a
+// usable partial pyramid (minus the onsets), which is how the timeline
+// shows a waveform while it is still decoding. Levels are stored in
+// fixed-size blocks, so such a copy shares them all and the next append()
+// copies only the block it writes to, however long the track.
+class WaveformPyramid {
+public:
+    static constexpr int kSampleRate = 8000;
+    static constexpr int kBaseBinSamples = 20;
+    static constexpr int kFanIn = 4;
+
+    // Amplitudes are -1..1 (rms 0..1).
+    struct Range {
+        float min = 0.0f;
+        float max = 0.0f;
+        float rms = 0.0f;
+        bool valid = false;
+    };
+
+    void append(const qint16 *samples, qsizetype count);
+    // Flushes the partial bins at the end and picks out the onsets; call
+    // once, after the last append().
+    void finish();
+
+    bool isEmpty() const { return m_levels.isEmpty() || m_levels[0].isEmpty(); }
+    qint64 durationMs() const { return m_samples * 1000 / kSampleRate; }
+    int levelCount() const { return int(m_levels.size()); }
+    // Largest |amplitude| anywhere in the track.
+    float peak() const { return m_peak / 32767.0f; }
+
+    // Summary of [fromMs, toMs) (track-local), from bins overlapping it.
+    Range range(qint64 fromMs, qint64 toMs) const;
+
+    // Track-local times (ms, ascending) where the level jumps well clear of
+    // the recent noise floor: speech starting, a hit, a clap. Snap targets
+    // for trimming; empty until finish().
+    const QVector<qint64> &onsetsMs() const { return m_onsets; }
+
+private:
+    // Quantized like the PCM, so a four-hour track stays tens of MB.
+    struct Bin {
+        qint16 min;
+        qint16 max;
+        quint16 rms;
+    };
+    // One level's bins. Blocks are implicitly shared; only the last one is
+    // ever written.
+    class Level {
+    public:
+        static constexpr qsizetype kBlockBins = 4096; // a multiple of kFanIn
+        qsizetype size() const { return m_size; }
+        bool isEmpty() const { return m_size == 0; }
+        const Bin &operator[](qsizetype i) const { return m_blocks[i / kBlockBins][i % kBlockBins]; }
+        void append(const Bin &bin) {
+            if (m_size % kBlockBins == 0) m_blocks.append(QVector<Bin>());
+            m_blocks.last().append(bin);
+            ++m_size;
+        }
+    private:
+        QVector<QVector<Bin>> m_blocks;
+        qsizetype m_size = 0;
+    };
+
+    static qint64 binSamples(int level);
+    void addBaseBin(const qint16 *pcm, qsizetype count);
+    void push(int level, const Bin &bin);
+    void detectOnsets();
+
+    QVector<Level> m_levels;
+    std::vector<qint16> m_tail; // < kBaseBinSamples samples not yet in a bin
+    qint64 m_samples = 0;
+    int m_peak = 0;
+    QVector<qint64> m_onsets;
+};
+
+#endif // SIMPLEVIDEOEDITOR_WAVEFORMPYRAMID_H
@@ -0,0 +1,66 @@
+#ifndef SIMPLEVIDEOEDITOR_WORKERPOOLS_H
+#define SIMPLEVIDEOEDITOR_WORKERPOOLS_H
+
+#include <QString>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <utility>
+
+// App-wide scheduling: one thread pool per kind of work, each with its own
+// thread count and OS priority. Background jobs only ever queue behind each
+// other, never in front of a preview frame. Nothing of ours runs on
+// QThreadPool::globalInstance().
+namespace WorkerPools {
+
+enum Kind {
+    Preview = 0, // latency critical: frame composites and their band jobs
+    Analysis,    // CPU-heavy background work: scopes, waveforms, thumbnails
+    FileIO,      // blocking disk work: image encoding/saving, cache upkeep
+    Interface,   // drawing the UI needs off the GUI thread: timeline tiles
+    KindCount
+};
+
+// Snapshot of one pool. Wait is submit -> start, for tasks submitted
+// through run() (band jobs inside a preview composite aren't counted).
+struct PoolStats {
+    int maxThreads = 0;
+    int activeThreads = 0;
+    int queued = 0;         // submitted, not started yet
+    int peakQueued = 0;
+    quint64 completed = 0;
+    double avgWaitMs = 0;
+    double maxWaitMs = 0;
+};
+
+QThreadPool *pool(Kind kind);
+QString name(Kind kind);
+// threadCount 0 restores the pool's automatic size.
+void setThreadCount(Kind kind, int threadCount);
+void setPriority(Kind kind, QThread::Priority priority);
+PoolStats stats(Kind kind);
+
+// Task accounting used by run().
+qint64 nowNs();
+void noteQueued(Kind kind);
+void noteStarted(Kind kind, qint64 queuedAtNs);
+void noteFinished(Kind kind);
+
+// QtConcurrent::run on the pool for `kind`, with queue metrics.
+template <typename Function>
+auto run(Kind kind, Function &&function) {
+    noteQueued(kind);
+    const qint64 queuedAtNs = nowNs();
+    return QtConcurrent::run(pool(kind), [kind, queuedAtNs, function = std::forward<Function>(function)]() mutable {
+        noteStarted(kind, queuedAtNs);
+        struct Finished {
+            Kind kind;
+            ~Finished() { noteFinished(kind); }
+        } finished{kind};
+        return function();
+    });
+}
+
+}
+
+#endif // SIMPLEVIDEOEDITOR_WORKERPOOLS_H
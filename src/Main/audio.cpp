@@ -1,11 +1,20 @@
-#include <QAudioOutput>
-#include <QDir>
+#include <QElapsedTimer>
 #include <QProcess>
 #include <QRegularExpression>
 #include <QCoreApplication>
+#include <QPointer>
 #include <QSharedPointer>
+#include <atomic>
 
 #include "../Includes/timelinewidget.h"
+#include "../Includes/workerPools.h"
+
+namespace {
+// One read off ffmpeg's stdout: about 4 s of 8 kHz s16 mono.
+constexpr qint64 kWaveformChunkBytes = 64 * 1024;
+// How often a partial pyramid reaches the timeline while decoding.
+constexpr qint64 kWaveformPublishMs = 250;
+}
 
 // Helper function to resolve the bundled binary path
 static QString getFFToolPath(const QString &tool) {
@@ -18,92 +27,113 @@ static QString getFFToolPath(const QString &tool) {
 
 void TimelineWidget::loadAudioFast(const QString &inputPath) {
     if (!hasAudioStream) {
-        audioSamples.clear();
-        maxAmplitude = 0.01f;
-        update();
+        invalidateScene();
         emit mediaProbingFinished();
         return;
     }
+    requestWaveform(inputPath, currentAudioTrack, /*announceProbing=*/true);
+}
 
-    QString tempAudioPath = QDir::tempPath() + QString("/potato_wave_%1.raw").arg(qAbs(qHash(inputPath)));
-    auto *ffmpeg = new QProcess(this);
-    QStringList args;
-    args << "-y" << "-i" << inputPath
-         << "-map" << QString("0:a:%1").arg(currentAudioTrack)
-         << "-f" << "s16le" << "-ac" << "1" << "-ar" << "8000" << tempAudioPath;
-
-    connect(ffmpeg, &QProcess::finished, this, [this, tempAudioPath, ffmpeg]() {
-        QFile file(tempAudioPath);
-        if (file.open(QIODevice::ReadOnly)) {
-            QByteArray data = file.readAll();
-            file.close();
-            QFile::remove(tempAudioPath);
-            const auto *samples = reinterpret_cast<const int16_t*>(data.constData());
-            int count = data.size() / sizeof(int16_t);
-            audioSamples.clear();
-            float localMax = 0.01f;
-            for (int i = 0; i < count; i += 80) {
-                double sum = 0;
-                int actualWindow = qMin(80, count - i);
-                for (int j = 0; j < actualWindow; ++j) {
-                    double val = samples[i + j] / 32768.0;
-                    sum += val * val;
-                }
-                float rms = std::sqrt(sum / actualWindow);
-                rms = std::pow(rms, 0.6f);
-                audioSamples.push_back(rms);
-                if (rms > localMax) localMax = rms;
-            }
-            maxAmplitude = localMax;
-        }
-        update();
-        emit mediaProbingFinished();
-        ffmpeg->deleteLater();
-    });
+// Waveform for a source appended to the end of the timeline (its first
+// audio track, the one the export uses).
+void TimelineWidget::appendAudioWaveform(const QString &inputPath) {
+    requestWaveform(inputPath, 0, /*announceProbing=*/false);
+}
 
-    ffmpeg->start(getFFToolPath("ffmpeg"), args);
+const WaveformPyramid *TimelineWidget::sourceWaveform(int sourceIdx) const {
+    if (sourceIdx < 0 || sourceIdx >= model->sources().size()) return nullptr;
+    const bool srcHasAudio = sourceIdx == 0 ? hasAudioStream : model->sources()[sourceIdx].hasAudio;
+    if (!srcHasAudio) return nullptr;
+    const auto it = waveforms.constFind(waveformKey(model->sources()[sourceIdx].path, sourceIdx == 0 ? currentAudioTrack : 0));
+    return it == waveforms.constEnd() ? nullptr : it->data();
 }
 
-// Waveform for a source appended to the end of the timeline. Samples are
-// produced at the same fixed density as loadAudioFast (8000 Hz / 80-sample
-// windows = 100 samples per second), so appending keeps the index→time
-// mapping of the combined array valid.
-void TimelineWidget::appendAudioWaveform(const QString &inputPath) {
-    QString tempAudioPath = QDir::tempPath() + QString("/potato_wave_%1.raw").arg(qAbs(qHash(inputPath)));
-    auto *ffmpeg = new QProcess(this);
-    QStringList args;
-    args << "-y" << "-i" << inputPath
-         << "-map" << "0:a:0"
-         << "-f" << "s16le" << "-ac" << "1" << "-ar" << "8000" << tempAudioPath;
-
-    connect(ffmpeg, &QProcess::finished, this, [this, tempAudioPath, ffmpeg]() {
-        QFile file(tempAudioPath);
-        if (file.open(QIODevice::ReadOnly)) {
-            QByteArray data = file.readAll();
-            file.close();
-            QFile::remove(tempAudioPath);
-            const auto *samples = reinterpret_cast<const int16_t*>(data.constData());
-            int count = data.size() / sizeof(int16_t);
-            float localMax = maxAmplitude;
-            for (int i = 0; i < count; i += 80) {
-                double sum = 0;
-                int actualWindow = qMin(80, count - i);
-                for (int j = 0; j < actualWindow; ++j) {
-                    double val = samples[i + j] / 32768.0;
-                    sum += val * val;
+void TimelineWidget::refreshWaveformPeak() {
+    waveformPeak = 0.0f;
+    for (int i = 0; i < sources.size(); ++i)
+        if (const WaveformPyramid *wave = sourceWaveform(i)) waveformPeak = qMax(waveformPeak, wave->peak());
+}
+
+// Decodes one audio track to 8 kHz mono and builds its pyramid on the
+// analysis pool. ffmpeg streams the PCM over a pipe, so memory stays at one
+// read chunk plus the pyramid, and a copy of the pyramid so far reaches the
+// timeline every kWaveformPublishMs while decoding goes on. A (file, track)
+// pair already built is reused as is, so cycling back to an audio track or
+// appending the same file again is free.
+void TimelineWidget::requestWaveform(const QString &path, int track, bool announceProbing) {
+    if (waveforms.contains(waveformKey(path, track))) {
+        refreshWaveformPeak();
+        invalidateScene();
+        if (announceProbing) emit mediaProbingFinished();
+        return;
+    }
+
+    const auto cancel = QSharedPointer<std::atomic_bool>::create(false);
+    QPointer<TimelineWidget> self(this);
+    (void)WorkerPools::run(WorkerPools::Analysis, [self, path, track, announceProbing, cancel]() {
+        // Hands a pyramid (null: nothing decoded) to the timeline. Once the
+        // timeline has moved on to other media, the decode is stopped instead.
+        auto publish = [self, path, track, announceProbing, cancel](QSharedPointer<const WaveformPyramid> pyramid,
+                                                                    bool first) {
+            QMetaObject::invokeMethod(self, [self, path, track, announceProbing, cancel, pyramid, first]() {
+                if (!self) return;
+                const bool wanted = std::any_of(self->sources.cbegin(), self->sources.cend(),
+                                                [&path](const SourceClip &src) { return src.path == path; });
+                if (!wanted) {
+                    cancel->store(true);
+                    return;
+                }
+                if (pyramid) {
+                    self->waveforms.insert(waveformKey(path, track), pyramid);
+                    self->refreshWaveformPeak();
+                    self->invalidateScene();
+                }
+                if (announceProbing && first) emit self->mediaProbingFinished();
+            }, Qt::QueuedConnection);
+        };
+
+        WaveformPyramid pyramid;
+        QProcess ffmpeg;
+        ffmpeg.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        ffmpeg.start(getFFToolPath("ffmpeg"), {
+            "-hide_banner", "-nostats", "-loglevel", "error",
+            "-i", path, "-map", QString("0:a:%1").arg(track), "-vn", "-sn", "-dn",
+            "-f", "s16le", "-ac", "1", "-ar", QString::number(WaveformPyramid::kSampleRate), "-"
+        });
+        bool first = true;
+        if (ffmpeg.waitForStarted(5000)) {
+            QByteArray pending;
+            QElapsedTimer sincePublish;
+            sincePublish.start();
+            while (!cancel->load()) {
+                const bool ready = ffmpeg.bytesAvailable() > 0 || ffmpeg.waitForReadyRead(100);
+                pending += ffmpeg.read(kWaveformChunkBytes);
+                const qsizetype whole = pending.size() / qsizetype(sizeof(qint16));
+                if (whole > 0) {
+                    pyramid.append(reinterpret_cast<const qint16 *>(pending.constData()), whole);
+                    pending.remove(0, whole * qsizetype(sizeof(qint16)));
+                }
+                if (!ready && ffmpeg.bytesAvailable() == 0 && ffmpeg.state() == QProcess::NotRunning) break;
+                if (sincePublish.elapsed() >= kWaveformPublishMs && !pyramid.isEmpty()) {
+                    // Shares the level blocks; the next append() copies
+                    // only the last block of each level it touches.
+                    publish(QSharedPointer<const WaveformPyramid>::create(pyramid), first);
+                    first = false;
+                    sincePublish.restart();
                 }
-                float rms = std::sqrt(sum / actualWindow);
-                rms = std::pow(rms, 0.6f);
-                audioSamples.push_back(rms);
-                if (rms > localMax) localMax = rms;
             }
-            maxAmplitude = localMax;
+            if (cancel->load()) {
+                ffmpeg.kill();
+                ffmpeg.waitForFinished(2000);
+                return;
+            }
         }
-        update();
-        ffmpeg->deleteLater();
+        pyramid.finish();
+        // No such track, or ffmpeg failed before any PCM: no lane to draw,
+        // but a load waiting on the probe still hears back.
+        publish(pyramid.isEmpty() ? QSharedPointer<const WaveformPyramid>()
+                                  : QSharedPointer<const WaveformPyramid>::create(std::move(pyramid)), first);
     });
-
-    ffmpeg->start(getFFToolPath("ffmpeg"), args);
 }
 
 void TimelineWidget::autoCutSilence() {
@@ -124,7 +154,7 @@ void TimelineWidget::autoCutSilence() {
     QSet<int> audioSources;
     for (const auto &seg : workArea) {
         const int si = qBound(0, seg.sourceIdx, static_cast<int>(sources.size()) - 1);
-        const bool srcHasAudio = (si == 0) ? hasAudioStream : sources[si].hasAudio;
+        const bool srcHasAudio = (si == 0) ? hasAudioStream : model->sources()[si].hasAudio;
         if (srcHasAudio) audioSources.insert(si);
     }
     if (audioSources.isEmpty()) {
@@ -153,7 +183,7 @@ void TimelineWidget::autoCutSilence() {
             }
             const QList<double> &silenceStarts = state->silence[si].first;
             const QList<double> &silenceEnds = state->silence[si].second;
-            const qint64 offset = sources[si].offsetMs;
+            const qint64 offset = model->sources()[si].offsetMs;
             const double areaStart = (area.startMs - offset) / 1000.0; // source-local
             const double areaEnd = (area.endMs - offset) / 1000.0;
             double lastProcessed = areaStart;
@@ -184,7 +214,7 @@ void TimelineWidget::autoCutSilence() {
         if (!anySilence) {
             showNotification("NO SILENCE FOUND IN TRIMMED AREA");
         } else if (!newSegments.isEmpty()) {
-            segments = newSegments;
+            model->setSegments(newSegments);
             showNotification(QString("CLEANED: %1 CLIPS").arg(segments.size()));
             emit clipTrimmed();
         }
@@ -196,8 +226,8 @@ void TimelineWidget::autoCutSilence() {
         QStringList filterParts;
         for (const auto &seg : workArea) {
             if (qBound(0, seg.sourceIdx, static_cast<int>(sources.size()) - 1) != si) continue;
-            const double s = (seg.startMs - sources[si].offsetMs) / 1000.0;
-            const double e = (seg.endMs - sources[si].offsetMs) / 1000.0;
+            const double s = (seg.startMs - model->sources()[si].offsetMs) / 1000.0;
+            const double e = (seg.endMs - model->sources()[si].offsetMs) / 1000.0;
             filterParts << QString("between(t,%1,%2)").arg(s).arg(e);
         }
 
@@ -207,7 +237,7 @@ void TimelineWidget::autoCutSilence() {
                                          .arg(settings.minimumSilenceDurationSec, 0, 'f', 2);
 
         QStringList args;
-        args << "-i" << sources[si].path
+        args << "-i" << model->sources()[si].path
              << "-map" << QString("0:a:%1").arg(si == 0 ? currentAudioTrack : 0)
              << "-af" << selectFilter
              << "-f" << "null" << "-";
@@ -243,6 +273,8 @@ void TimelineWidget::detectAudioTracks(const QString &path) {
             showNotification("TRACK DETECTION FAILED ❌");
             hasAudioStream = false;
             hasVideoStream = false;
+            renderRangesDirty = true;
+            invalidateScene();
             probe->deleteLater();
             emit mediaProbingFinished();
             return;
@@ -271,6 +303,7 @@ void TimelineWidget::detectAudioTracks(const QString &path) {
         totalAudioTracks = qMax(1, audioCount);
         hasAudioStream = audioCount > 0;
         hasVideoStream = hasVideo;
+        renderRangesDirty = true;
         
         // Safety: If currentAudioTrack is out of bounds for the new file, reset it
         if (currentAudioTrack >= totalAudioTracks) {
@@ -280,8 +313,7 @@ void TimelineWidget::detectAudioTracks(const QString &path) {
         if (hasAudioStream) {
             loadAudioFast(path);
         } else {
-            audioSamples.clear();
-            update();
+            invalidateScene();
             emit mediaProbingFinished();
         }
         
@@ -298,20 +330,6 @@ void TimelineWidget::detectAudioTracks(const QString &path) {
 bool TimelineWidget::isAnySelectedMuted() {
     QSet<int> targets = selectedSegmentIndices;
     if (selectedSegmentIdx != -1) targets.insert(selectedSegmentIdx);
-    for (int idx : targets) if (segments[idx].muted) return true;
+    for (int idx : targets) if (model->segments()[idx].muted) return true;
     return false;
 }
-
-void TimelineWidget::updateEditorVolume() {
-    if (!thumbPlayer || !thumbPlayer->audioOutput()) return; // Added safety check
-
-    float currentClipGain = 1.0f;
-    for (const auto& seg : segments) {
-        if (currentPosMs >= seg.startMs && currentPosMs <= seg.endMs) {
-            currentClipGain = seg.gain;
-            if (seg.muted) currentClipGain = 0.0f;
-            break;
-        }
-    }
-    thumbPlayer->audioOutput()->setVolume(qBound(0.0f, audioGain * currentClipGain, 5.0f));
-}
@@ -13,6 +13,7 @@
 #include <QPainter>
 #include <functional>
 #include <cmath>
+#include <algorithm>
 
 #include "../Includes/timelinewidget.h"
 #include "../Includes/mediaSource.h"
@@ -51,9 +52,107 @@ static QString escapeDrawtext(QString text) {
     return text;
 }
 
+// Pixel position of a motion-tracked region along one axis as an ffmpeg
+// expression in segment-local seconds: the first keyframe's value plus one
+// clipped linear ramp per keyframe pair, which is exactly the preview's
+// piecewise-linear interpolation (held before the first key and after the
+// last). Only the keys around [isectStart, isectEnd] are emitted. Snapped to
+// even pixels and kept inside the frame, as the static path does.
+static QString keyframeExpr(const QVector<TimelineWidget::RegionKeyframe> &keys, bool xAxis, int frameSize,
+                            int regionSize, qint64 segStartMs, qint64 isectStart, qint64 isectEnd) {
+    auto value = [&](const TimelineWidget::RegionKeyframe &k) { return (xAxis ? k.l : k.t) * double(frameSize); };
+    auto byTime = [](const TimelineWidget::RegionKeyframe &k, qint64 ms) { return k.timeMs < ms; };
+    int first = int(std::lower_bound(keys.cbegin(), keys.cend(), isectStart, byTime) - keys.cbegin());
+    int last = int(std::lower_bound(keys.cbegin(), keys.cend(), isectEnd, byTime) - keys.cbegin());
+    first = qMax(0, first - 1);
+    last = qMin(int(keys.size()) - 1, last);
+
+    QString expr = QString::number(value(keys[first]), 'f', 2);
+    for (int i = first; i < last; ++i) {
+        const double dv = value(keys[i + 1]) - value(keys[i]);
+        if (std::abs(dv) < 0.01) continue;
+        const double t0 = (keys[i].timeMs - segStartMs) / 1000.0;
+        const double dt = qMax<qint64>(1, keys[i + 1].timeMs - keys[i].timeMs) / 1000.0;
+        expr += QString("+(%1)*clip((t-(%2))/%3,0,1)").arg(dv, 0, 'f', 2).arg(t0, 0, 'f', 3).arg(dt, 0, 'f', 3);
+    }
+    return QString("2*trunc(clip(%1,0,%2)/2)").arg(expr).arg(qMax(0, frameSize - regionSize));
+}
+
+namespace {
+// The image/logo overlays of one ffmpeg run. Each file is one extra input
+// after the sources, decoded once; each distinct box size + opacity is scaled
+// from it once and split to every segment that shows it. An image input is a
+// single frame that overlay holds (its eof_action=repeat) for the whole
+// segment, so the split branches waiting on later segments each queue one
+// frame rather than a looped stream.
+class OverlayImageInputs {
+public:
+    OverlayImageInputs(int firstInput, QString prefix) : firstInput(firstInput), prefix(std::move(prefix)) {}
+
+    // The label of a fresh copy of `path` at w x h and `opacity`, for one
+    // overlay filter to consume.
+    QString take(const QString &path, int w, int h, float opacity) {
+        int pathIdx = paths.indexOf(path);
+        if (pathIdx < 0) {
+            pathIdx = int(paths.size());
+            paths.append(path);
+        }
+        const int alpha = qRound(qBound(0.0f, opacity, 1.0f) * 100);
+        int v = 0;
+        while (v < variants.size() && !(variants[v].pathIdx == pathIdx && variants[v].w == w
+                                         && variants[v].h == h && variants[v].alpha == alpha)) ++v;
+        if (v == variants.size()) variants.append({pathIdx, w, h, alpha, 0});
+        return QString("[%1_img%2_%3]").arg(prefix).arg(v).arg(variants[v].uses++);
+    }
+
+    // "-i" arguments for the images, to follow the sources' inputs.
+    QStringList inputArgs() const {
+        QStringList args;
+        for (const QString &path : paths) args << "-i" << QDir::toNativeSeparators(path);
+        return args;
+    }
+
+    // Graph prefix feeding every label take() handed out.
+    QString prelude() const {
+        QString graph;
+        for (int p = 0; p < paths.size(); ++p) {
+            QStringList outs;
+            for (int v = 0; v < variants.size(); ++v)
+                if (variants[v].pathIdx == p) outs << QString("[%1_imgsrc%2]").arg(prefix).arg(v);
+            graph += QString("[%1:v]").arg(firstInput + p)
+                   + (outs.size() == 1 ? QString("null") : QString("split=%1").arg(outs.size())) + outs.join("") + ";";
+        }
+        for (int v = 0; v < variants.size(); ++v) {
+            const Variant &var = variants[v];
+            graph += QString("[%1_imgsrc%2]scale=%3:%4,format=rgba").arg(prefix).arg(v).arg(var.w).arg(var.h);
+            if (var.alpha < 100) graph += QString(",colorchannelmixer=aa=%1").arg(var.alpha / 100.0, 0, 'f', 2);
+            if (var.uses > 1) graph += QString(",split=%1").arg(var.uses);
+            for (int u = 0; u < var.uses; ++u) graph += QString("[%1_img%2_%3]").arg(prefix).arg(v).arg(u);
+            graph += ";";
+        }
+        return graph;
+    }
+
+private:
+    struct Variant {
+        int pathIdx;
+        int w, h;
+        int alpha; // percent
+        int uses;
+    };
+    int firstInput;
+    QString prefix;
+    QStringList paths;
+    QList<Variant> variants;
+};
+}
+
 // Builds the effect chain for one timeline segment. Every overlay clip that
 // intersects the segment is applied with enable='between(t,a,b)' so it only
 // shows for its own time range (t is segment-local after trim+setpts).
+// Motion-tracked clips get their position as a per-frame expression
+// (keyframeExpr) wherever the filter evaluates one. Image overlays draw their
+// inputs from `images`.
 static QString buildOverlayChain(const QString &inputLabel,
                                  const QString &outputLabel,
                                  const QString &prefix,
@@ -61,7 +160,8 @@ static QString buildOverlayChain(const QString &inputLabel,
                                  int vidH,
                                  qint64 segStartMs,
                                  qint64 segEndMs,
-                                 const QList<TimelineWidget::OverlayClip> &overlays) {
+                                 const QList<TimelineWidget::OverlayClip> &overlays,
+                                 OverlayImageInputs &images) {
     QString chain;
     QString lastOutput = inputLabel;
     int step = 0;
@@ -82,16 +182,50 @@ static QString buildOverlayChain(const QString &inputLabel,
         const int absW = qRound(vidW * (ov.r - ov.l)) & ~1;
         const int absH = qRound(vidH * (ov.b - ov.t)) & ~1;
         if (ov.type != 3 && (absW <= 0 || absH <= 0)) continue;
+        if (ov.type == 6 && ov.imagePath.isEmpty()) continue;
 
         const QString cur = QString("[%1_s%2]").arg(prefix).arg(step);
 
-        if (ov.type == 0 || ov.type == 1) {
+        if (!ov.keyframes.isEmpty() && ov.type != 3 && ov.type != 4 && ov.type != 6) {
+            // Tracked region: the crop window and the paste-back follow the
+            // track. drawbox only evaluates its position once, so a tracked
+            // blackout is a filled crop pasted back the same way.
+            const QString xExpr = keyframeExpr(ov.keyframes, true, vidW, absW, segStartMs, isectStart, isectEnd);
+            const QString yExpr = keyframeExpr(ov.keyframes, false, vidH, absH, segStartMs, isectStart, isectEnd);
             const QString base = QString("[%1_b%2]").arg(prefix).arg(step);
             const QString mask = QString("[%1_m%2]").arg(prefix).arg(step);
             const QString fx = QString("[%1_f%2]").arg(prefix).arg(step);
+            const int lumaRadius = qMin(PreviewEffects::kBlurRadius, qMin(absW, absH) / 2);
+            const int chromaRadius = qMin(lumaRadius, qMin(absW, absH) / 4);
+            QString effect;
+            if (ov.type == 0) {
+                effect = QString("boxblur=lr=%1:lp=%3:cr=%2:cp=%3").arg(lumaRadius).arg(chromaRadius)
+                             .arg(PreviewEffects::kBlurPower);
+            } else if (ov.type == 1) {
+                effect = QString("scale=iw/%3:-1,scale=%1:%2:flags=neighbor").arg(absW).arg(absH)
+                             .arg(PreviewEffects::kPixelateBlock);
+            } else if (ov.type == 2) {
+                effect = "drawbox=x=0:y=0:w=iw:h=ih:color=black:t=fill";
+            } else {
+                effect = QString("eq=brightness=%1:contrast=%2:saturation=%3")
+                             .arg(ov.brightness, 0, 'f', 3).arg(ov.contrast, 0, 'f', 3).arg(ov.saturation, 0, 'f', 3);
+            }
+            chain += lastOutput + "split=2" + base + mask + ";"
+                   + mask + QString("crop=w=%1:h=%2:x='%3':y='%4',").arg(absW).arg(absH).arg(xExpr, yExpr) + effect + fx + ";"
+                   + base + fx + QString("overlay=x='%1':y='%2':").arg(xExpr, yExpr) + enable + cur + ";";
+        } else if (ov.type == 0 || ov.type == 1) {
+            const QString base = QString("[%1_b%2]").arg(prefix).arg(step);
+            const QString mask = QString("[%1_m%2]").arg(prefix).arg(step);
+            const QString fx = QString("[%1_f%2]").arg(prefix).arg(step);
+            // Radii are clamped to what boxblur accepts for this crop (chroma planes
+            // are half size), so small regions no longer fail the whole export.
+            const int lumaRadius = qMin(PreviewEffects::kBlurRadius, qMin(absW, absH) / 2);
+            const int chromaRadius = qMin(lumaRadius, qMin(absW, absH) / 4);
             const QString effect = ov.type == 0
-                ? QString("boxblur=20")
-                : QString("scale=iw/30:-1,scale=%1:%2:flags=neighbor").arg(absW).arg(absH);
+                ? QString("boxblur=lr=%1:lp=%3:cr=%2:cp=%3").arg(lumaRadius).arg(chromaRadius)
+                      .arg(PreviewEffects::kBlurPower)
+                : QString("scale=iw/%3:-1,scale=%1:%2:flags=neighbor").arg(absW).arg(absH)
+                      .arg(PreviewEffects::kPixelateBlock);
             chain += lastOutput + "split=2" + base + mask + ";"
                    + mask + QString("crop=%1:%2:%3:%4,").arg(absW).arg(absH).arg(absX).arg(absY) + effect + fx + ";"
                    + base + fx + QString("overlay=%1:%2:").arg(absX).arg(absY) + enable + cur + ";";
@@ -125,18 +259,35 @@ static QString buildOverlayChain(const QString &inputLabel,
 
             const QString shapeSrc = QString("[%1_shp%2]").arg(prefix).arg(step);
             chain += QString("movie='%1'").arg(moviePath) + shapeSrc + ";";
-            chain += lastOutput + shapeSrc + "overlay=0:0:" + enable + cur + ";";
+            // The PNG is baked at the static region; a track slides it.
+            const QString position = ov.keyframes.isEmpty()
+                ? QString("0:0")
+                : QString("x='%1-%2':y='%3-%4'")
+                      .arg(keyframeExpr(ov.keyframes, true, vidW, absW, segStartMs, isectStart, isectEnd)).arg(absX)
+                      .arg(keyframeExpr(ov.keyframes, false, vidH, absH, segStartMs, isectStart, isectEnd)).arg(absY);
+            chain += lastOutput + shapeSrc + "overlay=" + position + ":" + enable + cur + ";";
+        } else if (ov.type == 6) { // image/logo: pre-scaled once in the prelude, one overlay here
+            const QString position = ov.keyframes.isEmpty()
+                ? QString("%1:%2").arg(absX).arg(absY)
+                : QString("x='%1':y='%2'")
+                      .arg(keyframeExpr(ov.keyframes, true, vidW, absW, segStartMs, isectStart, isectEnd))
+                      .arg(keyframeExpr(ov.keyframes, false, vidH, absH, segStartMs, isectStart, isectEnd));
+            chain += lastOutput + images.take(ov.imagePath, absW, absH, ov.opacity)
+                   + "overlay=" + position + ":" + enable + cur + ";";
         } else { // text
             const int fontSize = qMax(14, qRound(vidH * (ov.b - ov.t) * 0.6));
             const double cx = (ov.l + ov.r) / 2.0;
             const double cy = (ov.t + ov.b) / 2.0;
-            QString dt = QString("drawtext=text='%1':fontsize=%2:fontcolor=white:borderw=%3:bordercolor=black@0.65:"
-                                 "x=%4*w-text_w/2:y=%5*h-text_h/2:")
+            const QString position = ov.keyframes.isEmpty()
+                ? QString("x=%1*w-text_w/2:y=%2*h-text_h/2").arg(cx, 0, 'f', 4).arg(cy, 0, 'f', 4)
+                : QString("x='%1+%2-text_w/2':y='%3+%4-text_h/2'")
+                      .arg(keyframeExpr(ov.keyframes, true, vidW, absW, segStartMs, isectStart, isectEnd)).arg(absW / 2)
+                      .arg(keyframeExpr(ov.keyframes, false, vidH, absH, segStartMs, isectStart, isectEnd)).arg(absH / 2);
+            QString dt = QString("drawtext=text='%1':fontsize=%2:fontcolor=white:borderw=%3:bordercolor=black@0.65:%4:")
                              .arg(escapeDrawtext(ov.text))
                              .arg(fontSize)
                              .arg(qMax(1, fontSize / 18))
-                             .arg(cx, 0, 'f', 4)
-                             .arg(cy, 0, 'f', 4);
+                             .arg(position);
 #ifdef Q_OS_WIN
             dt += "fontfile='C\\:/Windows/Fonts/arial.ttf':";
 #endif
@@ -168,13 +319,6 @@ static QString buildSpeedSetptsExpr(double speedStart, double speedEnd, double d
         .arg(k, 0, 'f', 6);
 }
 
-// Matches buildSpeedSetptsExpr's math so the silence-fill branch (no source
-// audio) can produce exactly as much silence as the retimed video needs.
-static double retimedDurationSec(double durationSec, double speedStart, double speedEnd) {
-    if (qFuzzyCompare(speedStart, speedEnd)) return durationSec / speedStart;
-    return (durationSec / (speedEnd - speedStart)) * std::log(speedEnd / speedStart);
-}
-
 // A single atempo stage only accepts 0.5..2.0, so extreme speeds are chained.
 static QString chainedAtempo(double speed) {
     QStringList stages;
@@ -222,7 +366,8 @@ QString buildSegmentsGraph(const QList<TimelineWidget::Segment> &segments,
                            bool primaryHasAudio,
                            int primaryAudioTrack,
                            double seekStart,
-                           const QString &prefix) {
+                           const QString &prefix,
+                           OverlayImageInputs &images) {
     QString filter;
     for (int i = 0; i < segments.size(); ++i) {
         const auto &seg = segments[i];
@@ -231,7 +376,7 @@ QString buildSegmentsGraph(const QList<TimelineWidget::Segment> &segments,
         const double sLocal = qMax(0.0, (seg.startMs - src.offsetMs) / 1000.0 - (srcIdx == 0 ? seekStart : 0.0));
         const double d = (seg.endMs - seg.startMs) / 1000.0;
         const bool hasSpeedChange = !(qFuzzyCompare(seg.speedStart, 1.0f) && qFuzzyCompare(seg.speedEnd, 1.0f));
-        const double dOut = hasSpeedChange ? retimedDurationSec(d, seg.speedStart, seg.speedEnd) : d;
+        const double dOut = hasSpeedChange ? SegmentIndex::retimedSec(d, d, seg.speedStart, seg.speedEnd) : d;
 
         filter += QString("[%1:v]trim=start=%2:duration=%3,setpts=PTS-STARTPTS[%4_seg%5];")
                       .arg(srcIdx).arg(sLocal).arg(d).arg(prefix).arg(i);
@@ -243,7 +388,7 @@ QString buildSegmentsGraph(const QList<TimelineWidget::Segment> &segments,
                                     QString("%1%2").arg(prefix).arg(i),
                                     vidW, vidH,
                                     seg.startMs, seg.endMs,
-                                    overlays);
+                                    overlays, images);
         QString videoLabel = QString("[%1_v%2]").arg(prefix).arg(i);
         if (hasSpeedChange) {
             const QString spedLabel = QString("[%1_sp%2]").arg(prefix).arg(i);
@@ -296,7 +441,34 @@ QString buildSegmentsGraph(const QList<TimelineWidget::Segment> &segments,
     }
     filter += QString("concat=n=%1:v=1:a=%2[outv]").arg(segments.size()).arg(withAudio ? 1 : 0);
     if (withAudio) filter += "[outa]";
-    return filter;
+    return images.prelude() + filter;
+}
+
+// One render-cache clip: the range's source stretch with its overlays baked
+// in by the same chain the export uses (at export geometry, so blur radii and
+// mosaic cells match), then scaled down to preview size. Video only, short
+// GOP so the preview player seeks into it cheaply.
+QStringList TimelineWidget::renderCacheArguments(const RenderRange &range, const QString &outputPath) const {
+    const ExportGeometry geo = resolveExportGeometry(this);
+    const auto &src = model->sources()[range.sourceIdx];
+    const double localStart = qMax(0.0, (range.startMs - src.offsetMs) / 1000.0);
+    const double duration = (range.endMs - range.startMs) / 1000.0;
+    const int renderW = qMin(geo.vidW, renderCacheMaxWidth) & ~1;
+
+    QString filter = QString("[0:v]scale=%1:%2,setsar=1,setpts=PTS-STARTPTS[rc_in];").arg(geo.vidW).arg(geo.vidH);
+    OverlayImageInputs images(1, "rc");
+    filter += buildOverlayChain("[rc_in]", "[rc_fx]", "rc", geo.vidW, geo.vidH, range.startMs, range.endMs, model->overlays(),
+                                images);
+    filter += QString("[rc_fx]scale=%1:-2,format=yuv420p[outv]").arg(renderW);
+
+    QStringList args = {"-y", "-hide_banner", "-loglevel", "error",
+                        "-ss", QString::number(localStart, 'f', 3), "-i", src.path};
+    args << images.inputArgs();
+    args << "-t" << QString::number(duration, 'f', 3)
+         << "-filter_complex" << images.prelude() + filter << "-map" << "[outv]" << "-an"
+         << "-c:v" << "libx264" << "-preset" << "ultrafast" << "-crf" << "18" << "-g" << "12"
+         << "-movflags" << "+faststart" << outputPath;
+    return args;
 }
 
 void TimelineWidget::copyTrimmedVideo() {
@@ -317,18 +489,21 @@ void TimelineWidget::copyTrimmedVideo() {
     const QString outputDir = getExportDir();
     QString finalPath = QDir::toNativeSeparators(outputDir + "/" + generateClippedName("mp4"));
 
-    qint64 totalMs = 0;
-    for (const auto& seg : segments) totalMs += (seg.endMs - seg.startMs);
+    // Output length, speed ramps applied: what ffmpeg's progress counts and
+    // what the bitrate budget is spread over.
+    const qint64 totalMs = outputDurationMs();
     const double durationSec = qMax(0.1, totalMs / 1000.0);
     const auto exportSettings = this->exportSettings;
 
     isExporting = true;
     const bool multiSource = sources.size() > 1;
-    const double seekStart = multiSource ? 0.0 : qMax(0.0, (segments[0].startMs / 1000.0) - 0.5);
+    const double seekStart = multiSource ? 0.0 : qMax(0.0, (model->segments()[0].startMs / 1000.0) - 0.5);
 
+    OverlayImageInputs images(int(sources.size()), "s");
     const QString filter = buildSegmentsGraph(segments, sources, overlays, vidW, vidH,
                                               /*withAudio=*/true, hasAudioStream, currentAudioTrack,
-                                              seekStart, "s");
+                                              seekStart, "s", images);
+    const QStringList imageInputs = images.inputArgs();
 
     double originalBitrateKbps = (originalFileSize * 8.0) / (qMax<qint64>(1, durationMs) / 1000.0) / 1000.0;
     double estimatedSizeMB = (originalBitrateKbps * durationSec) / 8192.0;
@@ -344,7 +519,8 @@ void TimelineWidget::copyTrimmedVideo() {
         QStringList a;
         a << "-y";
         if (!multiSource && seekStart > 0.0) a << "-ss" << QString::number(seekStart);
-        for (const auto &src : sources) a << "-i" << QDir::toNativeSeparators(src.path);
+        for (const auto &src : model->sources()) a << "-i" << QDir::toNativeSeparators(src.path);
+        a << imageInputs;
         a << "-filter_complex" << filter;
         a << "-map" << "[outv]" << "-map" << "[outa]";
 
@@ -448,14 +624,16 @@ void TimelineWidget::copyTrimmedVideoMuted() {
     QString outputDir = getExportDir();
     QString finalPath = outputDir + "/MUTED_" + generateClippedName("mp4");
 
-    qint64 totalMs = 0;
-    for (const auto& seg : segments) totalMs += (seg.endMs - seg.startMs);
-    const double durationSec = qMax(0.1, totalMs / 1000.0);
+    // Source time for the size estimate, output time for the bitrate budget
+    // and ffmpeg's progress.
+    const qint64 totalMs = ensureSegmentIndex().sourceDurationMs();
+    const qint64 outputMs = outputDurationMs();
+    const double durationSec = qMax(0.1, outputMs / 1000.0);
     const auto exportSettings = this->exportSettings;
 
     const double timeRatio = static_cast<double>(totalMs) / static_cast<double>(qMax<qint64>(1, durationMs));
     double weightedSpatialRatio = 0.0;
-    for (const auto &seg : segments) {
+    for (const auto &seg : model->segments()) {
         const double segDuration = qMax<qint64>(1, seg.endMs - seg.startMs);
         weightedSpatialRatio += segDuration * ((seg.cropRight - seg.cropLeft) * (seg.cropBottom - seg.cropTop));
     }
@@ -464,11 +642,13 @@ void TimelineWidget::copyTrimmedVideoMuted() {
 
     isExporting = true;
     const bool multiSource = sources.size() > 1;
-    const double seekStart = multiSource ? 0.0 : qMax(0.0, (segments[0].startMs / 1000.0) - 0.5);
+    const double seekStart = multiSource ? 0.0 : qMax(0.0, (model->segments()[0].startMs / 1000.0) - 0.5);
 
+    OverlayImageInputs images(int(sources.size()), "m");
     const QString filter = buildSegmentsGraph(segments, sources, overlays, vidW, vidH,
                                               /*withAudio=*/false, hasAudioStream, currentAudioTrack,
-                                              seekStart, "m");
+                                              seekStart, "m", images);
+    const QStringList imageInputs = images.inputArgs();
 
     const bool nv = hasNvidiaEncoder();
     const bool shouldCompress = estMb > exportSettings.videoCompressionThresholdMB;
@@ -478,7 +658,8 @@ void TimelineWidget::copyTrimmedVideoMuted() {
         QStringList a;
         a << "-y";
         if (!multiSource && seekStart > 0.0) a << "-ss" << QString::number(seekStart);
-        for (const auto &src : sources) a << "-i" << QDir::toNativeSeparators(src.path);
+        for (const auto &src : model->sources()) a << "-i" << QDir::toNativeSeparators(src.path);
+        a << imageInputs;
         a << "-filter_complex" << filter
           << "-map" << "[outv]"
           << "-an";
@@ -512,9 +693,9 @@ void TimelineWidget::copyTrimmedVideoMuted() {
 
     const int maxAttempts = 3;
     auto runAttempt = QSharedPointer<std::function<void(double, int)>>::create();
-    *runAttempt = [this, runAttempt, buildArgs, finalPath, shouldCompress, targetMB, maxAttempts, totalMs](double videoBitrateKbps, int attempt) {
+    *runAttempt = [this, runAttempt, buildArgs, finalPath, shouldCompress, targetMB, maxAttempts, outputMs](double videoBitrateKbps, int attempt) {
         auto *ffmpeg = new QProcess(this);
-        showProgressNotification(ffmpeg, totalMs);
+        showProgressNotification(ffmpeg, outputMs);
 
         connect(ffmpeg, &QProcess::finished, this,
                 [this, finalPath, ffmpeg, shouldCompress, targetMB, maxAttempts, videoBitrateKbps, attempt, runAttempt](int exitCode) {
@@ -565,20 +746,21 @@ void TimelineWidget::copyTrimmedGif() {
     QString finalPath = outputDir + "/" + generateClippedName("gif");
     const auto exportSettings = this->exportSettings;
 
-    qint64 totalMs = 0;
-    for (const auto &seg : segments) totalMs += (seg.endMs - seg.startMs);
+    const qint64 totalMs = outputDurationMs();
 
     // The whole composition (every segment, every source, overlays with their
     // time ranges) goes into the GIF — same graph as the video exports.
+    OverlayImageInputs images(int(sources.size()), "g");
     QString filter = buildSegmentsGraph(segments, sources, overlays, vidW, vidH,
                                         /*withAudio=*/false, hasAudioStream, currentAudioTrack,
-                                        /*seekStart=*/0.0, "g");
+                                        /*seekStart=*/0.0, "g", images);
     filter += QString(";[outv]fps=%1,scale=%2:-1:flags=lanczos,split[s0][s1];[s0]palettegen[p];[s1][p]paletteuse[gif]")
                   .arg(exportSettings.gifFps).arg(exportSettings.gifWidth);
 
     QStringList args;
     args << "-y";
-    for (const auto &src : sources) args << "-i" << QDir::toNativeSeparators(src.path);
+    for (const auto &src : model->sources()) args << "-i" << QDir::toNativeSeparators(src.path);
+    args << images.inputArgs();
     args << "-filter_complex" << filter << "-map" << "[gif]" << "-threads" << "0"
          << "-progress" << "pipe:1"
          << QDir::toNativeSeparators(finalPath);
@@ -612,18 +794,18 @@ void TimelineWidget::copyTrimmedAudio() {
     QString finalPath = outputDir + "/" + generateClippedName("mp3");
     const auto exportSettings = this->exportSettings;
 
-    qint64 totalMs = 0;
-    for (const auto& seg : segments) totalMs += (seg.endMs - seg.startMs);
+    // The audio export doesn't retime, so its length is the source time.
+    const qint64 totalMs = ensureSegmentIndex().sourceDurationMs();
 
     isExporting = true;
     const bool multiSource = sources.size() > 1;
-    const double seekStart = multiSource ? 0.0 : qMax(0.0, (segments[0].startMs / 1000.0) - 0.5);
+    const double seekStart = multiSource ? 0.0 : qMax(0.0, (model->segments()[0].startMs / 1000.0) - 0.5);
 
     QString filter;
     for (int i = 0; i < segments.size(); ++i) {
-        const auto &seg = segments[i];
+        const auto &seg = model->segments()[i];
         const int srcIdx = qBound(0, seg.sourceIdx, static_cast<int>(sources.size()) - 1);
-        const auto &src = sources[srcIdx];
+        const auto &src = model->sources()[srcIdx];
         const double sLocal = qMax(0.0, (seg.startMs - src.offsetMs) / 1000.0 - (srcIdx == 0 ? seekStart : 0.0));
         const double d = (seg.endMs - seg.startMs) / 1000.0;
         const bool segHasAudio = (srcIdx == 0) ? hasAudioStream : src.hasAudio;
@@ -643,7 +825,7 @@ void TimelineWidget::copyTrimmedAudio() {
     QStringList args;
     args << "-y";
     if (!multiSource && seekStart > 0.0) args << "-ss" << QString::number(seekStart);
-    for (const auto &src : sources) args << "-i" << QDir::toNativeSeparators(src.path);
+    for (const auto &src : model->sources()) args << "-i" << QDir::toNativeSeparators(src.path);
     args << "-filter_complex" << filter
          << "-map" << "[outa]"
          << "-c:a" << "libmp3lame" << "-b:a" << QString("%1k").arg(exportSettings.audioBitrateKbps) << "-threads" << "0"
@@ -686,12 +868,8 @@ QString TimelineWidget::generateClippedName(const QString &extension) const {
 }
 
 double TimelineWidget::getTotalSegmentsDuration() {
-    qint64 totalMs = 0;
-    for (const auto& seg : segments) {
-        totalMs += (seg.endMs - seg.startMs);
-    }
-    return qMax(1.0, totalMs / 1000.0);
+    return qMax(1.0, ensureSegmentIndex().sourceDurationMs() / 1000.0);
 }
 
-qint64 TimelineWidget::getStartLimit() const { return segments.isEmpty() ? 0 : segments.first().startMs; }
-qint64 TimelineWidget::getEndLimit() const { return segments.isEmpty() ? durationMs : segments.last().endMs; }
+qint64 TimelineWidget::getStartLimit() const { return model->segments().isEmpty() ? 0 : model->segments().first().startMs; }
+qint64 TimelineWidget::getEndLimit() const { return model->segments().isEmpty() ? durationMs : model->segments().last().endMs; }
@@ -0,0 +1,227 @@
+#include "../Includes/frameScaler.h"
+
+#include <QVideoFrameFormat>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRAME_SCALER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// YCbCr -> RGB coefficients derived from the standard's Kr/Kb, with the
+// limited-range expansion folded in.
+struct YuvMatrix {
+    float yScale, yOffset;
+    float rv, gu, gv, bu;
+};
+
+YuvMatrix makeMatrix(bool bt709, bool fullRange) {
+    const float kr = bt709 ? 0.2126f : 0.299f;
+    const float kb = bt709 ? 0.0722f : 0.114f;
+    const float kg = 1.0f - kr - kb;
+    const float cScale = fullRange ? 1.0f : 255.0f / 224.0f;
+    YuvMatrix m;
+    m.yScale = fullRange ? 1.0f : 255.0f / 219.0f;
+    m.yOffset = fullRange ? 0.0f : 16.0f;
+    m.rv = 2.0f * (1.0f - kr) * cScale;
+    m.bu = 2.0f * (1.0f - kb) * cScale;
+    m.gu = -2.0f * (1.0f - kb) * kb / kg * cScale;
+    m.gv = -2.0f * (1.0f - kr) * kr / kg * cScale;
+    return m;
+}
+
+inline quint32 clampChannel(float v) {
+    return v <= 0.0f ? 0u : (v >= 255.0f ? 255u : static_cast<quint32>(v + 0.5f));
+}
+
+// `y` already range-expanded, `u`/`v` centered on 0.
+inline quint32 packRgb(const YuvMatrix &m, float y, float u, float v) {
+    return 0xFF000000u | (clampChannel(y + m.rv * v) << 16) | (clampChannel(y + m.gu * u + m.gv * v) << 8)
+           | clampChannel(y + m.bu * u);
+}
+
+// acc[i] += src[i]. This is where nearly all source bytes are touched, so it
+// is the part worth vectorizing; the per-output-pixel work after it is
+// proportional to the (much smaller) preview size.
+void accumulateRow(quint16 *acc, const uchar *src, int n) {
+    int x = 0;
+#ifdef FRAME_SCALER_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= n; x += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x));
+        __m128i *a = reinterpret_cast<__m128i *>(acc + x);
+        _mm_storeu_si128(a, _mm_add_epi16(_mm_loadu_si128(a), _mm_unpacklo_epi8(v, zero)));
+        _mm_storeu_si128(a + 1, _mm_add_epi16(_mm_loadu_si128(a + 1), _mm_unpackhi_epi8(v, zero)));
+    }
+#endif
+    for (; x < n; ++x) acc[x] += src[x];
+}
+
+inline int spanSum(const quint16 *acc, int from, int to, int step) {
+    int sum = 0;
+    for (int i = from; i < to; ++i) sum += acc[i * step];
+    return sum;
+}
+
+}
+
+bool FrameScaler::supports(const QVideoFrame &frame) {
+    switch (frame.pixelFormat()) {
+    case QVideoFrameFormat::Format_NV12:
+    case QVideoFrameFormat::Format_NV21:
+    case QVideoFrameFormat::Format_YUV420P:
+    case QVideoFrameFormat::Format_YV12:
+        break;
+    default:
+        return false;
+    }
+    const auto colorSpace = frame.surfaceFormat().colorSpace();
+    if (colorSpace != QVideoFrameFormat::ColorSpace_Undefined && colorSpace != QVideoFrameFormat::ColorSpace_BT601
+        && colorSpace != QVideoFrameFormat::ColorSpace_BT709) {
+        return false;
+    }
+    return frame.rotation() == QtVideo::Rotation::None && !frame.mirrored();
+}
+
+bool FrameScaler::scale(const QVideoFrame &frame, const QSize &bounds, QImage &dst, bool fast) {
+    if (!supports(frame)) return false;
+    const int sw = frame.width();
+    const int sh = frame.height();
+    const QSize out = QSize(sw, sh).scaled(bounds, Qt::KeepAspectRatio);
+    const int ow = out.width();
+    const int oh = out.height();
+    // Upscaling (small source, big window) stays on the smooth-scale path;
+    // spans taller than 256 rows would overflow the 16-bit accumulators.
+    if (ow <= 0 || oh <= 0 || ow > sw || oh > sh || (sh + oh - 1) / oh > 256) return false;
+
+    QVideoFrame mapped(frame);
+    if (!mapped.map(QVideoFrame::ReadOnly)) return false;
+
+    const auto pixelFormat = mapped.pixelFormat();
+    const bool interleaved = pixelFormat == QVideoFrameFormat::Format_NV12 || pixelFormat == QVideoFrameFormat::Format_NV21;
+    if (mapped.planeCount() != (interleaved ? 2 : 3)) {
+        mapped.unmap();
+        return false;
+    }
+
+    if (dst.size() != out || dst.format() != QImage::Format_RGB32) dst = QImage(out, QImage::Format_RGB32);
+    if (dst.isNull()) {
+        mapped.unmap();
+        return false;
+    }
+
+    const auto colorSpace = mapped.surfaceFormat().colorSpace();
+    const bool bt709 = colorSpace == QVideoFrameFormat::ColorSpace_BT709
+                       || (colorSpace == QVideoFrameFormat::ColorSpace_Undefined && sh > 576);
+    const YuvMatrix m = makeMatrix(bt709, mapped.surfaceFormat().colorRange() == QVideoFrameFormat::ColorRange_Full);
+
+    const int cw = (sw + 1) / 2;
+    const int ch = (sh + 1) / 2;
+    const uchar *yPlane = mapped.bits(0);
+    const int yStride = mapped.bytesPerLine(0);
+    // Plane (or interleave slot) holding Cb and Cr respectively.
+    const bool swapUV = pixelFormat == QVideoFrameFormat::Format_NV21 || pixelFormat == QVideoFrameFormat::Format_YV12;
+    const uchar *cPlane[2] = { mapped.bits(1), interleaved ? nullptr : mapped.bits(2) };
+    const int cStride[2] = { mapped.bytesPerLine(1), interleaved ? 0 : mapped.bytesPerLine(2) };
+
+    m_colStart.resize(ow + 1);
+    m_colInv.resize(ow);
+    m_chromaColInv.resize(ow);
+    for (int ox = 0; ox <= ow; ++ox) m_colStart[ox] = static_cast<int>(qint64(ox) * sw / ow);
+    for (int ox = 0; ox < ow; ++ox) {
+        const int x0 = m_colStart[ox], x1 = m_colStart[ox + 1];
+        m_colInv[ox] = 1.0f / (x1 - x0);
+        m_chromaColInv[ox] = 1.0f / (qMin(cw, (x1 + 1) / 2) - x0 / 2);
+    }
+    m_lumaAcc.resize(sw);
+    m_chromaAcc[0].resize(interleaved ? 2 * cw : cw);
+    if (!interleaved) m_chromaAcc[1].resize(cw);
+
+    for (int oy = 0; oy < oh; ++oy) {
+        const int y0 = static_cast<int>(qint64(oy) * sh / oh);
+        const int y1 = fast ? y0 + 1 : static_cast<int>(qint64(oy + 1) * sh / oh);
+        const int cy0 = y0 / 2;
+        const int cy1 = fast ? cy0 + 1 : qMin(ch, (y1 + 1) / 2);
+
+        std::fill(m_lumaAcc.begin(), m_lumaAcc.end(), quint16(0));
+        for (int y = y0; y < y1; ++y) accumulateRow(m_lumaAcc.data(), yPlane + qsizetype(y) * yStride, sw);
+        for (int p = 0; p < (interleaved ? 1 : 2); ++p) {
+            std::fill(m_chromaAcc[p].begin(), m_chromaAcc[p].end(), quint16(0));
+            const int n = static_cast<int>(m_chromaAcc[p].size());
+            for (int y = cy0; y < cy1; ++y) accumulateRow(m_chromaAcc[p].data(), cPlane[p] + qsizetype(y) * cStride[p], n);
+        }
+
+        const float lumaRowInv = 1.0f / (y1 - y0);
+        const float chromaRowInv = 1.0f / (cy1 - cy0);
+        // Interleaved: Cb/Cr alternate in one accumulator; planar: one each.
+        const quint16 *cb = m_chromaAcc[swapUV && !interleaved ? 1 : 0].data() + (interleaved && swapUV ? 1 : 0);
+        const quint16 *cr = interleaved ? m_chromaAcc[0].data() + (swapUV ? 0 : 1) : m_chromaAcc[swapUV ? 0 : 1].data();
+        const int cStep = interleaved ? 2 : 1;
+
+        quint32 *row = reinterpret_cast<quint32 *>(dst.scanLine(oy));
+        for (int ox = 0; ox < ow; ++ox) {
+            const int x0 = m_colStart[ox], x1 = m_colStart[ox + 1];
+            const int cx0 = x0 / 2, cx1 = qMin(cw, (x1 + 1) / 2);
+            const float chromaInv = m_chromaColInv[ox] * chromaRowInv;
+            const float y = (spanSum(m_lumaAcc.data(), x0, x1, 1) * m_colInv[ox] * lumaRowInv - m.yOffset) * m.yScale;
+            const float u = spanSum(cb, cx0, cx1, cStep) * chromaInv - 128.0f;
+            const float v = spanSum(cr, cx0, cx1, cStep) * chromaInv - 128.0f;
+            row[ox] = packRgb(m, y, u, v);
+        }
+    }
+
+    mapped.unmap();
+    return true;
+}
+
+bool FrameScaler::convertRegion(const QVideoFrame &frame, const QRect &rect, QImage &dst) {
+    if (!supports(frame)) return false;
+    const QRect region = rect.intersected(QRect(0, 0, frame.width(), frame.height()));
+    if (region.isEmpty()) return false;
+
+    QVideoFrame mapped(frame);
+    if (!mapped.map(QVideoFrame::ReadOnly)) return false;
+
+    const auto pixelFormat = mapped.pixelFormat();
+    const bool interleaved = pixelFormat == QVideoFrameFormat::Format_NV12 || pixelFormat == QVideoFrameFormat::Format_NV21;
+    if (mapped.planeCount() != (interleaved ? 2 : 3)) {
+        mapped.unmap();
+        return false;
+    }
+    if (dst.size() != region.size() || dst.format() != QImage::Format_RGB32) dst = QImage(region.size(), QImage::Format_RGB32);
+    if (dst.isNull()) {
+        mapped.unmap();
+        return false;
+    }
+
+    const auto colorSpace = mapped.surfaceFormat().colorSpace();
+    const bool bt709 = colorSpace == QVideoFrameFormat::ColorSpace_BT709
+                       || (colorSpace == QVideoFrameFormat::ColorSpace_Undefined && frame.height() > 576);
+    const YuvMatrix m = makeMatrix(bt709, mapped.surfaceFormat().colorRange() == QVideoFrameFormat::ColorRange_Full);
+
+    const bool swapUV = pixelFormat == QVideoFrameFormat::Format_NV21 || pixelFormat == QVideoFrameFormat::Format_YV12;
+    const uchar *yPlane = mapped.bits(0);
+    const int yStride = mapped.bytesPerLine(0);
+    // Interleaved: one plane, Cb/Cr two bytes apart. Planar: one plane each.
+    const uchar *cbPlane = interleaved ? mapped.bits(1) + (swapUV ? 1 : 0) : mapped.bits(swapUV ? 2 : 1);
+    const uchar *crPlane = interleaved ? mapped.bits(1) + (swapUV ? 0 : 1) : mapped.bits(swapUV ? 1 : 2);
+    const int cbStride = mapped.bytesPerLine(interleaved ? 1 : (swapUV ? 2 : 1));
+    const int crStride = mapped.bytesPerLine(interleaved ? 1 : (swapUV ? 1 : 2));
+    const int cStep = interleaved ? 2 : 1;
+
+    for (int y = region.top(); y <= region.bottom(); ++y) {
+        const uchar *luma = yPlane + qsizetype(y) * yStride;
+        const uchar *cb = cbPlane + qsizetype(y / 2) * cbStride;
+        const uchar *cr = crPlane + qsizetype(y / 2) * crStride;
+        quint32 *row = reinterpret_cast<quint32 *>(dst.scanLine(y - region.top()));
+        for (int x = region.left(); x <= region.right(); ++x) {
+            const int c = (x / 2) * cStep;
+            row[x - region.left()] = packRgb(m, (luma[x] - m.yOffset) * m.yScale, cb[c] - 128.0f, cr[c] - 128.0f);
+        }
+    }
+
+    mapped.unmap();
+    return true;
+}
@@ -29,7 +29,7 @@ bool TimelineWidget::handleGlobalKey(QKeyEvent *event) {
         emitVisualStateForCurrentContext();
         emit playheadMoved(currentPosMs);
         showNotification("⏪ REPLAY");
-        update();
+        updatePlayhead();
         return true;
     }
 
@@ -37,7 +37,7 @@ bool TimelineWidget::handleGlobalKey(QKeyEvent *event) {
         currentPosMs = qMin(durationMs, currentPosMs + settings.majorSeekMs);
         emitVisualStateForCurrentContext();
         emit playheadMoved(currentPosMs);
-        update();
+        updatePlayhead();
         return true;
     }
 
@@ -45,14 +45,14 @@ bool TimelineWidget::handleGlobalKey(QKeyEvent *event) {
         currentPosMs = qMax<qint64>(0LL, currentPosMs - settings.minorSeekMs);
         emitVisualStateForCurrentContext();
         emit playheadMoved(currentPosMs);
-        update();
+        updatePlayhead();
         return true;
     }
     if (matchesShortcut(event, editorSettings.keyStepForward)) {
         currentPosMs = qMin(durationMs, currentPosMs + settings.minorSeekMs);
         emitVisualStateForCurrentContext();
         emit playheadMoved(currentPosMs);
-        update();
+        updatePlayhead();
         return true;
     }
 
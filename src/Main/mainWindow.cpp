@@ -8,6 +8,7 @@
 #include "../Includes/appsettings.h"
 #include "../Includes/icons.h"
 #include "../Includes/dragToolButton.h"
+#include "../Includes/workerPools.h"
 #include <QMenu>
 #include <QProgressBar>
 #include <QInputDialog>
@@ -42,6 +43,7 @@
 #include <QGridLayout>
 #include <QResizeEvent>
 #include <QDateTime>
+#include <QDebug>
 #include <QScrollArea>
 #include <QSet>
 #include <QSettings>
@@ -76,6 +78,23 @@ QString withFallbackColor(const QString &value, const QString &fallback) {
     return color.isValid() ? color.name(QColor::HexRgb) : fallback;
 }
 
+VideoWithCropWidget::FilterObject previewFilterFor(const TimelineWidget::OverlayClip &ov, qint64 timeMs) {
+    VideoWithCropWidget::FilterObject obj;
+    const QRectF region = ov.regionAt(timeMs);
+    obj.l = region.left(); obj.t = region.top(); obj.r = region.right(); obj.b = region.bottom();
+    obj.mode = ov.type;
+    obj.text = ov.text;
+    obj.shapeKind = ov.shapeKind;
+    obj.shapeColor = ov.shapeColor;
+    obj.shapeThickness = ov.shapeThickness;
+    obj.brightness = ov.brightness;
+    obj.contrast = ov.contrast;
+    obj.saturation = ov.saturation;
+    obj.imagePath = ov.imagePath;
+    obj.opacity = ov.opacity;
+    return obj;
+}
+
 QString formatTimecode(qint64 ms) {
     ms = qMax<qint64>(0, ms);
     const qint64 totalSeconds = ms / 1000;
@@ -161,13 +180,15 @@ void MainWindow::setupUi() {
     solidBtn = new DragToolButton(2, "■  Blackout region");
     shapeBtn = new DragToolButton(4, "▱  Shape / arrow");
     colorCorrectBtn = new DragToolButton(5, "◑  Color correction");
+    imageBtn = new DragToolButton(6, "▣  Image / logo");
     actionsGroupLabel = new QLabel("ACTIONS");
     actionsGroupLabel->setObjectName("InspectorGroupLabel");
     autoCutBtn = new QPushButton("✂  Auto-cut silence");
     resetCropBtn = new QPushButton("⤺  Reset crop");
     speedRampBtn = new QPushButton("⏱  Speed ramp…");
-    for (QPushButton *button : {textBtn, blurBtn, pixelBtn, solidBtn, shapeBtn, colorCorrectBtn,
-                                 autoCutBtn, resetCropBtn, speedRampBtn}) {
+    trackMotionBtn = new QPushButton("⌖  Track motion");
+    for (QPushButton *button : {textBtn, blurBtn, pixelBtn, solidBtn, shapeBtn, colorCorrectBtn, imageBtn,
+                                 autoCutBtn, resetCropBtn, speedRampBtn, trackMotionBtn}) {
         button->setProperty("class", "ToolBtn");
         button->setLayoutDirection(Qt::LeftToRight);
     }
@@ -177,7 +198,9 @@ void MainWindow::setupUi() {
     solidBtn->setToolTip("Add a blackout overlay at the playhead (or drag onto the video/timeline)");
     shapeBtn->setToolTip("Add a rectangle/ellipse/arrow annotation at the playhead (or drag onto the video/timeline)");
     colorCorrectBtn->setToolTip("Add a brightness/contrast/saturation region at the playhead (or drag onto the video/timeline)");
+    imageBtn->setToolTip("Add a PNG logo or watermark at the playhead (or drag onto the video/timeline)");
     speedRampBtn->setToolTip("Set a constant speed or speed ramp for the selected clip(s)");
+    trackMotionBtn->setToolTip("Make the selected overlay follow what's under it, from the playhead to the end of the clip");
 
     timelineToolsLayout->addWidget(redactGroupLabel);
     timelineToolsLayout->addWidget(textBtn);
@@ -186,11 +209,13 @@ void MainWindow::setupUi() {
     timelineToolsLayout->addWidget(solidBtn);
     timelineToolsLayout->addWidget(shapeBtn);
     timelineToolsLayout->addWidget(colorCorrectBtn);
+    timelineToolsLayout->addWidget(imageBtn);
     timelineToolsLayout->addSpacing(10);
     timelineToolsLayout->addWidget(actionsGroupLabel);
     timelineToolsLayout->addWidget(autoCutBtn);
     timelineToolsLayout->addWidget(resetCropBtn);
     timelineToolsLayout->addWidget(speedRampBtn);
+    timelineToolsLayout->addWidget(trackMotionBtn);
     timelineToolsLayout->addStretch();
 
     topPaneSplitter->addWidget(clipSidebar);
@@ -218,6 +243,21 @@ void MainWindow::setupUi() {
     audio = new QAudioOutput(this);
     player->setAudioOutput(audio);
     player->setVideoSink(videoWithCrop->sink);
+    cachePlayer = new QMediaPlayer(this); // no audio output: video only
+    cachePlayer->setVideoSink(videoWithCrop->bakedSink);
+    // A cached clip that won't play hands the preview back to live
+    // compositing instead of leaving it on the last frame.
+    auto dropCacheClip = [this]() {
+        const QString path = cachePlayerPath;
+        if (path.isEmpty()) return;
+        stopRenderCachePlayback();
+        timeline->discardRenderClip(path);
+    };
+    connect(cachePlayer, &QMediaPlayer::errorOccurred, this, dropCacheClip);
+    connect(cachePlayer, &QMediaPlayer::mediaStatusChanged, this, [dropCacheClip](QMediaPlayer::MediaStatus status) {
+        if (status == QMediaPlayer::InvalidMedia) dropCacheClip();
+    });
+    motionTracker = new MotionTracker(this);
     audio->setVolume(0.8);
     
     playPauseShortcut = nullptr;
@@ -408,6 +448,13 @@ void MainWindow::setupWorkspace() {
     videoInternalLayout->addWidget(videoWithCrop);
     stageColumnLayout->addWidget(videoContainer, 1);
 
+    // Waveform / histogram / vectorscope of the preview, toggled from the transport bar.
+    scopesPanel = new ScopesWidget(videoWithCrop->scopeAnalyzer());
+    scopesPanel->setObjectName("ScopesPanel");
+    scopesPanel->setFixedHeight(150);
+    scopesPanel->hide();
+    stageColumnLayout->addWidget(scopesPanel);
+
     // --- Transport bar: timecode | jump/step/play controls | volume · speed · snapshot · fullscreen
     transportBar = new QFrame();
     transportBar->setObjectName("TransportBar");
@@ -419,6 +466,12 @@ void MainWindow::setupWorkspace() {
     timecodeLabel->setObjectName("TimecodeLabel");
     transportLayout->addWidget(timecodeLabel);
 
+    previewQualityChip = new QLabel();
+    previewQualityChip->setObjectName("MiniBadge");
+    previewQualityChip->setToolTip("Preview quality tier (pin one in Settings > Editing)");
+    previewQualityChip->hide();
+    transportLayout->addWidget(previewQualityChip);
+
     transportLayout->addStretch();
 
     auto makeTransportBtn = [](const QString &tooltip, int size = 34) {
@@ -478,6 +531,14 @@ void MainWindow::setupWorkspace() {
 
     transportLayout->addSpacing(6);
 
+    loupeBtn = makeTransportBtn("1:1 magnifier (hover the video)", 30);
+    loupeBtn->setCheckable(true);
+    transportLayout->addWidget(loupeBtn, 0, Qt::AlignVCenter);
+
+    scopesBtn = makeTransportBtn("Video scopes", 30);
+    scopesBtn->setCheckable(true);
+    transportLayout->addWidget(scopesBtn, 0, Qt::AlignVCenter);
+
     snapshotBtn = makeTransportBtn("Save current frame as PNG", 30);
     transportLayout->addWidget(snapshotBtn, 0, Qt::AlignVCenter);
 
@@ -602,6 +663,9 @@ void MainWindow::setupConnections() {
     connect(volSlider, &QSlider::valueChanged, this, &MainWindow::updateVolume);
     connect(timeline, &TimelineWidget::audioGainChanged, this, &MainWindow::updateVolume);
     connect(player, &QMediaPlayer::playbackStateChanged, this, &MainWindow::handlePlaybackState);
+    connect(player, &QMediaPlayer::playbackRateChanged, this, [this](qreal rate) {
+        timeline->setPlaybackClock(player->playbackState() == QMediaPlayer::PlayingState, rate);
+    });
     connect(timeline, &TimelineWidget::requestTogglePlayback, [this]() {
         if (player->playbackState() == QMediaPlayer::PlayingState) player->pause();
         else player->play();
@@ -621,11 +685,12 @@ void MainWindow::setupConnections() {
         timeline->setCurrentPosition(timelinePos);
         updateVolume();
         // Overlays fade in/out as the playhead crosses their clips.
-        if (timeline->overlaysAtTime(timelinePos) != previewOverlayMap) syncOverlaysToPreview();
+        updatePreviewOverlays(timelinePos);
         if (player->playbackState() == QMediaPlayer::PlayingState) {
             timeline->validatePlayheadPosition();
             if (timeline->currentPosMs != timelinePos) seekTimeline(timeline->currentPosMs);
             if (timeline->currentPosMs >= timeline->getEndLimit()) seekTimeline(timeline->getStartLimit());
+            updateRenderCachePlayback(timeline->currentPosMs);
 
             // When playback runs past the end of the currently loaded file but
             // the composition continues (appended clips), jump to what's next.
@@ -637,10 +702,10 @@ void MainWindow::setupConnections() {
                     seekTimeline(sourceEnd);
                 }
             }
-            timeline->update();
-        } else {
-            timeline->update();
         }
+        // The playhead alone moved; the timeline's static layers stay cached.
+        // Between reports the timeline's own clock moves it at display rate.
+        timeline->updatePlayhead();
         updateTimecodeDisplay();
     });
 
@@ -651,7 +716,53 @@ void MainWindow::setupConnections() {
     connect(solidBtn, &QPushButton::clicked, this, [this]() { timeline->addOverlayAtPlayhead(2); });
     connect(shapeBtn, &QPushButton::clicked, this, [this]() { timeline->addOverlayAtPlayhead(4); });
     connect(colorCorrectBtn, &QPushButton::clicked, this, [this]() { timeline->addOverlayAtPlayhead(5); });
+    connect(imageBtn, &QPushButton::clicked, this, [this]() { timeline->addOverlayAtPlayhead(6); });
     connect(speedRampBtn, &QPushButton::clicked, this, &MainWindow::openSpeedRampDialog);
+    connect(trackMotionBtn, &QPushButton::clicked, this, &MainWindow::trackSelectedOverlay);
+    connect(motionTracker, &MotionTracker::progress, this, [this](int percent) {
+        statusLabel->setText(QString("TRACKING MOTION %1%").arg(percent));
+        statusLabel->show();
+    });
+    connect(motionTracker, &MotionTracker::finished, this,
+            [this](bool ok, const QVector<MotionTracker::Sample> &samples, const QString &message) {
+        trackMotionBtn->setText("⌖  Track motion");
+        statusLabel->clear();
+        statusLabel->hide();
+        TimelineWidget::showNotification(message);
+        const int index = trackingOverlayIdx;
+        trackingOverlayIdx = -1;
+        if (!ok || index < 0 || index >= timeline->model->overlays().size()) return;
+
+        // Keep whatever was tracked before the start; the new stretch
+        // replaces everything after it.
+        QVector<TimelineWidget::RegionKeyframe> keyframes;
+        for (const auto &key : timeline->model->overlays()[index].keyframes) {
+            if (key.timeMs < trackingStartMs) keyframes.append(key);
+        }
+        for (const auto &sample : samples) {
+            keyframes.append({trackingStartMs + sample.offsetMs, float(sample.topLeft.x()), float(sample.topLeft.y())});
+        }
+        timeline->setOverlayKeyframes(index, keyframes);
+    });
+    // Tracking takes seconds; keep the running track pointed at its clip
+    // while overlays are added or deleted around it. If the clip itself goes,
+    // or undo/redo replaces the list, the track has nowhere to land.
+    connect(timeline->model, &TimelineModel::overlaysInserted, this, [this](int first, int last) {
+        if (trackingOverlayIdx >= first) trackingOverlayIdx += last - first + 1;
+    });
+    connect(timeline->model, &TimelineModel::overlaysRemoved, this, [this](int first, int last) {
+        if (trackingOverlayIdx > last) {
+            trackingOverlayIdx -= last - first + 1;
+        } else if (trackingOverlayIdx >= first) {
+            trackingOverlayIdx = -1;
+            motionTracker->cancel();
+        }
+    });
+    connect(timeline->model, &TimelineModel::overlaysReset, this, [this]() {
+        if (trackingOverlayIdx < 0) return;
+        trackingOverlayIdx = -1;
+        motionTracker->cancel();
+    });
     connect(videoWithCrop, &VideoWithCropWidget::overlayDropped, this, [this](int type) {
         timeline->addOverlayAtPlayhead(type);
     });
@@ -666,10 +777,17 @@ void MainWindow::setupConnections() {
         for (int i = 0; i < filters.size() && i < previewOverlayMap.size(); ++i) {
             const int ovIdx = previewOverlayMap[i];
             if (ovIdx < 0 || ovIdx >= timeline->overlays.size()) continue;
-            timeline->overlays[ovIdx].l = filters[i].l;
-            timeline->overlays[ovIdx].t = filters[i].t;
-            timeline->overlays[ovIdx].r = filters[i].r;
-            timeline->overlays[ovIdx].b = filters[i].b;
+            OverlayClip ov = timeline->overlays[ovIdx];
+            // Only the region that moved: on a tracked clip an edit adds a
+            // keyframe at the playhead.
+            const QRectF shown = ov.regionAt(timeline->currentPosMs);
+            auto same = [](double a, float b) { return std::abs(a - b) < 1e-4; };
+            if (same(shown.left(), filters[i].l) && same(shown.top(), filters[i].t) &&
+                same(shown.right(), filters[i].r) && same(shown.bottom(), filters[i].b)) {
+                continue;
+            }
+            ov.setRegionAt(timeline->currentPosMs, filters[i].l, filters[i].t, filters[i].r, filters[i].b);
+            timeline->model->setOverlay(ovIdx, ov, TimelineModel::Geometry);
         }
         timeline->update();
     });
@@ -678,6 +796,11 @@ void MainWindow::setupConnections() {
         timeline->selectedOverlayIdx = (idx >= 0 && idx < previewOverlayMap.size()) ? previewOverlayMap[idx] : -1;
         timeline->update();
     });
+    connect(videoWithCrop, &VideoWithCropWidget::qualityTierChanged, this, [this](int tier) {
+        const bool pinned = editorSettings.previewQualityTier >= 0;
+        previewQualityChip->setText(QString("PREVIEW %1%2").arg(VideoWithCropWidget::tierName(tier), pinned ? " · PINNED" : ""));
+        previewQualityChip->show();
+    });
 
     // --- Export progress rendered inside the editor ---
     connect(timeline, &TimelineWidget::exportStarted, this, [this](const QString &label) {
@@ -800,6 +923,12 @@ void MainWindow::setupConnections() {
         if (rate > 0.0) player->setPlaybackRate(rate);
     });
     connect(snapshotBtn, &QPushButton::clicked, this, &MainWindow::saveSnapshot);
+    connect(loupeBtn, &QPushButton::toggled, this, [this](bool on) {
+        videoWithCrop->setLoupeEnabled(on && timeline->sourceHasVideo());
+    });
+    connect(scopesBtn, &QPushButton::toggled, this, [this](bool on) {
+        scopesPanel->setVisible(on && timeline->sourceHasVideo());
+    });
 
     // Timeline edit buttons
     connect(undoBtn, &QPushButton::clicked, this, [this]() { timeline->undo(); });
@@ -926,6 +1055,10 @@ void MainWindow::handlePlaybackState(QMediaPlayer::PlaybackState state) {
     const bool playing = state == QMediaPlayer::PlayingState;
     playPauseBtn->setIcon(playing ? pauseIcon : playIcon);
     playPauseBtn->setToolTip(playing ? "Pause" : "Play");
+    videoWithCrop->setPlaybackActive(playing);
+    timeline->setPlaybackClock(playing, player->playbackRate());
+    // Paused frames are for editing: always composite them live.
+    if (!playing) stopRenderCachePlayback();
 }
 
 void MainWindow::updateTimecodeDisplay() {
@@ -934,8 +1067,10 @@ void MainWindow::updateTimecodeDisplay() {
         timecodeLabel->setText("00:00.000 / 00:00.000");
         return;
     }
-    const qint64 totalMs = static_cast<qint64>(timeline->getTotalSegmentsDuration() * 1000.0);
-    timecodeLabel->setText(QString("%1 / %2").arg(formatTimecode(timeline->currentPosMs), formatTimecode(totalMs)));
+    // Both sides in output time (cuts removed, speed ramps applied), so the
+    // position reaches the total exactly at the end of the last segment.
+    timecodeLabel->setText(QString("%1 / %2").arg(formatTimecode(timeline->outputTimeAt(timeline->currentPosMs)),
+                                                  formatTimecode(timeline->outputDurationMs())));
 }
 
 void MainWindow::updateTimelineChips() {
@@ -1006,6 +1141,27 @@ void MainWindow::loadClipDirectly(const QString &filePath) {
     switchingSource = false;
     pendingSeekLocalPos = -1;
     previewOverlayMap.clear();
+    previewOverlayRevision = 0;
+    // A track still running belongs to the old media's overlays.
+    trackingOverlayIdx = -1;
+    motionTracker->cancel();
+    const auto stats = videoWithCrop->previewStats();
+    if (stats.received > 0) {
+        qInfo().noquote() << QString("Preview frames: %1 received, %2 composited, %3 presented, "
+                                     "%4 dropped before composite, %5 dropped before paint")
+                                 .arg(stats.received).arg(stats.composited).arg(stats.presented)
+                                 .arg(stats.droppedBeforeComposite).arg(stats.droppedBeforePaint);
+    }
+    for (int k = 0; k < WorkerPools::KindCount; ++k) {
+        const auto kind = static_cast<WorkerPools::Kind>(k);
+        const WorkerPools::PoolStats pool = WorkerPools::stats(kind);
+        if (pool.completed == 0) continue;
+        qInfo().noquote() << QString("%1 pool: %2 threads, %3 tasks, %4 queued now (peak %5), "
+                                     "wait %6 ms avg / %7 ms max")
+                                 .arg(WorkerPools::name(kind)).arg(pool.maxThreads).arg(pool.completed)
+                                 .arg(pool.queued).arg(pool.peakQueued)
+                                 .arg(pool.avgWaitMs, 0, 'f', 2).arg(pool.maxWaitMs, 0, 'f', 2);
+    }
     videoWithCrop->lastFrame = QImage();
     videoWithCrop->filterObjects.clear();
     videoWithCrop->selectedFilterIdx = -1;
@@ -1064,6 +1220,12 @@ void MainWindow::loadEditorSettings() {
     editorSettings.emptyTransportHint = settings.value("editing/emptyTransportHint", editorSettings.emptyTransportHint).toString();
     editorSettings.videoTransportHint = settings.value("editing/videoTransportHint", editorSettings.videoTransportHint).toString();
     editorSettings.audioTransportHint = settings.value("editing/audioTransportHint", editorSettings.audioTransportHint).toString();
+    editorSettings.previewQualityTier = settings.value("editing/previewQualityTier", editorSettings.previewQualityTier).toInt();
+    editorSettings.scopesRefreshHz = settings.value("editing/scopesRefreshHz", editorSettings.scopesRefreshHz).toInt();
+    editorSettings.autoRenderCache = settings.value("editing/autoRenderCache", editorSettings.autoRenderCache).toBool();
+    editorSettings.previewThreads = settings.value("editing/previewThreads", editorSettings.previewThreads).toInt();
+    editorSettings.analysisThreads = settings.value("editing/analysisThreads", editorSettings.analysisThreads).toInt();
+    editorSettings.ioThreads = settings.value("editing/ioThreads", editorSettings.ioThreads).toInt();
     if (themeVersion >= 2) {
     editorSettings.timelineAccentColor = settings.value("appearance/timelineAccentColor", editorSettings.timelineAccentColor).toString();
     editorSettings.timelineSecondaryColor = settings.value("appearance/timelineSecondaryColor", editorSettings.timelineSecondaryColor).toString();
@@ -1169,6 +1331,12 @@ void MainWindow::saveEditorSettings() const {
     settings.setValue("editing/emptyTransportHint", editorSettings.emptyTransportHint);
     settings.setValue("editing/videoTransportHint", editorSettings.videoTransportHint);
     settings.setValue("editing/audioTransportHint", editorSettings.audioTransportHint);
+    settings.setValue("editing/previewQualityTier", editorSettings.previewQualityTier);
+    settings.setValue("editing/scopesRefreshHz", editorSettings.scopesRefreshHz);
+    settings.setValue("editing/autoRenderCache", editorSettings.autoRenderCache);
+    settings.setValue("editing/previewThreads", editorSettings.previewThreads);
+    settings.setValue("editing/analysisThreads", editorSettings.analysisThreads);
+    settings.setValue("editing/ioThreads", editorSettings.ioThreads);
     settings.setValue("appearance/timelineAccentColor", editorSettings.timelineAccentColor);
     settings.setValue("appearance/timelineSecondaryColor", editorSettings.timelineSecondaryColor);
     settings.setValue("appearance/timelineBackgroundColor", editorSettings.timelineBackgroundColor);
@@ -1264,6 +1432,12 @@ void MainWindow::applyEditorSettings() {
     videoWithCrop->m_secondaryColor = QColor(editorSettings.previewSecondaryColor);
     videoWithCrop->m_backgroundColor = QColor(editorSettings.previewBackgroundColor);
     videoWithCrop->setPlaceholderState(editorSettings.previewPlaceholderTitle, editorSettings.previewPlaceholderBody);
+    videoWithCrop->setPinnedQualityTier(editorSettings.previewQualityTier);
+    scopesPanel->setRefreshRate(editorSettings.scopesRefreshHz);
+    timeline->setAutoRenderCache(editorSettings.autoRenderCache);
+    WorkerPools::setThreadCount(WorkerPools::Preview, editorSettings.previewThreads);
+    WorkerPools::setThreadCount(WorkerPools::Analysis, editorSettings.analysisThreads);
+    WorkerPools::setThreadCount(WorkerPools::FileIO, editorSettings.ioThreads);
     timeline->cropTop = editorSettings.defaultCropTop;
     timeline->cropBottom = editorSettings.defaultCropBottom;
     timeline->cropLeft = editorSettings.defaultCropLeft;
@@ -1587,23 +1761,27 @@ void MainWindow::applyToolButtonOrder() {
         }
         order.insert(insertAt + 1, newId);
     };
-    const QStringList redactIds = {"text", "blur", "pixel", "blackout", "shape", "colorcorrect"};
-    const QStringList actionIds = {"autocut", "resetcrop", "speedramp"};
+    const QStringList redactIds = {"text", "blur", "pixel", "blackout", "shape", "colorcorrect", "image"};
+    const QStringList actionIds = {"autocut", "resetcrop", "speedramp", "track"};
     insertAfterLastOf(redactIds, "shape");
     insertAfterLastOf(redactIds, "colorcorrect");
+    insertAfterLastOf(redactIds, "image");
     insertAfterLastOf(actionIds, "speedramp");
+    insertAfterLastOf(actionIds, "track");
     const QList<QPair<QString, QWidget*>> redactButtons = {
         {"text", textBtn},
         {"blur", blurBtn},
         {"pixel", pixelBtn},
         {"blackout", solidBtn},
         {"shape", shapeBtn},
-        {"colorcorrect", colorCorrectBtn}
+        {"colorcorrect", colorCorrectBtn},
+        {"image", imageBtn}
     };
     const QList<QPair<QString, QWidget*>> actionButtons = {
         {"autocut", autoCutBtn},
         {"resetcrop", resetCropBtn},
-        {"speedramp", speedRampBtn}
+        {"speedramp", speedRampBtn},
+        {"track", trackMotionBtn}
     };
 
     bool redactGroupShown = false;
@@ -1656,6 +1834,8 @@ void MainWindow::applyIcons() {
     stepFwdBtn->setIcon(Icons::stepForward(iconColor));
     jumpFwdBtn->setIcon(Icons::jumpForward(iconColor));
     muteBtn->setIcon(muteBtn->isChecked() ? volumeMutedIcon : volumeIcon);
+    loupeBtn->setIcon(Icons::magnifier(iconColor));
+    scopesBtn->setIcon(Icons::scopes(iconColor));
     snapshotBtn->setIcon(Icons::snapshot(iconColor));
     fullscreenBtn->setIcon(isVideoFullscreen ? exitFullscreenIcon : fullscreenIcon);
     helpBtn->setIcon(Icons::help(mutedColor));
@@ -1672,12 +1852,14 @@ void MainWindow::applyIcons() {
     const QSize small(15, 15);
     historyBtn->setIconSize(QSize(11, 11));
     for (QPushButton *btn : {jumpBackBtn, stepBackBtn, stepFwdBtn, jumpFwdBtn,
-                             muteBtn, snapshotBtn, fullscreenBtn, helpBtn, settingsBtn,
+                             muteBtn, loupeBtn, scopesBtn, snapshotBtn, fullscreenBtn, helpBtn, settingsBtn,
                              undoBtn, redoBtn, splitBtn, deleteClipBtn}) {
         btn->setIconSize(QSize(16, 16));
     }
     sidebarImportBtn->setIconSize(QSize(13, 13));
     muteBtn->setIconSize(small);
+    loupeBtn->setIconSize(small);
+    scopesBtn->setIconSize(small);
     snapshotBtn->setIconSize(small);
     fullscreenBtn->setIconSize(small);
 }
@@ -1699,13 +1881,21 @@ void MainWindow::saveSnapshot() {
     const QString path = QString("%1/%2_frame_%3.png")
         .arg(dir, base, QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
 
-    if (videoWithCrop->lastFrame.save(path)) {
-        TimelineWidget::showNotification("FRAME SAVED 📸");
-        statusLabel->setText("FRAME SAVED");
-        statusLabel->show();
-    } else {
-        TimelineWidget::showNotification("SNAPSHOT FAILED ❌");
-    }
+    // PNG encoding of a full frame takes long enough to hitch playback;
+    // do it on the I/O pool and report back on the GUI thread.
+    const QImage frame = videoWithCrop->lastFrame;
+    (void)WorkerPools::run(WorkerPools::FileIO, [this, frame, path]() {
+        const bool saved = frame.save(path);
+        QMetaObject::invokeMethod(this, [this, saved]() {
+            if (saved) {
+                TimelineWidget::showNotification("FRAME SAVED 📸");
+                statusLabel->setText("FRAME SAVED");
+                statusLabel->show();
+            } else {
+                TimelineWidget::showNotification("SNAPSHOT FAILED ❌");
+            }
+        }, Qt::QueuedConnection);
+    });
 }
 
 void MainWindow::showShortcutsDialog() {
@@ -1793,30 +1983,53 @@ void MainWindow::seekTimeline(qint64 timelinePosMs) {
     updateTimecodeDisplay();
     // The player may not emit a position tick at the target time (especially
     // right after a source switch), so keep the preview overlays in sync here.
-    if (timeline->overlaysAtTime(timelinePosMs) != previewOverlayMap) syncOverlaysToPreview();
+    updatePreviewOverlays(timelinePosMs);
+}
+
+void MainWindow::updateRenderCachePlayback(qint64 timelinePosMs) {
+    const TimelineWidget::RenderRange *range = timeline->readyRenderRangeAt(timelinePosMs);
+    if (!range || range->sourceIdx != activeSourceIdx || switchingSource) {
+        stopRenderCachePlayback();
+        return;
+    }
+
+    // Re-seek the cache player only when it has drifted visibly; seeking
+    // on every tick would stall it.
+    constexpr qint64 kMaxDriftMs = 120;
+    const qint64 clipPos = timelinePosMs - range->startMs;
+    if (cachePlayerPath != range->cachePath) {
+        cachePlayerPath = range->cachePath;
+        cachePlayer->setSource(QUrl::fromLocalFile(cachePlayerPath));
+        cachePlayer->setPosition(clipPos);
+        videoWithCrop->setBakedOverlays(true);
+    } else if (cachePlayer->mediaStatus() == QMediaPlayer::BufferedMedia &&
+               std::abs(cachePlayer->position() - clipPos) > kMaxDriftMs) {
+        cachePlayer->setPosition(clipPos);
+    }
+    if (cachePlayer->playbackRate() != player->playbackRate()) cachePlayer->setPlaybackRate(player->playbackRate());
+    if (cachePlayer->playbackState() != QMediaPlayer::PlayingState) cachePlayer->play();
+}
+
+void MainWindow::stopRenderCachePlayback() {
+    if (cachePlayerPath.isEmpty()) return;
+    cachePlayerPath.clear();
+    cachePlayer->stop();
+    cachePlayer->setSource(QUrl()); // let go of the file (the cache may be cleared)
+    videoWithCrop->setBakedOverlays(false);
 }
 
 // Pushes the overlay clips active at the playhead into the preview widget so
 // their regions render (and can be dragged) on the video.
 void MainWindow::syncOverlaysToPreview() {
     syncingPreview = true;
-    previewOverlayMap = timeline->overlaysAtTime(timeline->currentPosMs);
+    previewOverlaySlot = timeline->overlaySlotAt(timeline->currentPosMs);
+    previewOverlayRevision = timeline->overlayScheduleRevision();
+    previewOverlayMap = timeline->overlaysInSlot(previewOverlaySlot);
 
     QList<VideoWithCropWidget::FilterObject> regions;
     int selectedPreviewIdx = -1;
     for (int i = 0; i < previewOverlayMap.size(); ++i) {
-        const auto &ov = timeline->overlays[previewOverlayMap[i]];
-        VideoWithCropWidget::FilterObject obj;
-        obj.l = ov.l; obj.t = ov.t; obj.r = ov.r; obj.b = ov.b;
-        obj.mode = ov.type;
-        obj.text = ov.text;
-        obj.shapeKind = ov.shapeKind;
-        obj.shapeColor = ov.shapeColor;
-        obj.shapeThickness = ov.shapeThickness;
-        obj.brightness = ov.brightness;
-        obj.contrast = ov.contrast;
-        obj.saturation = ov.saturation;
-        regions.append(obj);
+        regions.append(previewFilterFor(timeline->model->overlays()[previewOverlayMap[i]], timeline->currentPosMs));
         if (previewOverlayMap[i] == timeline->selectedOverlayIdx) selectedPreviewIdx = i;
     }
 
@@ -1828,9 +2041,65 @@ void MainWindow::syncOverlaysToPreview() {
     syncingPreview = false;
 }
 
+void MainWindow::updatePreviewOverlays(qint64 timelinePosMs) {
+    const int slot = timeline->overlaySlotAt(timelinePosMs);
+    const quint64 revision = timeline->overlayScheduleRevision();
+    if (revision != previewOverlayRevision) {
+        // Overlays were edited since the preview was built: the regions
+        // themselves may differ, not just which ones are active.
+        syncOverlaysToPreview();
+        return;
+    }
+    auto &regions = videoWithCrop->filterObjects;
+    bool changed = false;
+    syncingPreview = true;
+    if (slot != previewOverlaySlot) {
+        previewOverlaySlot = slot;
+        const QList<int> &active = timeline->overlaysInSlot(slot);
+        // Both lists are sorted by overlay index: merge them, removing regions
+        // whose overlay ended and inserting the ones that started, so regions
+        // that stay active keep their place (and the worker its dirty-rect base).
+        int i = 0, j = 0;
+        while (i < previewOverlayMap.size() || j < active.size()) {
+            if (j >= active.size() || (i < previewOverlayMap.size() && previewOverlayMap[i] < active[j])) {
+                previewOverlayMap.removeAt(i);
+                regions.removeAt(i);
+                changed = true;
+            } else if (i >= previewOverlayMap.size() || active[j] < previewOverlayMap[i]) {
+                previewOverlayMap.insert(i, active[j]);
+                regions.insert(i, previewFilterFor(timeline->model->overlays()[active[j]], timelinePosMs));
+                changed = true;
+                ++i; ++j;
+            } else {
+                ++i; ++j;
+            }
+        }
+    }
+    // Motion-tracked regions move between boundaries too.
+    for (int i = 0; i < previewOverlayMap.size() && i < regions.size(); ++i) {
+        const auto &ov = timeline->model->overlays()[previewOverlayMap[i]];
+        if (ov.keyframes.isEmpty()) continue;
+        const QRectF region = ov.regionAt(timelinePosMs);
+        auto &obj = regions[i];
+        if (obj.l == float(region.left()) && obj.t == float(region.top())) continue;
+        obj.l = region.left(); obj.t = region.top(); obj.r = region.right(); obj.b = region.bottom();
+        changed = true;
+    }
+    if (!changed) {
+        syncingPreview = false;
+        return;
+    }
+    const int selectedPreviewIdx = timeline->selectedOverlayIdx >= 0 ? previewOverlayMap.indexOf(timeline->selectedOverlayIdx) : -1;
+    videoWithCrop->selectedFilterIdx = selectedPreviewIdx;
+    videoWithCrop->adjustingFilter = selectedPreviewIdx >= 0;
+    videoWithCrop->triggerScale();
+    videoWithCrop->update();
+    syncingPreview = false;
+}
+
 void MainWindow::editTextOverlay(int index) {
     if (index < 0 || index >= timeline->overlays.size()) return;
-    auto &ov = timeline->overlays[index];
+    OverlayClip ov = timeline->overlays[index];
     if (ov.type != 3) return;
 
     bool ok = false;
@@ -1838,19 +2107,25 @@ void MainWindow::editTextOverlay(int index) {
                                                         "Text shown on the video:", ov.text, &ok);
     if (!ok) return;
     ov.text = text.trimmed().isEmpty() ? QStringLiteral("Your text") : text;
+    timeline->model->setOverlay(index, ov, TimelineModel::Appearance);
     timeline->update();
     syncOverlaysToPreview();
 }
 
 void MainWindow::editOverlayProperties(int index) {
     if (index < 0 || index >= timeline->overlays.size()) return;
-    auto &ov = timeline->overlays[index];
-    if (ov.type != 4 && ov.type != 5) return;
+    OverlayClip ov = timeline->overlays[index];
+    if (ov.type != 4 && ov.type != 5 && ov.type != 6) return;
+    // Shows an edit live, on the timeline and the preview, before OK.
+    auto preview = [this, index, &ov](TimelineModel::Fields fields) {
+        timeline->model->setOverlay(index, ov, fields);
+        syncOverlaysToPreview();
+    };
 
     QDialog dialog(this);
     dialog.setObjectName("SettingsDialog");
     dialog.setStyleSheet(buildAppStyleSheet());
-    dialog.setWindowTitle(ov.type == 4 ? "Shape / Arrow" : "Color Correction");
+    dialog.setWindowTitle(ov.type == 4 ? "Shape / Arrow" : ov.type == 5 ? "Color Correction" : "Image / Logo");
 
     auto *layout = new QVBoxLayout(&dialog);
     layout->setContentsMargins(16, 16, 16, 12);
@@ -1886,23 +2161,23 @@ void MainWindow::editOverlayProperties(int index) {
         thicknessSpin->setValue(ov.shapeThickness);
         form->addRow("Thickness", thicknessSpin);
 
-        connect(kindBox, &QComboBox::currentIndexChanged, &dialog, [this, &ov, kindBox]() {
+        connect(kindBox, &QComboBox::currentIndexChanged, &dialog, [this, &ov, preview, kindBox]() {
             ov.shapeKind = kindBox->currentIndex();
             timeline->update();
-            syncOverlaysToPreview();
+            preview(TimelineModel::Appearance);
         });
-        connect(colorBtn, &QPushButton::clicked, &dialog, [this, &ov, &dialog, colorBtn, refreshColorBtn]() {
+        connect(colorBtn, &QPushButton::clicked, &dialog, [&ov, &dialog, preview, colorBtn, refreshColorBtn]() {
             const QColor picked = QColorDialog::getColor(ov.shapeColor, &dialog, "Shape Color");
             if (!picked.isValid()) return;
             ov.shapeColor = picked;
             colorBtn->setText(picked.name().toUpper());
             refreshColorBtn(picked);
-            syncOverlaysToPreview();
+            preview(TimelineModel::Appearance);
         });
-        connect(thicknessSpin, &QSpinBox::valueChanged, &dialog, [this, &ov](int v) {
+        connect(thicknessSpin, &QSpinBox::valueChanged, &dialog, [this, &ov, preview](int v) {
             ov.shapeThickness = v;
             timeline->update();
-            syncOverlaysToPreview();
+            preview(TimelineModel::Appearance);
         });
 
         layout->addWidget(buttons);
@@ -1911,6 +2186,57 @@ void MainWindow::editOverlayProperties(int index) {
             ov.shapeColor = origColor;
             ov.shapeThickness = origThickness;
         }
+    } else if (ov.type == 6) {
+        const QString origPath = ov.imagePath;
+        const float origOpacity = ov.opacity;
+        const float origL = ov.l, origT = ov.t, origR = ov.r, origB = ov.b;
+
+        auto *fileBtn = new QPushButton(ov.imagePath.isEmpty() ? QStringLiteral("Choose…") : QFileInfo(ov.imagePath).fileName());
+        form->addRow("Image", fileBtn);
+
+        auto *opacitySlider = new QSlider(Qt::Horizontal);
+        opacitySlider->setRange(0, 100);
+        opacitySlider->setValue(qRound(ov.opacity * 100));
+        form->addRow("Opacity", opacitySlider);
+
+        connect(fileBtn, &QPushButton::clicked, &dialog, [this, &ov, &dialog, preview, fileBtn]() {
+            const QString startDir = ov.imagePath.isEmpty() ? QStandardPaths::writableLocation(QStandardPaths::PicturesLocation)
+                                                            : QFileInfo(ov.imagePath).absolutePath();
+            const QString path = QFileDialog::getOpenFileName(&dialog, "Choose Image", startDir,
+                                                              "Images (*.png *.webp *.jpg *.jpeg *.bmp)");
+            if (path.isEmpty()) return;
+            const QImage image = PreviewEffects::overlayImage(path);
+            if (image.isNull()) {
+                TimelineWidget::showNotification("COULD NOT READ IMAGE");
+                return;
+            }
+            ov.imagePath = path;
+            fileBtn->setText(QFileInfo(path).fileName());
+
+            // Keep the box's width and re-fit its height to the picture so a
+            // logo isn't stretched; the box still grows up from its bottom edge
+            // if the new height would run off the frame.
+            const int vidW = videoWithCrop->property("actualWidth").toInt();
+            const int vidH = videoWithCrop->property("actualHeight").toInt();
+            if (vidW > 0 && vidH > 0) {
+                const float h = qMin(1.0f, (ov.r - ov.l) * vidW * image.height() / float(image.width() * vidH));
+                ov.b = qMin(1.0f, ov.t + h);
+                ov.t = ov.b - h;
+            }
+            timeline->update();
+            preview(TimelineModel::Geometry | TimelineModel::Appearance);
+        });
+        connect(opacitySlider, &QSlider::valueChanged, &dialog, [&ov, preview](int v) {
+            ov.opacity = v / 100.0f;
+            preview(TimelineModel::Appearance);
+        });
+
+        layout->addWidget(buttons);
+        if (dialog.exec() != QDialog::Accepted) {
+            ov.imagePath = origPath;
+            ov.opacity = origOpacity;
+            ov.l = origL; ov.t = origT; ov.r = origR; ov.b = origB;
+        }
     } else {
         const float origBrightness = ov.brightness;
         const float origContrast = ov.contrast;
@@ -1929,17 +2255,17 @@ void MainWindow::editOverlayProperties(int index) {
         form->addRow("Contrast", contrastSlider);
         form->addRow("Saturation", saturationSlider);
 
-        connect(brightnessSlider, &QSlider::valueChanged, &dialog, [this, &ov](int v) {
+        connect(brightnessSlider, &QSlider::valueChanged, &dialog, [&ov, preview](int v) {
             ov.brightness = v / 100.0f;
-            syncOverlaysToPreview();
+            preview(TimelineModel::Appearance);
         });
-        connect(contrastSlider, &QSlider::valueChanged, &dialog, [this, &ov](int v) {
+        connect(contrastSlider, &QSlider::valueChanged, &dialog, [&ov, preview](int v) {
             ov.contrast = v / 100.0f;
-            syncOverlaysToPreview();
+            preview(TimelineModel::Appearance);
         });
-        connect(saturationSlider, &QSlider::valueChanged, &dialog, [this, &ov](int v) {
+        connect(saturationSlider, &QSlider::valueChanged, &dialog, [&ov, preview](int v) {
             ov.saturation = v / 100.0f;
-            syncOverlaysToPreview();
+            preview(TimelineModel::Appearance);
         });
 
         layout->addWidget(buttons);
@@ -1950,6 +2276,7 @@ void MainWindow::editOverlayProperties(int index) {
         }
     }
 
+    timeline->model->setOverlay(index, ov, TimelineModel::Geometry | TimelineModel::Appearance);
     timeline->update();
     syncOverlaysToPreview();
 }
@@ -1990,6 +2317,42 @@ void MainWindow::showHistoryMenu() {
     }
 }
 
+void MainWindow::trackSelectedOverlay() {
+    if (motionTracker->isRunning()) {
+        motionTracker->cancel();
+        return;
+    }
+    const int index = timeline->selectedOverlayIdx;
+    if (index < 0 || index >= timeline->overlays.size()) {
+        TimelineWidget::showNotification("SELECT AN OVERLAY TO TRACK");
+        return;
+    }
+    const auto &ov = timeline->model->overlays()[index];
+    const qint64 startMs = qBound(ov.startMs, timeline->currentPosMs, ov.endMs);
+    const int srcIdx = timeline->sourceIndexForTimelineTime(startMs);
+    if (srcIdx < 0 || srcIdx >= timeline->model->sources().size() || !timeline->model->sources()[srcIdx].hasVideo) {
+        TimelineWidget::showNotification("NOTHING TO TRACK HERE");
+        return;
+    }
+    const auto &src = timeline->model->sources()[srcIdx];
+    const qint64 endMs = src.durationMs > 0 ? qMin(ov.endMs, src.offsetMs + src.durationMs) : ov.endMs;
+
+    MotionTracker::Request request;
+    request.sourcePath = src.path;
+    request.sourceStartMs = startMs - timeline->sourceOffsetMs(srcIdx);
+    request.durationMs = endMs - startMs;
+    request.sourceSize = QSize(videoWithCrop->property("actualWidth").toInt(),
+                               videoWithCrop->property("actualHeight").toInt());
+    request.region = ov.regionAt(startMs);
+    if (!motionTracker->start(request)) return;
+
+    trackingOverlayIdx = index;
+    trackingStartMs = startMs;
+    trackMotionBtn->setText("■  Stop tracking");
+    statusLabel->setText("TRACKING MOTION 0%");
+    statusLabel->show();
+}
+
 void MainWindow::openSpeedRampDialog() {
     QDialog dialog(this);
     dialog.setObjectName("SettingsDialog");
@@ -2202,6 +2565,29 @@ void MainWindow::openSettingsDialog() {
     auto *emptyHintEdit = new QLineEdit(editorSettings.emptyTransportHint, editingTab);
     auto *videoHintEdit = new QLineEdit(editorSettings.videoTransportHint, editingTab);
     auto *audioHintEdit = new QLineEdit(editorSettings.audioTransportHint, editingTab);
+    auto *previewQualityBox = new QComboBox(editingTab);
+    previewQualityBox->addItem("Automatic", -1);
+    previewQualityBox->addItem("Full (HiDPI)", int(VideoWithCropWidget::QualityFull));
+    previewQualityBox->addItem("Standard (1x)", int(VideoWithCropWidget::QualityStandard));
+    previewQualityBox->addItem("Fast", int(VideoWithCropWidget::QualityFast));
+    previewQualityBox->addItem("Draft", int(VideoWithCropWidget::QualityDraft));
+    previewQualityBox->setCurrentIndex(qMax(0, previewQualityBox->findData(editorSettings.previewQualityTier)));
+    auto *scopesRateSpin = new QSpinBox(editingTab);
+    scopesRateSpin->setRange(1, 60);
+    scopesRateSpin->setSuffix(" /s");
+    scopesRateSpin->setValue(editorSettings.scopesRefreshHz);
+    auto *autoRenderCheck = new QCheckBox("Render overlay-heavy ranges when idle", editingTab);
+    autoRenderCheck->setChecked(editorSettings.autoRenderCache);
+    auto makeThreadSpin = [editingTab](int value) {
+        auto *spin = new QSpinBox(editingTab);
+        spin->setRange(0, 64);
+        spin->setSpecialValueText("Auto");
+        spin->setValue(value);
+        return spin;
+    };
+    auto *previewThreadsSpin = makeThreadSpin(editorSettings.previewThreads);
+    auto *analysisThreadsSpin = makeThreadSpin(editorSettings.analysisThreads);
+    auto *ioThreadsSpin = makeThreadSpin(editorSettings.ioThreads);
     editingForm->addRow(makeStyledLabel("Replay / jump step"), majorSeekSpin);
     editingForm->addRow(makeStyledLabel("Frame step"), minorSeekSpin);
     editingForm->addRow(makeStyledLabel("Split edge safety"), splitGuardSpin);
@@ -2215,6 +2601,12 @@ void MainWindow::openSettingsDialog() {
     editingForm->addRow(makeStyledLabel("No media hint"), emptyHintEdit);
     editingForm->addRow(makeStyledLabel("Video hint"), videoHintEdit);
     editingForm->addRow(makeStyledLabel("Audio hint"), audioHintEdit);
+    editingForm->addRow(makeStyledLabel("Preview quality"), previewQualityBox);
+    editingForm->addRow(makeStyledLabel("Scopes refresh rate"), scopesRateSpin);
+    editingForm->addRow(makeStyledLabel("Render cache"), autoRenderCheck);
+    editingForm->addRow(makeStyledLabel("Preview threads"), previewThreadsSpin);
+    editingForm->addRow(makeStyledLabel("Analysis threads"), analysisThreadsSpin);
+    editingForm->addRow(makeStyledLabel("File I/O threads"), ioThreadsSpin);
     auto *editingResetBtn = makeResetButton(editingTab);
     editingForm->addRow(editingResetBtn);
     addSettingsPage(editingTab, "Editing");
@@ -2517,6 +2909,12 @@ void MainWindow::openSettingsDialog() {
         emptyHintEdit->setText(defaults.emptyTransportHint);
         videoHintEdit->setText(defaults.videoTransportHint);
         audioHintEdit->setText(defaults.audioTransportHint);
+        previewQualityBox->setCurrentIndex(qMax(0, previewQualityBox->findData(defaults.previewQualityTier)));
+        scopesRateSpin->setValue(defaults.scopesRefreshHz);
+        autoRenderCheck->setChecked(defaults.autoRenderCache);
+        previewThreadsSpin->setValue(defaults.previewThreads);
+        analysisThreadsSpin->setValue(defaults.analysisThreads);
+        ioThreadsSpin->setValue(defaults.ioThreads);
     });
     connect(appearanceResetBtn, &QPushButton::clicked, &dialog, [=]() {
         const EditorSettings defaults;
@@ -2637,6 +3035,13 @@ void MainWindow::openSettingsDialog() {
             emptyHintEdit->setText(editing.value("emptyTransportHint").toString(emptyHintEdit->text()));
             videoHintEdit->setText(editing.value("videoTransportHint").toString(videoHintEdit->text()));
             audioHintEdit->setText(editing.value("audioTransportHint").toString(audioHintEdit->text()));
+            const int qualityIdx = previewQualityBox->findData(editing.value("previewQualityTier").toInt(previewQualityBox->currentData().toInt()));
+            if (qualityIdx >= 0) previewQualityBox->setCurrentIndex(qualityIdx);
+            scopesRateSpin->setValue(editing.value("scopesRefreshHz").toInt(scopesRateSpin->value()));
+            autoRenderCheck->setChecked(editing.value("autoRenderCache").toBool(autoRenderCheck->isChecked()));
+            previewThreadsSpin->setValue(editing.value("previewThreads").toInt(previewThreadsSpin->value()));
+            analysisThreadsSpin->setValue(editing.value("analysisThreads").toInt(analysisThreadsSpin->value()));
+            ioThreadsSpin->setValue(editing.value("ioThreads").toInt(ioThreadsSpin->value()));
         }
         if (!appearance.isEmpty()) {
             timelineAccentEdit->setText(appearance.value("timelineAccentColor").toString(timelineAccentEdit->text()));
@@ -2735,7 +3140,13 @@ void MainWindow::openSettingsDialog() {
             {"previewPlaceholderBody", QJsonValue(previewBodyEdit->text())},
             {"emptyTransportHint", QJsonValue(emptyHintEdit->text())},
             {"videoTransportHint", QJsonValue(videoHintEdit->text())},
-            {"audioHintEdit", QJsonValue(audioHintEdit->text())}
+            {"audioHintEdit", QJsonValue(audioHintEdit->text())},
+            {"previewQualityTier", QJsonValue(previewQualityBox->currentData().toInt())},
+            {"scopesRefreshHz", QJsonValue(scopesRateSpin->value())},
+            {"autoRenderCache", QJsonValue(autoRenderCheck->isChecked())},
+            {"previewThreads", QJsonValue(previewThreadsSpin->value())},
+            {"analysisThreads", QJsonValue(analysisThreadsSpin->value())},
+            {"ioThreads", QJsonValue(ioThreadsSpin->value())}
         };
         root["appearance"] = QJsonObject{
             {"timelineAccentColor", timelineAccentEdit->text()},
@@ -2841,6 +3252,12 @@ void MainWindow::openSettingsDialog() {
     editorSettings.emptyTransportHint = emptyHintEdit->text().trimmed().isEmpty() ? QString("SPACE PLAY/PAUSE | S SPLIT | CTRL+C EXPORT") : emptyHintEdit->text().trimmed();
     editorSettings.videoTransportHint = videoHintEdit->text().trimmed().isEmpty() ? QString("SPACE PLAY/PAUSE | S SPLIT | CTRL+C EXPORT VIDEO") : videoHintEdit->text().trimmed();
     editorSettings.audioTransportHint = audioHintEdit->text().trimmed().isEmpty() ? QString("SPACE PLAY/PAUSE | S SPLIT | CTRL+SHIFT+C EXPORT AUDIO") : audioHintEdit->text().trimmed();
+    editorSettings.previewQualityTier = previewQualityBox->currentData().toInt();
+    editorSettings.scopesRefreshHz = scopesRateSpin->value();
+    editorSettings.autoRenderCache = autoRenderCheck->isChecked();
+    editorSettings.previewThreads = previewThreadsSpin->value();
+    editorSettings.analysisThreads = analysisThreadsSpin->value();
+    editorSettings.ioThreads = ioThreadsSpin->value();
     editorSettings.timelineAccentColor = timelineAccentEdit->text().trimmed().isEmpty() ? QString("#FF875F") : timelineAccentEdit->text().trimmed();
     editorSettings.timelineSecondaryColor = timelineSecondaryEdit->text().trimmed().isEmpty() ? QString("#FF6B4A") : timelineSecondaryEdit->text().trimmed();
     editorSettings.timelineBackgroundColor = timelineBackgroundEdit->text().trimmed().isEmpty() ? QString("#14181D") : timelineBackgroundEdit->text().trimmed();
@@ -2974,6 +3391,10 @@ void MainWindow::refreshMediaState() {
     muteBtn->setEnabled(hasAudio);
     volSlider->setEnabled(hasAudio);
     snapshotBtn->setEnabled(hasVideo);
+    loupeBtn->setEnabled(hasVideo);
+    videoWithCrop->setLoupeEnabled(hasVideo && loupeBtn->isChecked());
+    scopesBtn->setEnabled(hasVideo);
+    scopesPanel->setVisible(hasVideo && scopesBtn->isChecked());
     exportBtn->setEnabled(hasMedia);
     exportVideoAction->setEnabled(hasVideo);
     exportMutedAction->setEnabled(hasVideo);
@@ -2984,8 +3405,10 @@ void MainWindow::refreshMediaState() {
     pixelBtn->setEnabled(hasVideo);
     solidBtn->setEnabled(hasVideo);
     resetCropBtn->setEnabled(hasVideo);
+    trackMotionBtn->setEnabled(hasVideo);
     fullscreenBtn->setEnabled(hasVideo);
     autoCutBtn->setEnabled(hasAudio);
+    previewQualityChip->setVisible(hasVideo && !previewQualityChip->text().isEmpty());
 
     statusLabel->clear();
     statusLabel->hide();
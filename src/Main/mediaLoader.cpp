@@ -1,15 +1,18 @@
 #include <qfile.h>
-#include <QVideoFrame>
-#include <QTimer>
 #include "../Includes/timelinewidget.h"
 
 void TimelineWidget::resetMediaState() {
     thumbnailCache.clear();
-    audioSamples.clear();
+    thumbnailPasses.clear();
+    if (thumbnailCancel) thumbnailCancel->store(true);
+    thumbnailPassActive = false;
+    thumbnailLoadActive = false;
+    ++thumbnailGeneration;
+    waveforms.clear();
+    waveformPeak = 0.0f;
     undoStack.clear();
     redoStack.clear();
 
-    segments.clear();
     Segment initialSegment;
     initialSegment.startMs = 0;
     initialSegment.endMs = 100;
@@ -17,18 +20,16 @@ void TimelineWidget::resetMediaState() {
     initialSegment.cropBottom = cropBottom;
     initialSegment.cropLeft = cropLeft;
     initialSegment.cropRight = cropRight;
-    segments.append(initialSegment);
+    model->setSegments({initialSegment});
 
     // A fresh load fully resets the composition: extra sources and overlay
     // clips belong to the previous timeline, not the new file.
-    sources.clear();
-    sourceFilmstrips.clear();
-    overlays.clear();
+    model->setSources({});
+    model->setOverlays({});
     selectedOverlayIdx = -1;
     overlayDrag = OvNone;
     overlayDragIdx = -1;
 
-    maxAmplitude = 0.01f;
     durationMs = 0;
     zoomFactor = 1.0;
     scrollOffset = 0;
@@ -40,8 +41,6 @@ void TimelineWidget::resetMediaState() {
     hasVideoStream = false;
     hasAudioStream = false;
     isExporting = false;
-    thumbnailRequestActive = false;
-    thumbnailRequestQueue.clear();
     emit overlaysChanged();
 }
 
@@ -52,13 +51,16 @@ void TimelineWidget::setMediaSource(const QUrl &url) {
     SourceClip primary;
     primary.path = url.toLocalFile();
     primary.offsetMs = 0;
-    sources.append(primary);
+    model->appendSource(primary);
 
     const QFile file(url.toLocalFile());
     originalFileSize = file.size();
-    if (!sources.isEmpty()) sources[0].fileSizeBytes = originalFileSize;
+    if (!sources.isEmpty()) {
+        SourceClip src = sources[0];
+        src.fileSizeBytes = originalFileSize;
+        model->setSource(0, src);
+    }
 
-    thumbPlayer->setSource(url);
     // detectAudioTracks is now async and will trigger loadAudioFast when done
     detectAudioTracks(url.toLocalFile());
 
@@ -66,30 +68,6 @@ void TimelineWidget::setMediaSource(const QUrl &url) {
     this->update();
 }
 
-void TimelineWidget::requestTimelineThumbnails() {
-    if (durationMs <= 0 || currentFileUrl.isEmpty()) return;
-
-    thumbnailRequestQueue.clear();
-    const int durationSec = qMax(1, static_cast<int>(durationMs / 1000));
-    const int stepSec = qMax(1, durationSec / 18);
-    for (int sec = 0; sec <= durationSec; sec += stepSec) {
-        if (!thumbnailCache.contains(sec)) thumbnailRequestQueue.enqueue(sec);
-    }
-    if (!thumbnailCache.contains(durationSec)) thumbnailRequestQueue.enqueue(durationSec);
-    requestNextTimelineThumbnail();
-}
-
-void TimelineWidget::requestNextTimelineThumbnail() {
-    if (thumbnailRequestActive || thumbnailRequestQueue.isEmpty()) return;
-    thumbnailRequestActive = true;
-    const int sec = thumbnailRequestQueue.dequeue();
-    thumbPlayer->setPosition(sec * 1000);
-    QTimer::singleShot(120, this, [this]() {
-        thumbnailRequestActive = false;
-        requestNextTimelineThumbnail();
-    });
-}
-
 void TimelineWidget::setDuration(qint64 duration) {
     if (duration <= 0) return;
 
@@ -97,33 +75,27 @@ void TimelineWidget::setDuration(qint64 duration) {
     this->zoomFactor = 1.0;
     this->scrollOffset = 0;
     if (!sources.isEmpty()) {
-        sources[0].durationMs = duration;
-        sources[0].hasVideo = hasVideoStream;
-        sources[0].hasAudio = hasAudioStream;
+        SourceClip src = sources[0];
+        src.durationMs = duration;
+        src.hasVideo = hasVideoStream;
+        src.hasAudio = hasAudioStream;
+        model->setSource(0, src);
     }
 
     // Stretch the placeholder to the real duration
     if (segments.isEmpty()) {
-        segments.append({0, durationMs});
+        model->insertSegment(0, {0, durationMs});
 
     } else {
         // Update the first segment to match the real duration
-        segments[0].startMs = 0;
-        segments[0].endMs = durationMs;
+        Segment first = segments[0];
+        first.startMs = 0;
+        first.endMs = durationMs;
+        model->setSegment(0, first, TimelineModel::Timing);
     }
 
     // Force a layout recalculation and a repaint
     this->relayout();
     this->update();
-    QTimer::singleShot(100, this, &TimelineWidget::requestTimelineThumbnails);
-}
-
-void TimelineWidget::processVideoFrame(const QVideoFrame &f) {
-    if (f.isValid()) {
-        int sec = thumbPlayer->position() / 1000;
-        if (!thumbnailCache.contains(sec)) {
-            thumbnailCache[sec] = f.toImage().scaled(120, trackHeight, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-            update();
-        }
-    }
+    scheduleThumbnails();
 }
@@ -0,0 +1,268 @@
+#include "../Includes/motionTracker.h"
+#include "../Includes/mediautils.h"
+#include "../Includes/workerPools.h"
+
+#include <QPoint>
+#include <QProcess>
+#include <QRect>
+#include <QThread>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MOTION_TRACKER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Mean absolute difference (per pixel) above which the best match is taken
+// to be something else: the target left the frame or got covered.
+constexpr quint32 kLostSadPerPixel = 40;
+// Kept keyframes reproduce the tracked path to within this many analysis
+// pixels when linearly interpolated.
+constexpr double kSimplifyTolerancePx = 0.75;
+constexpr int kMinTrackSize = 8;
+
+// 2x2 box average, w and h even.
+void halve(const quint8 *src, int w, int h, std::vector<quint8> &dst) {
+    const int hw = w / 2, hh = h / 2;
+    dst.resize(size_t(hw) * hh);
+    for (int y = 0; y < hh; ++y) {
+        const quint8 *r0 = src + size_t(2 * y) * w;
+        const quint8 *r1 = r0 + w;
+        quint8 *out = dst.data() + size_t(y) * hw;
+        for (int x = 0; x < hw; ++x) {
+            out[x] = quint8((r0[2 * x] + r0[2 * x + 1] + r1[2 * x] + r1[2 * x + 1] + 2) >> 2);
+        }
+    }
+}
+
+struct Match {
+    QPoint pos;
+    quint32 sad = 0xFFFFFFFFu;
+};
+
+// Exhaustive SAD search for a tw x th template in a fw x fh frame, over
+// `radius` around `center` (clamped to where the template fits). The centre
+// goes first so the early-exit bound is tight from the start.
+Match search(const quint8 *frame, int fw, int fh, const quint8 *tmpl, int tw, int th, QPoint center, int radius) {
+    Match best;
+    const int maxX = fw - tw, maxY = fh - th;
+    if (maxX < 0 || maxY < 0) return best;
+    center.setX(qBound(0, center.x(), maxX));
+    center.setY(qBound(0, center.y(), maxY));
+    auto test = [&](int x, int y) {
+        const quint32 sad = MotionTracker::blockSad(frame + size_t(y) * fw + x, fw, tmpl, tw, tw, th, best.sad);
+        if (sad < best.sad) {
+            best.sad = sad;
+            best.pos = QPoint(x, y);
+        }
+    };
+    test(center.x(), center.y());
+    for (int y = qMax(0, center.y() - radius); y <= qMin(maxY, center.y() + radius); ++y) {
+        for (int x = qMax(0, center.x() - radius); x <= qMin(maxX, center.x() + radius); ++x) {
+            test(x, y);
+        }
+    }
+    return best;
+}
+
+void copyBlock(const quint8 *frame, int fw, QPoint pos, int w, int h, std::vector<quint8> &dst) {
+    dst.resize(size_t(w) * h);
+    for (int y = 0; y < h; ++y) {
+        memcpy(dst.data() + size_t(y) * w, frame + size_t(pos.y() + y) * fw + pos.x(), size_t(w));
+    }
+}
+
+// Douglas-Peucker over time: keeps the samples a straight line between the
+// kept neighbours can't reproduce within `tolerance` (per axis, in pixels).
+QVector<MotionTracker::Sample> simplify(const QVector<MotionTracker::Sample> &samples, double scaleX, double scaleY,
+                                        double tolerance) {
+    if (samples.size() <= 2) return samples;
+    std::vector<bool> keep(samples.size(), false);
+    keep.front() = keep.back() = true;
+    std::vector<std::pair<int, int>> spans{{0, int(samples.size()) - 1}};
+    while (!spans.empty()) {
+        const auto [a, b] = spans.back();
+        spans.pop_back();
+        const auto &sa = samples[a];
+        const auto &sb = samples[b];
+        const double span = double(qMax<qint64>(1, sb.offsetMs - sa.offsetMs));
+        int worst = -1;
+        double worstErr = tolerance;
+        for (int i = a + 1; i < b; ++i) {
+            const double f = (samples[i].offsetMs - sa.offsetMs) / span;
+            const QPointF line = sa.topLeft + (sb.topLeft - sa.topLeft) * f;
+            const double err = qMax(std::abs(samples[i].topLeft.x() - line.x()) * scaleX,
+                                    std::abs(samples[i].topLeft.y() - line.y()) * scaleY);
+            if (err > worstErr) {
+                worstErr = err;
+                worst = i;
+            }
+        }
+        if (worst < 0) continue;
+        keep[worst] = true;
+        spans.push_back({a, worst});
+        spans.push_back({worst, b});
+    }
+    QVector<MotionTracker::Sample> out;
+    for (int i = 0; i < samples.size(); ++i) {
+        if (keep[i]) out.append(samples[i]);
+    }
+    return out;
+}
+
+}
+
+MotionTracker::MotionTracker(QObject *parent) : QObject(parent) {}
+
+MotionTracker::~MotionTracker() {
+    m_cancel.store(true);
+    while (m_running.load()) QThread::yieldCurrentThread();
+}
+
+quint32 MotionTracker::blockSad(const quint8 *a, int strideA, const quint8 *b, int strideB, int w, int h,
+                                quint32 limit) {
+    quint32 total = 0;
+    for (int y = 0; y < h; ++y) {
+        const quint8 *ra = a + size_t(y) * strideA;
+        const quint8 *rb = b + size_t(y) * strideB;
+        int x = 0;
+#ifdef MOTION_TRACKER_SSE2
+        __m128i acc = _mm_setzero_si128();
+        for (; x + 16 <= w; x += 16) {
+            const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ra + x));
+            const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rb + x));
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+        }
+        total += quint32(_mm_cvtsi128_si32(acc)) + quint32(_mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+#endif
+        for (; x < w; ++x) total += quint32(std::abs(int(ra[x]) - int(rb[x])));
+        if (total > limit) return total;
+    }
+    return total;
+}
+
+bool MotionTracker::start(const Request &request) {
+    bool expected = false;
+    if (!m_running.compare_exchange_strong(expected, true)) return false;
+    m_cancel.store(false);
+    (void)WorkerPools::run(WorkerPools::Analysis, [this, request]() { run(request); });
+    return true;
+}
+
+void MotionTracker::run(const Request &request) {
+    QVector<Sample> samples;
+    bool ok = false;
+    QString message;
+
+    auto finish = [&]() {
+        QMetaObject::invokeMethod(this, [this, ok, samples, message]() {
+            emit finished(ok, samples, message);
+        }, Qt::QueuedConnection);
+        m_running.store(false);
+    };
+
+    const QSize source = request.sourceSize.isValid() ? request.sourceSize : QSize(1920, 1080);
+    const int aw = qMax(32, qMin(kAnalysisWidth, source.width()) & ~1);
+    const int ah = qMax(32, qRound(double(aw) * source.height() / qMax(1, source.width())) & ~1);
+    const size_t frameBytes = size_t(aw) * ah;
+
+    const QRect box = QRect(qRound(request.region.left() * aw), qRound(request.region.top() * ah),
+                            qRound(request.region.width() * aw), qRound(request.region.height() * ah))
+                          .intersected(QRect(0, 0, aw, ah));
+    // Even sizes so the half-resolution template lines up with the full one.
+    const int tw = box.width() & ~1;
+    const int th = box.height() & ~1;
+    if (tw < kMinTrackSize || th < kMinTrackSize || request.durationMs <= 0) {
+        message = "REGION TOO SMALL TO TRACK";
+        finish();
+        return;
+    }
+
+    QProcess ffmpeg;
+    ffmpeg.start(MediaUtils::ffToolPath("ffmpeg"), {
+        "-hide_banner", "-loglevel", "error",
+        "-ss", QString::number(request.sourceStartMs / 1000.0, 'f', 3),
+        "-i", request.sourcePath,
+        "-t", QString::number(request.durationMs / 1000.0, 'f', 3),
+        "-an", "-vf", QString("fps=%1,scale=%2:%3:flags=area,format=gray").arg(kTrackFps).arg(aw).arg(ah),
+        "-f", "rawvideo", "-pix_fmt", "gray", "-"
+    });
+    if (!ffmpeg.waitForStarted(5000)) {
+        message = "TRACKING FAILED: FFMPEG NOT FOUND";
+        finish();
+        return;
+    }
+
+    const qint64 expectedFrames = qMax<qint64>(1, request.durationMs * kTrackFps / 1000);
+    const quint32 lostLimit = kLostSadPerPixel * quint32(tw) * quint32(th);
+    std::vector<quint8> tmpl, halfFrame, halfTmpl;
+    QByteArray pending;
+    qint64 frameIndex = 0;
+    QPoint pos = box.topLeft();
+    QPoint velocity(0, 0);
+    int lastPercent = -1;
+    bool lost = false;
+
+    while (!m_cancel.load()) {
+        if (size_t(pending.size()) < frameBytes) {
+            const bool ready = ffmpeg.waitForReadyRead(200);
+            pending += ffmpeg.readAllStandardOutput();
+            if (!ready && ffmpeg.state() == QProcess::NotRunning && size_t(pending.size()) < frameBytes) break;
+            continue;
+        }
+        const quint8 *frame = reinterpret_cast<const quint8 *>(pending.constData());
+
+        if (frameIndex > 0) {
+            // Coarse: half resolution, around where constant velocity puts
+            // the target. Fine: full resolution, +-2 around the coarse hit.
+            halve(frame, aw, ah, halfFrame);
+            halve(tmpl.data(), tw, th, halfTmpl);
+            const QPoint predicted = pos + velocity;
+            const Match coarse = search(halfFrame.data(), aw / 2, ah / 2, halfTmpl.data(), tw / 2, th / 2,
+                                        predicted / 2, kSearchRadius / 2);
+            const Match fine = search(frame, aw, ah, tmpl.data(), tw, th, coarse.pos * 2, 2);
+            if (fine.sad > lostLimit) {
+                lost = true;
+                break;
+            }
+            velocity = fine.pos - pos;
+            pos = fine.pos;
+        }
+        // Follow the target's current appearance, not the first frame's.
+        copyBlock(frame, aw, pos, tw, th, tmpl);
+
+        Sample sample;
+        sample.offsetMs = frameIndex * 1000 / kTrackFps;
+        sample.topLeft = request.region.topLeft()
+                         + QPointF(double(pos.x() - box.x()) / aw, double(pos.y() - box.y()) / ah);
+        samples.append(sample);
+
+        pending.remove(0, int(frameBytes));
+        ++frameIndex;
+        const int percent = int(qMin<qint64>(99, frameIndex * 100 / expectedFrames));
+        if (percent != lastPercent) {
+            lastPercent = percent;
+            QMetaObject::invokeMethod(this, [this, percent]() { emit progress(percent); }, Qt::QueuedConnection);
+        }
+    }
+
+    const bool cancelled = m_cancel.load();
+    if (ffmpeg.state() != QProcess::NotRunning) {
+        ffmpeg.kill();
+        ffmpeg.waitForFinished(2000);
+    }
+
+    samples = simplify(samples, aw, ah, kSimplifyTolerancePx);
+    ok = !samples.isEmpty();
+    const double trackedSec = frameIndex / double(kTrackFps);
+    if (!ok) message = "TRACKING FAILED: NO FRAMES DECODED";
+    else if (cancelled) message = QString("TRACKING CANCELLED AFTER %1s").arg(trackedSec, 0, 'f', 1);
+    else if (lost) message = QString("TARGET LOST AFTER %1s").arg(trackedSec, 0, 'f', 1);
+    else message = QString("TRACKED %1s · %2 KEYFRAMES").arg(trackedSec, 0, 'f', 1).arg(samples.size());
+    finish();
+}
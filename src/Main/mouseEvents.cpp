@@ -1,5 +1,6 @@
 #include "../Includes/timelinewidget.h"
 #include <QMenu>
+#include <cmath>
 
 void TimelineWidget::mousePressEvent(QMouseEvent* e) {
     if (durationMs <= 0 || segments.isEmpty()) return;
@@ -25,7 +26,7 @@ void TimelineWidget::mousePressEvent(QMouseEvent* e) {
             if (e->button() == Qt::RightButton) {
                 QMenu menu(this);
                 menu.setObjectName("TimelineContextMenu");
-                QAction *editAction = overlays[ovIdx].type == 3 ? menu.addAction("Edit text…") : nullptr;
+                QAction *editAction = model->overlays()[ovIdx].type == 3 ? menu.addAction("Edit text…") : nullptr;
                 QAction *deleteAction = menu.addAction("Delete overlay");
                 QAction *chosen = menu.exec(e->globalPosition().toPoint());
                 if (chosen && chosen == deleteAction) deleteSelectedOverlay();
@@ -37,7 +38,8 @@ void TimelineWidget::mousePressEvent(QMouseEvent* e) {
             saveState("Move overlay");
             overlayDrag = ovEdge;
             overlayDragIdx = ovIdx;
-            overlayDragGrabOffsetMs = clickTime - overlays[ovIdx].startMs;
+            buildSnapTargets(-1, ovIdx);
+            overlayDragGrabOffsetMs = clickTime - model->overlays()[ovIdx].startMs;
             update();
             emit overlaysChanged();
             return;
@@ -48,13 +50,7 @@ void TimelineWidget::mousePressEvent(QMouseEvent* e) {
         }
     }
 
-    int clickedIdx = -1;
-    for (int i = 0; i < segments.size(); ++i) {
-        if (clickTime >= segments[i].startMs && clickTime <= segments[i].endMs) {
-            clickedIdx = i;
-            break;
-        }
-    }
+    const int clickedIdx = segmentIndexAtTime(clickTime);
 
     if (e->button() == Qt::RightButton) {
         if (clickedIdx != -1) {
@@ -73,19 +69,16 @@ void TimelineWidget::mousePressEvent(QMouseEvent* e) {
         if (e->pos().x() > sidebarWidth) {
             currentPosMs = qBound(0LL, clickTime, durationMs);
             emit playheadMoved(currentPosMs);
-            update();
+            updatePlayhead();
             return;
         }
     }
 
-    for (int i = 0; i < segments.size(); ++i) {
-        if (std::abs(drawX - static_cast<int>(segments[i].startMs * pxPerMs)) < 12) {
-            activeEdge = Start; activeSegmentIdx = i; selectedSegmentIdx = i;
-            update(); return;
-        } else if (std::abs(drawX - static_cast<int>(segments[i].endMs * pxPerMs)) < 12) {
-            activeEdge = End; activeSegmentIdx = i; selectedSegmentIdx = i;
-            update(); return;
-        }
+    bool isStartEdge = false;
+    if (const int edgeIdx = segmentEdgeAt(drawX, pxPerMs, &isStartEdge); edgeIdx != -1) {
+        activeEdge = isStartEdge ? Start : End; activeSegmentIdx = edgeIdx; selectedSegmentIdx = edgeIdx;
+        buildSnapTargets(edgeIdx, -1);
+        update(); return;
     }
 
     if (clickedIdx != -1) {
@@ -121,6 +114,9 @@ void TimelineWidget::showClipContextMenu(const QPoint &globalPos, qint64 clickTi
     QAction *applyAllAction = menu.addAction("Apply current crop to all clips");
     QAction *clearClipAction = menu.addAction("Clear clip crop");
     QAction *clearAllAction = menu.addAction("Clear all clip crops");
+    menu.addSeparator();
+    QAction *renderAction = menu.addAction("Render overlay-heavy ranges");
+    QAction *clearRenderAction = menu.addAction("Clear render cache");
 
     QAction *chosen = menu.exec(globalPos);
     if (!chosen) return;
@@ -138,6 +134,15 @@ void TimelineWidget::showClipContextMenu(const QPoint &globalPos, qint64 clickTi
         return;
     }
 
+    if (chosen == renderAction) {
+        renderStaleRanges();
+        return;
+    }
+    if (chosen == clearRenderAction) {
+        clearRenderCache();
+        return;
+    }
+
     if (chosen == applyClipAction) {
         applyCurrentVisualsToSelection(false);
     } else if (chosen == applyAllAction) {
@@ -155,7 +160,7 @@ void TimelineWidget::mouseMoveEvent(QMouseEvent* e) {
 
     // --- Overlay clip drag: move / trim on its lane ---
     if (overlayDrag != OvNone && overlayDragIdx >= 0 && overlayDragIdx < overlays.size()) {
-        auto &ov = overlays[overlayDragIdx];
+        OverlayClip ov = overlays[overlayDragIdx];
         const qint64 mouseTime = qBound<qint64>(0, static_cast<qint64>(drawX / pxPerMs), durationMs);
         const qint64 minLen = 150;
 
@@ -169,7 +174,10 @@ void TimelineWidget::mouseMoveEvent(QMouseEvent* e) {
         } else if (overlayDrag == OvEnd) {
             ov.endMs = qBound<qint64>(ov.startMs + minLen, snappedTime(mouseTime, pxPerMs), durationMs);
         }
-        update();
+        const int lanesBefore = ensureOverlayIndex().laneCount();
+        model->setOverlay(overlayDragIdx, ov, TimelineModel::Timing);
+        if (overlayLaneCount() != lanesBefore) relayout();
+        else update();
         emit overlaysChanged();
         return;
     }
@@ -192,10 +200,14 @@ void TimelineWidget::mouseMoveEvent(QMouseEvent* e) {
         const int selStart = qMin(selectionRect.left(), selectionRect.right()) - sidebarWidth + scrollOffset;
         const int selEnd = qMax(selectionRect.left(), selectionRect.right()) - sidebarWidth + scrollOffset;
 
-        for (int i = 0; i < static_cast<int>(segments.size()); ++i) {
-            const int clipLeft = segments[i].startMs * pxPerMs;
+        // Only segments around the band's time span can intersect it.
+        const SegmentIndex &index = ensureSegmentIndex();
+        const int first = index.firstEndAtOrAfter(static_cast<qint64>(selStart / pxPerMs) - 1);
+        const int last = index.firstStartAfter(static_cast<qint64>(std::ceil((selEnd + 1) / pxPerMs)));
+        for (int i = first; i < last; ++i) {
+            const int clipLeft = index.startAt(i) * pxPerMs;
 
-            if (const int clipRight = segments[i].endMs * pxPerMs; clipRight > selStart && clipLeft < selEnd) {
+            if (const int clipRight = index.endAt(i) * pxPerMs; clipRight > selStart && clipLeft < selEnd) {
                 if (e->modifiers() & Qt::ControlModifier) {
                     if (preSelectSnapshot.contains(i)) currentBatch.remove(i);
                     else currentBatch.insert(i);
@@ -221,7 +233,7 @@ void TimelineWidget::mouseMoveEvent(QMouseEvent* e) {
             currentPosMs = qBound(0LL, static_cast<qint64>((relativeX / static_cast<double>(contentWidth)) * durationMs), durationMs);
             emitVisualStateForCurrentContext();
             emit playheadMoved(currentPosMs);
-            update();
+            updatePlayhead();
             return;
         }
     }
@@ -233,16 +245,8 @@ void TimelineWidget::mouseMoveEvent(QMouseEvent* e) {
         if (isModKeyPressed) {
             setCursor(Qt::ArrowCursor);
         } else {
-            bool onEdge = false;
-            for (const auto& seg : segments) {
-                if (std::abs(drawX - static_cast<int>(seg.startMs * pxPerMs)) < 12 ||
-                    std::abs(drawX - static_cast<int>(seg.endMs * pxPerMs)) < 12) {
-                    onEdge = true;
-                    break;
-                    }
-            }
-
-            if (onEdge) {
+            bool isStartEdge = false;
+            if (segmentEdgeAt(drawX, pxPerMs, &isStartEdge) != -1) {
                 setCursor(Qt::SizeHorCursor);
             } else if (std::abs(drawX - static_cast<int>(currentPosMs * pxPerMs)) < 10) {
                 setCursor(Qt::SplitHCursor);
@@ -256,22 +260,23 @@ void TimelineWidget::mouseMoveEvent(QMouseEvent* e) {
     if (activeEdge != None && activeSegmentIdx != -1) {
         const qint64 newTime = snappedTime(qBound(0LL, static_cast<qint64>(drawX / pxPerMs), durationMs), pxPerMs);
         const qint64 minSegmentDuration = playbackSettings.minSegmentDurationMs;
+        Segment seg = segments[activeSegmentIdx];
         if (activeEdge == Start) {
             const qint64 minStart = (activeSegmentIdx > 0) ? segments[activeSegmentIdx-1].endMs : 0;
-            segments[activeSegmentIdx].startMs = qBound(minStart, newTime, segments[activeSegmentIdx].endMs - minSegmentDuration);
+            seg.startMs = qBound(minStart, newTime, seg.endMs - minSegmentDuration);
         } else {
             const qint64 maxEnd = (activeSegmentIdx < segments.size() - 1) ? segments[activeSegmentIdx+1].startMs : durationMs;
-            segments[activeSegmentIdx].endMs = qBound(segments[activeSegmentIdx].startMs + minSegmentDuration, newTime, maxEnd);
+            seg.endMs = qBound(seg.startMs + minSegmentDuration, newTime, maxEnd);
         }
+        model->setSegment(activeSegmentIdx, seg, TimelineModel::Timing);
         update();
     }
     else if (isScrubbing && (e->buttons() & Qt::LeftButton)) {
         currentPosMs = qBound(0LL, static_cast<qint64>(drawX / pxPerMs), durationMs);
         validatePlayheadPosition();
         emitVisualStateForCurrentContext();
-        updateEditorVolume();
         emit playheadMoved(currentPosMs);
-        update();
+        updatePlayhead();
     }
 }
 
@@ -295,6 +300,7 @@ void TimelineWidget::mouseReleaseEvent(QMouseEvent* e) {
     activeEdge = None;
     activeSegmentIdx = -1;
     isScrubbing = false;
+    snapTargets.clear();
     unsetCursor();
 }
 
@@ -308,13 +314,7 @@ void TimelineWidget::wheelEvent(QWheelEvent *e) {
         const qint64 hoverTime = static_cast<qint64>(drawX / pxPerMs);
 
         QSet<int> targets;
-        int hoveredIdx = -1;
-        for (int i = 0; i < segments.size(); ++i) {
-            if (hoverTime >= segments[i].startMs && hoverTime <= segments[i].endMs) {
-                hoveredIdx = i;
-                break;
-            }
-        }
+        const int hoveredIdx = segmentIndexAtTime(hoverTime);
 
         if (hoveredIdx != -1) {
             if (selectedSegmentIndices.contains(hoveredIdx)) {
@@ -326,10 +326,12 @@ void TimelineWidget::wheelEvent(QWheelEvent *e) {
 
         float delta = (e->angleDelta().y() > 0 ? 0.1f : -0.1f);
         for (int idx : targets) {
-            segments[idx].gain = qBound(0.0f, segments[idx].gain + delta, 5.0f);
+            Segment seg = segments[idx];
+            seg.gain = qBound(0.0f, seg.gain + delta, 5.0f);
+            model->setSegment(idx, seg, TimelineModel::Audio);
         }
 
-        if(!targets.isEmpty()) emit audioGainChanged(audioGain); updateEditorVolume(); update();
+        if(!targets.isEmpty()) emit audioGainChanged(audioGain); update();
 
     } else if (e->modifiers() & Qt::ControlModifier) {
         double oldZoom = zoomFactor;
@@ -346,7 +348,9 @@ void TimelineWidget::wheelEvent(QWheelEvent *e) {
         return;
     }
     scrollOffset = qBound(0, scrollOffset, qMax(0, static_cast<int>(viewWidth * zoomFactor) - viewWidth));
+    // A pan only moves the tiles; a zoom retires them through the geometry.
     update();
+    scheduleThumbnails();
 }
 
 void TimelineWidget::leaveEvent(QEvent *event) {
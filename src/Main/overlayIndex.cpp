@@ -0,0 +1,200 @@
+#include "../Includes/overlayIndex.h"
+
+#include <algorithm>
+
+bool OverlayIndex::before(int a, qint64 start, int id) const {
+    const Node &n = m_nodes[a];
+    return n.start < start || (n.start == start && n.id < id);
+}
+
+void OverlayIndex::pull(int t) {
+    Node &n = m_nodes[t];
+    n.maxEnd = n.end;
+    if (n.left >= 0) n.maxEnd = std::max(n.maxEnd, m_nodes[n.left].maxEnd);
+    if (n.right >= 0) n.maxEnd = std::max(n.maxEnd, m_nodes[n.right].maxEnd);
+}
+
+// l gets the keys before (start, id), r the rest.
+void OverlayIndex::split(int t, qint64 start, int id, int &l, int &r) {
+    if (t < 0) {
+        l = r = -1;
+        return;
+    }
+    if (before(t, start, id)) {
+        split(m_nodes[t].right, start, id, m_nodes[t].right, r);
+        l = t;
+    } else {
+        split(m_nodes[t].left, start, id, l, m_nodes[t].left);
+        r = t;
+    }
+    pull(t);
+}
+
+int OverlayIndex::merge(int l, int r) {
+    if (l < 0) return r;
+    if (r < 0) return l;
+    if (m_nodes[l].priority > m_nodes[r].priority) {
+        m_nodes[l].right = merge(m_nodes[l].right, r);
+        pull(l);
+        return l;
+    }
+    m_nodes[r].left = merge(l, m_nodes[r].left);
+    pull(r);
+    return r;
+}
+
+int OverlayIndex::erase(int t, qint64 start, int id) {
+    if (t < 0) return -1;
+    if (m_nodes[t].id == id) return merge(m_nodes[t].left, m_nodes[t].right);
+    if (before(t, start, id)) m_nodes[t].right = erase(m_nodes[t].right, start, id);
+    else m_nodes[t].left = erase(m_nodes[t].left, start, id);
+    pull(t);
+    return t;
+}
+
+int OverlayIndex::newNode(int id, qint64 start, qint64 end) {
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    const Node node{start, end, end, id, m_seed, -1, -1};
+    if (!m_freeNodes.empty()) {
+        const int slot = m_freeNodes.back();
+        m_freeNodes.pop_back();
+        m_nodes[slot] = node;
+        return slot;
+    }
+    m_nodes.push_back(node);
+    return int(m_nodes.size()) - 1;
+}
+
+void OverlayIndex::link(int node) {
+    int l, r;
+    split(m_root, m_nodes[node].start, m_nodes[node].id, l, r);
+    m_root = merge(merge(l, node), r);
+}
+
+void OverlayIndex::unlink(int id) {
+    const int node = m_nodeOf[id];
+    m_root = erase(m_root, m_nodes[node].start, id);
+    m_nodes[node].left = m_nodes[node].right = -1;
+}
+
+void OverlayIndex::collect(int t, qint64 from, qint64 to, bool endInclusive, QList<int> &out) const {
+    if (t < 0) return;
+    const Node &n = m_nodes[t];
+    if (endInclusive ? n.maxEnd < from : n.maxEnd <= from) return;
+    collect(n.left, from, to, endInclusive, out);
+    if (n.start > to) return;
+    if (endInclusive ? n.end >= from : n.end > from) out.append(n.id);
+    collect(n.right, from, to, endInclusive, out);
+}
+
+QList<int> OverlayIndex::at(qint64 timeMs) const {
+    QList<int> ids;
+    collect(m_root, timeMs, timeMs, false, ids);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+QList<int> OverlayIndex::touching(qint64 fromMs, qint64 toMs) const {
+    QList<int> ids;
+    collect(m_root, fromMs, toMs, true, ids);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+// Lanes holding a clip that overlaps [startMs, endMs), `self` aside. One
+// longer than laneCount(), so there is always a free entry.
+QVector<bool> OverlayIndex::lanesUsed(int self, qint64 startMs, qint64 endMs) const {
+    QVector<bool> used(laneCount() + 1, false);
+    QList<int> hits;
+    collect(m_root, startMs, endMs - 1, false, hits);
+    for (int id : hits) {
+        if (id != self && m_lanes[id] >= 0) used[m_lanes[id]] = true;
+    }
+    return used;
+}
+
+// Moves `id` to `lane` (-1: none) and closes up the lane it leaves if
+// that one is now empty.
+void OverlayIndex::setLane(int id, int lane) {
+    const int old = m_lanes[id];
+    if (old == lane) return;
+    if (lane >= 0) {
+        if (m_laneLoad.size() <= lane) m_laneLoad.resize(lane + 1, 0);
+        ++m_laneLoad[lane];
+    }
+    m_lanes[id] = lane;
+    if (old < 0 || --m_laneLoad[old] > 0) return;
+    m_laneLoad.removeAt(old);
+    for (int &l : m_lanes) {
+        if (l > old) --l;
+    }
+}
+
+void OverlayIndex::rebuild(const QVector<Span> &spans) {
+    const int count = int(spans.size());
+    m_nodes.clear();
+    m_freeNodes.clear();
+    m_root = -1;
+    m_nodeOf.fill(-1, count);
+    m_lanes.fill(0, count);
+    m_laneLoad.clear();
+
+    QVector<int> order(count);
+    for (int i = 0; i < count; ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&spans](int a, int b) {
+        return spans[a].startMs < spans[b].startMs;
+    });
+
+    QVector<qint64> laneEnds;
+    m_nodes.reserve(count);
+    for (int id : order) {
+        int lane = 0;
+        while (lane < laneEnds.size() && spans[id].startMs < laneEnds[lane]) ++lane;
+        if (lane == laneEnds.size()) {
+            laneEnds.append(0);
+            m_laneLoad.append(0);
+        }
+        laneEnds[lane] = spans[id].endMs;
+        ++m_laneLoad[lane];
+        m_lanes[id] = lane;
+
+        m_nodeOf[id] = newNode(id, spans[id].startMs, spans[id].endMs);
+        link(m_nodeOf[id]);
+    }
+}
+
+void OverlayIndex::insert(int id, qint64 startMs, qint64 endMs) {
+    id = qBound(0, id, size());
+    for (int i = id; i < size(); ++i) ++m_nodes[m_nodeOf[i]].id;
+    m_nodeOf.insert(id, newNode(id, startMs, endMs));
+    m_lanes.insert(id, -1);
+    link(m_nodeOf[id]);
+
+    const QVector<bool> used = lanesUsed(id, startMs, endMs);
+    setLane(id, int(std::find(used.cbegin(), used.cend(), false) - used.cbegin()));
+}
+
+void OverlayIndex::remove(int id) {
+    if (id < 0 || id >= size()) return;
+    unlink(id);
+    m_freeNodes.push_back(m_nodeOf[id]);
+    setLane(id, -1);
+    m_nodeOf.removeAt(id);
+    m_lanes.removeAt(id);
+    for (int i = id; i < size(); ++i) --m_nodes[m_nodeOf[i]].id;
+}
+
+void OverlayIndex::move(int id, qint64 startMs, qint64 endMs) {
+    if (id < 0 || id >= size()) return;
+    Node &node = m_nodes[m_nodeOf[id]];
+    if (node.start == startMs && node.end == endMs) return;
+    unlink(id);
+    node.start = startMs;
+    node.end = node.maxEnd = endMs;
+    link(m_nodeOf[id]);
+
+    const QVector<bool> used = lanesUsed(id, startMs, endMs);
+    if (used[m_lanes[id]]) setLane(id, int(std::find(used.cbegin(), used.cend(), false) - used.cbegin()));
+}
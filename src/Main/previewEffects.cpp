@@ -0,0 +1,469 @@
+#include "../Includes/previewEffects.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PREVIEW_FX_SSE2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define PREVIEW_FX_TARGET_AVX2
+#else
+#define PREVIEW_FX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace PreviewEffects {
+
+namespace {
+
+// Fixed-point BT.601 luma weights (sum to 256) — the same split ffmpeg's
+// rgb->yuv path uses, so "luma" means the same thing on both sides.
+constexpr int kWeightR = 77;
+constexpr int kWeightG = 150;
+constexpr int kWeightB = 29;
+
+// Saturation is applied as mulhi((c - y) << 7, sat * 512): 16-bit lanes,
+// no 32-bit multiply needed, so plain SSE2 can do it.
+constexpr int kSatShift = 7;
+constexpr int kSatOne = 1 << (16 - kSatShift);
+
+inline int lumaOf(int r, int g, int b) {
+    return (kWeightR * r + kWeightG * g + kWeightB * b + 128) >> 8;
+}
+
+inline int saturate(int luma, int mapped, int channel, int satQ) {
+    const int c = mapped + ((channel - luma) * (1 << kSatShift) * satQ >> 16);
+    return c < 0 ? 0 : (c > 255 ? 255 : c);
+}
+
+void colorCorrectScalar(quint32 *px, int count, const quint8 *lut, int satQ) {
+    for (int i = 0; i < count; ++i) {
+        const quint32 p = px[i];
+        const int r = (p >> 16) & 0xFF, g = (p >> 8) & 0xFF, b = p & 0xFF;
+        const int y = lumaOf(r, g, b);
+        const int ly = lut[y];
+        px[i] = (p & 0xFF000000u)
+              | (quint32(saturate(y, ly, r, satQ)) << 16)
+              | (quint32(saturate(y, ly, g, satQ)) << 8)
+              | quint32(saturate(y, ly, b, satQ));
+    }
+}
+
+#ifdef PREVIEW_FX_SSE2
+// 8 pixels per iteration: two 4-pixel loads packed down to 16-bit channel
+// planes, luma computed in-register, table lookup through a small stack
+// buffer (SSE2 has no gather), then the saturation multiply and repack.
+void colorCorrectSse2(quint32 *px, int count, const quint8 *lut, int satQ) {
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i wR = _mm_set1_epi16(kWeightR);
+    const __m128i wG = _mm_set1_epi16(kWeightG);
+    const __m128i wB = _mm_set1_epi16(kWeightB);
+    const __m128i half = _mm_set1_epi16(128);
+    const __m128i sat = _mm_set1_epi16(static_cast<short>(satQ));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i maxC = _mm_set1_epi16(255);
+    alignas(16) quint16 yBuf[8];
+    alignas(16) quint16 lBuf[8];
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(px + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(px + i + 4));
+        const __m128i R = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(a, 16), mask), _mm_and_si128(_mm_srli_epi32(b, 16), mask));
+        const __m128i G = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(a, 8), mask), _mm_and_si128(_mm_srli_epi32(b, 8), mask));
+        const __m128i B = _mm_packs_epi32(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+        const __m128i A = _mm_packs_epi32(_mm_srli_epi32(a, 24), _mm_srli_epi32(b, 24));
+
+        // 77R+150G+29B+128 tops out at 65408: wraps as int16 but is exact
+        // as uint16, and the logical shift reads it back unsigned.
+        __m128i Y = _mm_add_epi16(_mm_mullo_epi16(R, wR), _mm_mullo_epi16(G, wG));
+        Y = _mm_add_epi16(Y, _mm_mullo_epi16(B, wB));
+        Y = _mm_srli_epi16(_mm_add_epi16(Y, half), 8);
+
+        _mm_store_si128(reinterpret_cast<__m128i *>(yBuf), Y);
+        for (int k = 0; k < 8; ++k) lBuf[k] = lut[yBuf[k]];
+        const __m128i L = _mm_load_si128(reinterpret_cast<const __m128i *>(lBuf));
+
+        auto adjust = [&](__m128i c) {
+            const __m128i d = _mm_slli_epi16(_mm_sub_epi16(c, Y), kSatShift);
+            const __m128i v = _mm_add_epi16(L, _mm_mulhi_epi16(d, sat));
+            return _mm_min_epi16(_mm_max_epi16(v, zero), maxC);
+        };
+        const __m128i lo = _mm_or_si128(adjust(B), _mm_slli_epi16(adjust(G), 8));
+        const __m128i hi = _mm_or_si128(adjust(R), _mm_slli_epi16(A, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(px + i), _mm_unpacklo_epi16(lo, hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(px + i + 4), _mm_unpackhi_epi16(lo, hi));
+    }
+    colorCorrectScalar(px + i, count - i, lut, satQ);
+}
+
+// Lambdas don't inherit the target attribute under GCC, so the per-channel
+// step of the AVX2 kernel is a named helper instead.
+PREVIEW_FX_TARGET_AVX2
+inline __m256i saturateAvx2(__m256i c, __m256i y, __m256i mapped, __m256i sat, __m256i zero, __m256i maxC) {
+    const __m256i d = _mm256_slli_epi16(_mm256_sub_epi16(c, y), kSatShift);
+    const __m256i v = _mm256_add_epi16(mapped, _mm256_mulhi_epi16(d, sat));
+    return _mm256_min_epi16(_mm256_max_epi16(v, zero), maxC);
+}
+
+// Same math as the SSE2 path over 16 pixels. The 256-bit pack/unpack ops
+// work per 128-bit lane, but they are applied symmetrically (pack on the
+// way in, unpack on the way out) so pixel order round-trips unchanged.
+PREVIEW_FX_TARGET_AVX2
+void colorCorrectAvx2(quint32 *px, int count, const quint8 *lut, int satQ) {
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    const __m256i wR = _mm256_set1_epi16(kWeightR);
+    const __m256i wG = _mm256_set1_epi16(kWeightG);
+    const __m256i wB = _mm256_set1_epi16(kWeightB);
+    const __m256i half = _mm256_set1_epi16(128);
+    const __m256i sat = _mm256_set1_epi16(static_cast<short>(satQ));
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i maxC = _mm256_set1_epi16(255);
+    alignas(32) quint16 yBuf[16];
+    alignas(32) quint16 lBuf[16];
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(px + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(px + i + 8));
+        const __m256i R = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(a, 16), mask), _mm256_and_si256(_mm256_srli_epi32(b, 16), mask));
+        const __m256i G = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(a, 8), mask), _mm256_and_si256(_mm256_srli_epi32(b, 8), mask));
+        const __m256i B = _mm256_packs_epi32(_mm256_and_si256(a, mask), _mm256_and_si256(b, mask));
+        const __m256i A = _mm256_packs_epi32(_mm256_srli_epi32(a, 24), _mm256_srli_epi32(b, 24));
+
+        __m256i Y = _mm256_add_epi16(_mm256_mullo_epi16(R, wR), _mm256_mullo_epi16(G, wG));
+        Y = _mm256_add_epi16(Y, _mm256_mullo_epi16(B, wB));
+        Y = _mm256_srli_epi16(_mm256_add_epi16(Y, half), 8);
+
+        _mm256_store_si256(reinterpret_cast<__m256i *>(yBuf), Y);
+        for (int k = 0; k < 16; ++k) lBuf[k] = lut[yBuf[k]];
+        const __m256i L = _mm256_load_si256(reinterpret_cast<const __m256i *>(lBuf));
+
+        const __m256i lo = _mm256_or_si256(saturateAvx2(B, Y, L, sat, zero, maxC),
+                                           _mm256_slli_epi16(saturateAvx2(G, Y, L, sat, zero, maxC), 8));
+        const __m256i hi = _mm256_or_si256(saturateAvx2(R, Y, L, sat, zero, maxC), _mm256_slli_epi16(A, 8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(px + i), _mm256_unpacklo_epi16(lo, hi));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(px + i + 8), _mm256_unpackhi_epi16(lo, hi));
+    }
+    colorCorrectSse2(px + i, count - i, lut, satQ);
+}
+
+bool detectAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4] = {};
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+bool hasAvx2() {
+    static const bool supported = detectAvx2();
+    return supported;
+}
+#endif
+
+void colorCorrectRow(quint32 *px, int count, const quint8 *lut, int satQ) {
+#ifdef PREVIEW_FX_SSE2
+    if (hasAvx2()) colorCorrectAvx2(px, count, lut, satQ);
+    else colorCorrectSse2(px, count, lut, satQ);
+#else
+    colorCorrectScalar(px, count, lut, satQ);
+#endif
+}
+
+// --- Box blur ---------------------------------------------------------------
+// Each pixel's four channels are carried as four int32 running sums, so one
+// SSE2 register holds a whole pixel's window sum; the division by the window
+// length is a float multiply shared by both paths (cvtps and lrintf round
+// the same way, keeping the scalar fallback bit-identical).
+
+// boxblur's edge rule: index -k reads k-1, index n+k reads n-1-k.
+inline int mirrorIndex(int i, int n) {
+    return i < 0 ? -i - 1 : (i >= n ? 2 * n - i - 1 : i);
+}
+
+#ifdef PREVIEW_FX_SSE2
+inline __m128i widenPixel(quint32 p) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(p)), zero);
+    return _mm_unpacklo_epi16(v, zero);
+}
+
+inline quint32 narrowPixel(__m128i sum, __m128 inv) {
+    __m128i q = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(sum), inv));
+    q = _mm_packs_epi32(q, q);
+    return static_cast<quint32>(_mm_cvtsi128_si32(_mm_packus_epi16(q, q)));
+}
+
+void blurLine(const quint32 *src, quint32 *dst, int n, int stride, int radius) {
+    const __m128 inv = _mm_set1_ps(1.0f / (2 * radius + 1));
+    __m128i sum = widenPixel(src[radius * stride]);
+    for (int x = 0; x < radius; ++x) {
+        const __m128i v = widenPixel(src[x * stride]);
+        sum = _mm_add_epi32(sum, _mm_add_epi32(v, v));
+    }
+    for (int x = 0; x < n; ++x) {
+        sum = _mm_add_epi32(sum, widenPixel(src[mirrorIndex(x + radius, n) * stride]));
+        sum = _mm_sub_epi32(sum, widenPixel(src[mirrorIndex(x - radius - 1, n) * stride]));
+        dst[x * stride] = narrowPixel(sum, inv);
+    }
+}
+
+// Vertical pass, vectorized across the row: `sums` holds 4 int32 per pixel.
+void addRow(qint32 *sums, const quint32 *row, int n, int factor) {
+    for (int x = 0; x < n; ++x) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sums + 4 * x));
+        __m128i v = widenPixel(row[x]);
+        if (factor == 2) v = _mm_add_epi32(v, v);
+        else if (factor == -1) v = _mm_sub_epi32(_mm_setzero_si128(), v);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(sums + 4 * x), _mm_add_epi32(s, v));
+    }
+}
+
+void slideRow(qint32 *sums, const quint32 *in, const quint32 *out, quint32 *dst, int n, float inv) {
+    const __m128 invV = _mm_set1_ps(inv);
+    for (int x = 0; x < n; ++x) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sums + 4 * x));
+        s = _mm_sub_epi32(_mm_add_epi32(s, widenPixel(in[x])), widenPixel(out[x]));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(sums + 4 * x), s);
+        dst[x] = narrowPixel(s, invV);
+    }
+}
+#else
+inline quint32 narrowSums(const qint32 *s, float inv) {
+    quint32 p = 0;
+    for (int c = 0; c < 4; ++c) {
+        const long v = std::lrintf(static_cast<float>(s[c]) * inv);
+        p |= static_cast<quint32>(v < 0 ? 0 : (v > 255 ? 255 : v)) << (8 * c);
+    }
+    return p;
+}
+
+void blurLine(const quint32 *src, quint32 *dst, int n, int stride, int radius) {
+    const float inv = 1.0f / (2 * radius + 1);
+    qint32 sum[4];
+    for (int c = 0; c < 4; ++c) sum[c] = (src[radius * stride] >> (8 * c)) & 0xFF;
+    for (int x = 0; x < radius; ++x) {
+        for (int c = 0; c < 4; ++c) sum[c] += 2 * ((src[x * stride] >> (8 * c)) & 0xFF);
+    }
+    for (int x = 0; x < n; ++x) {
+        const quint32 in = src[mirrorIndex(x + radius, n) * stride];
+        const quint32 out = src[mirrorIndex(x - radius - 1, n) * stride];
+        for (int c = 0; c < 4; ++c) sum[c] += int((in >> (8 * c)) & 0xFF) - int((out >> (8 * c)) & 0xFF);
+        dst[x * stride] = narrowSums(sum, inv);
+    }
+}
+
+void addRow(qint32 *sums, const quint32 *row, int n, int factor) {
+    for (int x = 0; x < n; ++x) {
+        for (int c = 0; c < 4; ++c) sums[4 * x + c] += factor * int((row[x] >> (8 * c)) & 0xFF);
+    }
+}
+
+void slideRow(qint32 *sums, const quint32 *in, const quint32 *out, quint32 *dst, int n, float inv) {
+    for (int x = 0; x < n; ++x) {
+        for (int c = 0; c < 4; ++c) {
+            sums[4 * x + c] += int((in[x] >> (8 * c)) & 0xFF) - int((out[x] >> (8 * c)) & 0xFF);
+        }
+        dst[x] = narrowSums(sums + 4 * x, inv);
+    }
+}
+#endif
+
+template <typename T>
+T *scratch(std::vector<T> &buf, size_t n) {
+    if (buf.size() < n) buf.resize(n);
+    return buf.data();
+}
+
+}
+
+QImage overlayImage(const QString &path) {
+    // Decoded sources are large next to the sprites made from them; a few
+    // logos fit, a folder of photos cycles.
+    static constexpr int kDecodedCacheKiB = 64 * 1024;
+    static QMutex mutex;
+    static QCache<QString, QImage> decoded(kDecodedCacheKiB);
+
+    // Keyed by modification time too, so a file replaced under the same name
+    // is decoded again. Failures are cached as null images: a missing or
+    // unreadable file isn't re-read on every composite.
+    const QString key = path + QLatin1Char('\n')
+        + QString::number(QFileInfo(path).lastModified().toMSecsSinceEpoch());
+
+    QMutexLocker lock(&mutex);
+    if (const QImage *hit = decoded.object(key)) return *hit;
+    lock.unlock();
+
+    QImageReader reader(path);
+    reader.setAutoTransform(true);
+    QImage image = reader.read();
+    if (!image.isNull()) image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    lock.relock();
+    decoded.insert(key, new QImage(image), qMax<qsizetype>(1, image.sizeInBytes() / 1024));
+    return image;
+}
+
+bool isKernelFormat(const QImage &img) {
+    const QImage::Format f = img.format();
+    return f == QImage::Format_RGB32 || f == QImage::Format_ARGB32 || f == QImage::Format_ARGB32_Premultiplied;
+}
+
+const ColorLut &ColorLutCache::lookup(float brightness, float contrast) {
+    const int bKey = qRound(brightness * 1000.0f);
+    const int cKey = qRound(contrast * 1000.0f);
+    ++m_clock;
+
+    for (int i = 0; i < m_used; ++i) {
+        if (m_slots[i].brightnessKey == bKey && m_slots[i].contrastKey == cKey) {
+            m_slots[i].lastUsed = m_clock;
+            return m_slots[i];
+        }
+    }
+
+    int slot = m_used;
+    if (m_used < kSlots) {
+        ++m_used;
+    } else {
+        slot = 0;
+        for (int i = 1; i < kSlots; ++i) {
+            if (m_slots[i].lastUsed < m_slots[slot].lastUsed) slot = i;
+        }
+    }
+
+    // Same construction as libavfilter/vf_eq.c create_lut() with gamma 1.
+    ColorLut &lut = m_slots[slot];
+    lut.brightnessKey = bKey;
+    lut.contrastKey = cKey;
+    lut.lastUsed = m_clock;
+    const double b = bKey / 1000.0;
+    const double c = cKey / 1000.0;
+    for (int i = 0; i < 256; ++i) {
+        const double v = c * (i / 255.0 - 0.5) + 0.5 + b;
+        lut.table[i] = v <= 0.0 ? 0 : (v >= 1.0 ? 255 : static_cast<quint8>(256.0 * v));
+    }
+    return lut;
+}
+
+void applyColorCorrection(QImage &img, const QRect &area, float brightness, float contrast, float saturation,
+                          Workspace &ws) {
+    if (qFuzzyIsNull(brightness) && qFuzzyCompare(contrast, 1.0f) && qFuzzyCompare(saturation, 1.0f)) return;
+    if (!isKernelFormat(img)) return;
+    const QRect r = area.intersected(img.rect());
+    if (r.isEmpty()) return;
+
+    const quint8 *lut = ws.colorLuts.lookup(brightness, contrast).table.data();
+    const int satQ = qBound(0, qRound(saturation * kSatOne), 4 * kSatOne);
+    for (int y = r.top(); y <= r.bottom(); ++y) {
+        auto *line = reinterpret_cast<quint32 *>(img.scanLine(y)) + r.left();
+        colorCorrectRow(line, r.width(), lut, satQ);
+    }
+}
+
+void boxBlur(QImage &img, const QRect &area, int radius, int power, Workspace &ws) {
+    if (!isKernelFormat(img)) return;
+    const QRect r = area.intersected(img.rect());
+    const int w = r.width(), h = r.height();
+    radius = qMin(radius, qMin(w, h) / 2);
+    if (r.isEmpty() || radius <= 0 || power <= 0) return;
+    const qsizetype stride = img.bytesPerLine() / 4;
+    quint32 *origin = reinterpret_cast<quint32 *>(img.scanLine(r.top())) + r.left();
+
+    // Horizontal: each row ping-pongs between two line buffers `power` times.
+    quint32 *a = scratch(ws.lineA, w);
+    quint32 *b = scratch(ws.lineB, w);
+    for (int y = 0; y < h; ++y) {
+        quint32 *row = origin + y * stride;
+        std::memcpy(a, row, w * sizeof(quint32));
+        for (int p = 0; p < power; ++p) {
+            blurLine(a, b, w, 1, radius);
+            std::swap(a, b);
+        }
+        std::memcpy(row, a, w * sizeof(quint32));
+    }
+
+    // Vertical: a copy of the region feeds a running column-sum row that
+    // slides down one output row at a time (cache-friendly, unlike walking
+    // columns with a stride).
+    quint32 *plane = scratch(ws.plane, size_t(w) * h);
+    qint32 *sums = scratch(ws.sums, size_t(w) * 4);
+    const float inv = 1.0f / (2 * radius + 1);
+    for (int p = 0; p < power; ++p) {
+        for (int y = 0; y < h; ++y) std::memcpy(plane + size_t(y) * w, origin + y * stride, w * sizeof(quint32));
+        std::fill(sums, sums + size_t(w) * 4, 0);
+        addRow(sums, plane + size_t(radius) * w, w, 1);
+        for (int y = 0; y < radius; ++y) addRow(sums, plane + size_t(y) * w, w, 2);
+        for (int y = 0; y < h; ++y) {
+            slideRow(sums,
+                     plane + size_t(mirrorIndex(y + radius, h)) * w,
+                     plane + size_t(mirrorIndex(y - radius - 1, h)) * w,
+                     origin + y * stride, w, inv);
+        }
+    }
+}
+
+void pixelate(QImage &img, const QRect &area, int columns, int rows, Workspace &ws) {
+    if (!isKernelFormat(img)) return;
+    const QRect r = area.intersected(img.rect());
+    if (r.isEmpty()) return;
+    const int w = r.width(), h = r.height();
+    columns = qBound(1, columns, w);
+    rows = qBound(1, rows, h);
+    const qsizetype stride = img.bytesPerLine() / 4;
+    quint32 *origin = reinterpret_cast<quint32 *>(img.scanLine(r.top())) + r.left();
+
+    // Output pixel x samples cell floor((x + 0.5) * columns / w) under a
+    // nearest-neighbor upscale; precompute that mapping once per call.
+    int *cellOf = scratch(ws.cellOfColumn, w);
+    for (int x = 0; x < w; ++x) cellOf[x] = qMin(columns - 1, int((2 * x + 1) * qint64(columns) / (2 * w)));
+    qint32 *sums = scratch(ws.sums, size_t(columns) * 4);
+    quint32 *colors = scratch(ws.cellColors, columns);
+
+    int y0 = 0;
+    for (int cy = 0; cy < rows; ++cy) {
+        int y1 = y0;
+        while (y1 < h && qMin(rows - 1, int((2 * y1 + 1) * qint64(rows) / (2 * h))) == cy) ++y1;
+        if (y1 == y0) continue;
+
+        std::fill(sums, sums + size_t(columns) * 4, 0);
+        for (int y = y0; y < y1; ++y) {
+            const quint32 *row = origin + y * stride;
+            for (int x = 0; x < w; ++x) addRow(sums + 4 * cellOf[x], row + x, 1, 1);
+        }
+
+        int x = 0;
+        while (x < w) {
+            const int cell = cellOf[x];
+            int x1 = x;
+            while (x1 < w && cellOf[x1] == cell) ++x1;
+            const qint64 count = qint64(x1 - x) * (y1 - y0);
+            quint32 p = 0;
+            for (int c = 0; c < 4; ++c) p |= quint32((sums[4 * cell + c] + count / 2) / count) << (8 * c);
+            colors[cell] = p;
+            x = x1;
+        }
+        for (int y = y0; y < y1; ++y) {
+            quint32 *row = origin + y * stride;
+            for (int k = 0; k < w; ++k) row[k] = colors[cellOf[k]];
+        }
+        y0 = y1;
+    }
+}
+
+}
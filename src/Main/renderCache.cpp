@@ -0,0 +1,282 @@
+#include "../Includes/timelinewidget.h"
+#include "../Includes/mediautils.h"
+#include "../Includes/workerPools.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPainter>
+#include <QPointer>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTimer>
+#include <algorithm>
+
+namespace {
+// Relative cost of an overlay to the live compositor, roughly per pixel of
+// its region: blur is several full passes, pixelate and color correction
+// one, text/shapes/images are a sprite blit, a blackout is a fill.
+int overlayRenderCost(int type) {
+    switch (type) {
+        case 0: return 3;
+        case 1: return 2;
+        case 5: return 2;
+        case 3:
+        case 4:
+        case 6: return 1;
+        default: return 0;
+    }
+}
+
+// Stretches at or above this summed cost get a render-cache range, e.g.
+// two blurs, or a blur under a text overlay.
+constexpr int kRenderHeavyCost = 4;
+constexpr qint64 kRenderMinRangeMs = 500;
+constexpr qint64 kRenderCacheBudgetBytes = 2LL * 1024 * 1024 * 1024;
+// Bumped whenever the render graph changes what ends up in the file.
+constexpr int kRenderCacheVersion = 1;
+
+QString renderCacheDir() {
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/render";
+    QDir().mkpath(dir);
+    return dir;
+}
+
+// Times relative to `originMs`.
+void writeOverlay(QDataStream &out, const TimelineWidget::OverlayClip &ov, qint64 startMs, qint64 endMs,
+                  qint64 originMs) {
+    out << ov.type << startMs - originMs << endMs - originMs << ov.l << ov.t << ov.r << ov.b << ov.text
+        << ov.shapeKind << ov.shapeColor.rgba() << ov.shapeThickness
+        << ov.brightness << ov.contrast << ov.saturation << ov.imagePath << ov.opacity
+        << qint32(ov.keyframes.size());
+    for (const auto &key : ov.keyframes) out << key.timeMs - originMs << key.l << key.t;
+}
+
+// Oldest clips go first once the cache outgrows its budget. Returns how
+// many were deleted.
+int pruneRenderCache(const QString &dir) {
+    QFileInfoList files = QDir(dir).entryInfoList({"*.mp4"}, QDir::Files, QDir::Time);
+    qint64 total = 0;
+    int removed = 0;
+    for (const QFileInfo &fi : files) total += fi.size();
+    while (total > kRenderCacheBudgetBytes && !files.isEmpty()) {
+        const QFileInfo oldest = files.takeLast();
+        if (QFile::remove(oldest.absoluteFilePath())) {
+            total -= oldest.size();
+            ++removed;
+        }
+    }
+    return removed;
+}
+}
+
+// Rebuilds renderRanges once something it depends on has changed: the
+// model's segment, overlay and source signals, a new video stream, or a
+// render starting or finishing set renderRangesDirty. The sweep walks the
+// overlay schedule, whose slots already hold the active set between two
+// consecutive overlay boundaries.
+void TimelineWidget::ensureRenderRanges() {
+    if (!renderRangesDirty) return;
+    renderRangesDirty = false;
+
+    ensureOverlaySchedule();
+    QVector<int> slotCost(overlaySlots.size(), 0);
+    for (int s = 0; s < overlaySlots.size(); ++s) {
+        for (int idx : overlaySlots[s]) slotCost[s] += overlayRenderCost(model->overlays()[idx].type);
+    }
+
+    struct Span {
+        RenderRange range;
+        int firstSlot;
+        int lastSlot;
+    };
+    QList<Span> spans;
+    for (const auto &seg : model->segments()) {
+        if (seg.sourceIdx < 0 || seg.sourceIdx >= model->sources().size()) continue;
+        const auto &src = model->sources()[seg.sourceIdx];
+        if (!src.hasVideo || (seg.sourceIdx == 0 && !hasVideoStream)) continue;
+
+        // Slots overlapping the segment, clipped to it; before the first
+        // cut nothing is active.
+        qint64 runStart = -1;
+        int runFirstSlot = 0;
+        auto closeRun = [&](qint64 runEnd, int runLastSlot) {
+            if (runStart >= 0 && runEnd - runStart >= kRenderMinRangeMs) {
+                Span span{RenderRange(), runFirstSlot, runLastSlot};
+                span.range.startMs = runStart;
+                span.range.endMs = runEnd;
+                span.range.sourceIdx = seg.sourceIdx;
+                spans.append(span);
+            }
+            runStart = -1;
+        };
+        for (int s = overlaySlotAt(seg.startMs); s < overlayCuts.size(); ++s) {
+            const qint64 from = s < 0 ? seg.startMs : qMax(overlayCuts[s], seg.startMs);
+            if (from >= seg.endMs) break;
+            if (s >= 0 && slotCost[s] >= kRenderHeavyCost) {
+                if (runStart < 0) {
+                    runStart = from;
+                    runFirstSlot = s;
+                }
+            } else {
+                closeRun(from, s - 1);
+            }
+        }
+        closeRun(seg.endMs, overlaySlotAt(seg.endMs - 1));
+    }
+
+    const QString dir = renderCacheDir();
+    bool anyStale = false;
+    QList<RenderRange> ranges;
+    for (const Span &span : spans) {
+        RenderRange range = span.range;
+        const auto &src = model->sources()[range.sourceIdx];
+        // Every overlay intersecting the range is active in one of its slots.
+        QList<int> touching;
+        for (int s = span.firstSlot; s <= span.lastSlot; ++s) touching += overlaySlots[s];
+        std::sort(touching.begin(), touching.end());
+        touching.erase(std::unique(touching.begin(), touching.end()), touching.end());
+        const QFileInfo srcInfo(src.path);
+        QByteArray keyData;
+        {
+            // Source-local times, so the same material keeps its clip when
+            // the segment around it moves on the timeline.
+            QDataStream out(&keyData, QIODevice::WriteOnly);
+            out << kRenderCacheVersion << renderCacheMaxWidth
+                << srcInfo.absoluteFilePath() << srcInfo.size() << srcInfo.lastModified().toMSecsSinceEpoch()
+                << range.startMs - src.offsetMs << range.endMs - range.startMs;
+            for (int idx : touching) {
+                const auto &ov = model->overlays()[idx];
+                const qint64 a = qMax(ov.startMs, range.startMs);
+                const qint64 b = qMin(ov.endMs, range.endMs);
+                if (b <= a) continue;
+                writeOverlay(out, ov, a, b, range.startMs);
+                // A logo replaced on disk under the same name is new content.
+                if (ov.type == 6) out << QFileInfo(ov.imagePath).lastModified().toMSecsSinceEpoch();
+            }
+        }
+        range.key = QCryptographicHash::hash(keyData, QCryptographicHash::Sha1).toHex();
+        range.cachePath = dir + "/" + QString::fromLatin1(range.key) + ".mp4";
+        if (QFile::exists(range.cachePath)) range.state = RenderRange::Ready;
+        else if (range.key == renderingKey) range.state = RenderRange::Rendering;
+        else if (!failedRenderKeys.contains(range.key)) anyStale = true;
+        ranges.append(range);
+    }
+    renderRanges = ranges;
+
+    if (autoRenderCache && anyStale && renderIdleTimer) renderIdleTimer->start();
+}
+
+const TimelineWidget::RenderRange *TimelineWidget::readyRenderRangeAt(qint64 timeMs) {
+    ensureRenderRanges();
+    // Ranges come out in timeline order, segment by segment.
+    const auto next = std::upper_bound(renderRanges.cbegin(), renderRanges.cend(), timeMs,
+        [](qint64 t, const RenderRange &range) { return t < range.startMs; });
+    if (next == renderRanges.cbegin()) return nullptr;
+    const RenderRange &range = *(next - 1);
+    return (timeMs < range.endMs && range.state == RenderRange::Ready) ? &range : nullptr;
+}
+
+void TimelineWidget::renderStaleRanges() {
+    renderQueueActive = true;
+    startNextRenderJob();
+}
+
+void TimelineWidget::setAutoRenderCache(bool enabled) {
+    autoRenderCache = enabled;
+    if (!enabled && renderIdleTimer) renderIdleTimer->stop();
+    renderRangesDirty = true; // re-evaluate (and arm the idle timer) on next use
+    invalidateScene();
+}
+
+// One ffmpeg at a time; each finished clip starts the next stale range.
+void TimelineWidget::startNextRenderJob() {
+    if (renderProcess || !renderQueueActive) return;
+    ensureRenderRanges();
+    const RenderRange *next = nullptr;
+    for (const auto &range : renderRanges) {
+        if (range.state == RenderRange::Stale && !failedRenderKeys.contains(range.key)) { next = &range; break; }
+    }
+    if (!next) {
+        renderQueueActive = false;
+        return;
+    }
+
+    const QString finalPath = next->cachePath;
+    const QString partPath = finalPath.left(finalPath.size() - 4) + ".part.mp4";
+    const QByteArray key = next->key;
+    const QStringList args = renderCacheArguments(*next, partPath);
+    renderingKey = key;
+    renderRangesDirty = true;
+
+    renderProcess = new QProcess(this);
+    connect(renderProcess, &QProcess::finished, this, [this, key, partPath, finalPath](int exitCode, QProcess::ExitStatus status) {
+        renderProcess->deleteLater();
+        renderProcess = nullptr;
+        renderingKey.clear();
+        renderRangesDirty = true;
+        if (status == QProcess::NormalExit && exitCode == 0 && QFileInfo(partPath).size() > 0) {
+            QFile::remove(finalPath);
+            QFile::rename(partPath, finalPath);
+            const QString dir = QFileInfo(finalPath).absolutePath();
+            QPointer<TimelineWidget> self(this);
+            (void)WorkerPools::run(WorkerPools::FileIO, [self, dir]() {
+                if (pruneRenderCache(dir) == 0) return;
+                // Ranges whose clip was deleted are stale again, not Ready.
+                QMetaObject::invokeMethod(self, [self]() {
+                    if (!self) return;
+                    self->renderRangesDirty = true;
+                    self->invalidateScene();
+                }, Qt::QueuedConnection);
+            });
+        } else {
+            QFile::remove(partPath);
+            // Don't retry a range ffmpeg can't do until its contents change.
+            if (renderQueueActive) failedRenderKeys.insert(key);
+        }
+        invalidateScene();
+        startNextRenderJob();
+    });
+    renderProcess->start(MediaUtils::ffToolPath("ffmpeg"), args);
+    invalidateScene();
+}
+
+void TimelineWidget::clearRenderCache() {
+    renderQueueActive = false;
+    if (renderProcess) {
+        renderProcess->kill();
+        renderProcess->waitForFinished(2000);
+    }
+    const QString dir = renderCacheDir();
+    for (const QFileInfo &fi : QDir(dir).entryInfoList({"*.mp4"}, QDir::Files)) QFile::remove(fi.absoluteFilePath());
+    failedRenderKeys.clear();
+    renderRangesDirty = true;
+    invalidateScene();
+}
+
+void TimelineWidget::discardRenderClip(const QString &cachePath) {
+    QFile::remove(cachePath);
+    failedRenderKeys.insert(QFileInfo(cachePath).completeBaseName().toLatin1());
+    renderRangesDirty = true;
+    invalidateScene();
+}
+
+// Thin strip between the ruler and the overlay lanes: red where a range
+// would play composited live, amber while it renders, green once cached.
+void TimelineWidget::drawRenderBar(QPainter &painter, const QList<RenderRange> &ranges, int top, double pxPerMs) {
+    if (ranges.isEmpty()) return;
+    painter.save();
+    painter.setPen(Qt::NoPen);
+    for (const auto &range : ranges) {
+        switch (range.state) {
+            case RenderRange::Ready:     painter.setBrush(QColor("#3FB68B")); break;
+            case RenderRange::Rendering: painter.setBrush(QColor("#E8B339")); break;
+            default:                     painter.setBrush(QColor("#E5484D")); break;
+        }
+        painter.drawRect(QRectF(range.startMs * pxPerMs, top,
+                                qMax(2.0, (range.endMs - range.startMs) * pxPerMs), 4));
+    }
+    painter.restore();
+}
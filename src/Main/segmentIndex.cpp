@@ -0,0 +1,58 @@
+#include "../Includes/segmentIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+double SegmentIndex::retimedSec(double offsetSec, double durationSec, double speedStart, double speedEnd) {
+    if (qFuzzyCompare(speedStart, speedEnd)) return offsetSec / speedStart;
+    const double k = (speedEnd - speedStart) / qMax(0.001, durationSec);
+    return std::log((speedStart + k * offsetSec) / speedStart) / k;
+}
+
+void SegmentIndex::rebuild(const QVector<Span> &spans) {
+    m_spans = spans;
+    m_starts.resize(spans.size());
+    m_ends.resize(spans.size());
+    m_sourceBefore.resize(spans.size() + 1);
+    m_outputBefore.resize(spans.size() + 1);
+    for (int i = 0; i < spans.size(); ++i) {
+        const Span &s = spans[i];
+        const qint64 length = qMax<qint64>(0, s.endMs - s.startMs);
+        m_starts[i] = s.startMs;
+        m_ends[i] = s.endMs;
+        m_sourceBefore[i + 1] = m_sourceBefore[i] + length;
+        m_outputBefore[i + 1] = m_outputBefore[i]
+            + retimedSec(length / 1000.0, length / 1000.0, s.speedStart, s.speedEnd) * 1000.0;
+    }
+}
+
+int SegmentIndex::firstStartAtOrAfter(qint64 timeMs) const {
+    return int(std::lower_bound(m_starts.cbegin(), m_starts.cend(), timeMs) - m_starts.cbegin());
+}
+
+int SegmentIndex::firstStartAfter(qint64 timeMs) const {
+    return int(std::upper_bound(m_starts.cbegin(), m_starts.cend(), timeMs) - m_starts.cbegin());
+}
+
+int SegmentIndex::firstEndAtOrAfter(qint64 timeMs) const {
+    return int(std::lower_bound(m_ends.cbegin(), m_ends.cend(), timeMs) - m_ends.cbegin());
+}
+
+int SegmentIndex::firstEndAfter(qint64 timeMs) const {
+    return int(std::upper_bound(m_ends.cbegin(), m_ends.cend(), timeMs) - m_ends.cbegin());
+}
+
+int SegmentIndex::indexAt(qint64 timeMs) const {
+    const int i = firstEndAtOrAfter(timeMs);
+    return (i < size() && m_starts[i] <= timeMs) ? i : -1;
+}
+
+qint64 SegmentIndex::outputTimeAt(qint64 timeMs) const {
+    const int i = firstEndAfter(timeMs);
+    if (i >= size()) return outputDurationMs();
+    const Span &s = m_spans[i];
+    if (timeMs <= s.startMs) return qRound64(m_outputBefore[i]);
+    const double length = (s.endMs - s.startMs) / 1000.0;
+    const double offset = (timeMs - s.startMs) / 1000.0;
+    return qRound64(m_outputBefore[i] + retimedSec(offset, length, s.speedStart, s.speedEnd) * 1000.0);
+}
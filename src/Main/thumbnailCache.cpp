@@ -0,0 +1,273 @@
+#include "../Includes/thumbnailCache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QStandardPaths>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr quint32 kMagic = 0x50544842; // "PTHB"
+constexpr quint32 kVersion = 1;
+constexpr quint8 kFrameRecord = 0;
+constexpr quint8 kPassRecord = 1;
+constexpr int kFrameBytes = ThumbnailCache::kWidth * ThumbnailCache::kHeight * 3;
+constexpr qint64 kIdentityBytes = 64 * 1024;
+// A few thousand thumbnails; a multi-hour file at deep zoom stays well inside.
+constexpr qint64 kMemoryBudgetBytes = 64LL * 1024 * 1024;
+constexpr qint64 kDiskBudgetBytes = 512LL * 1024 * 1024;
+
+// Appends and tail repairs on a file mustn't interleave.
+QMutex &diskMutex() {
+    static QMutex mutex;
+    return mutex;
+}
+
+QString thumbnailCacheDir() {
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+    QDir().mkpath(dir);
+    return dir;
+}
+
+void pruneThumbnailCache(const QString &dir) {
+    QFileInfoList files = QDir(dir).entryInfoList({"*.thumbs"}, QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for (const QFileInfo &fi : files) total += fi.size();
+    while (total > kDiskBudgetBytes && !files.isEmpty()) {
+        const QFileInfo oldest = files.takeLast();
+        if (QFile::remove(oldest.absoluteFilePath())) total -= oldest.size();
+    }
+}
+}
+
+QString ThumbnailCache::fileFor(const QString &sourcePath) {
+    QFile source(sourcePath);
+    if (!source.open(QIODevice::ReadOnly)) return {};
+    const qint64 size = source.size();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(size));
+    hash.addData(source.read(kIdentityBytes));
+    if (size > kIdentityBytes && source.seek(qMax(kIdentityBytes, size - kIdentityBytes))) {
+        hash.addData(source.read(kIdentityBytes));
+    }
+    return thumbnailCacheDir() + '/' + QString::fromLatin1(hash.result().toHex().left(24))
+           + QString("-%1x%2.thumbs").arg(kWidth).arg(kHeight);
+}
+
+ThumbnailCache::DiskIndex ThumbnailCache::scan(const QString &file) {
+    DiskIndex index;
+    index.file = file;
+    {
+        QMutexLocker lock(&diskMutex());
+        QFile f(file);
+        if (!f.open(QIODevice::ReadWrite)) return index;
+        QDataStream in(&f);
+        quint32 magic = 0, version = 0;
+        in >> magic >> version;
+        if (in.status() != QDataStream::Ok || magic != kMagic || version != kVersion) {
+            // New, empty or from another format: start it over.
+            f.resize(0);
+            return index;
+        }
+        qint64 validEnd = f.pos();
+        while (!in.atEnd()) {
+            quint8 kind = 0;
+            in >> kind;
+            if (kind == kFrameRecord) {
+                qint64 ms = 0;
+                in >> ms;
+                if (in.skipRawData(kFrameBytes) != kFrameBytes || in.status() != QDataStream::Ok) break;
+                index.offsets.insert(ms, validEnd);
+            } else if (kind == kPassRecord) {
+                Pass pass;
+                in >> pass.fromMs >> pass.toMs >> pass.spacingMs;
+                if (in.status() != QDataStream::Ok) break;
+                index.passes.append(pass);
+            } else {
+                break;
+            }
+            validEnd = f.pos();
+        }
+        if (f.size() > validEnd) f.resize(validEnd);
+        // Opening counts as use for the pruning below.
+        f.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+    pruneThumbnailCache(QFileInfo(file).absolutePath());
+    return index;
+}
+
+QMap<qint64, QImage> ThumbnailCache::load(const QString &file, const QMap<qint64, qint64> &offsets) {
+    QMap<qint64, QImage> frames;
+    QFile f(file);
+    if (!f.open(QIODevice::ReadOnly)) return frames;
+    QDataStream in(&f);
+    for (auto it = offsets.cbegin(); it != offsets.cend(); ++it) {
+        if (!f.seek(it.value())) continue;
+        quint8 kind = 0;
+        qint64 ms = 0;
+        in >> kind >> ms;
+        if (in.status() != QDataStream::Ok || kind != kFrameRecord || ms != it.key()) {
+            in.resetStatus();
+            continue;
+        }
+        QImage image(kWidth, kHeight, QImage::Format_RGB888);
+        bool complete = true;
+        for (int y = 0; y < kHeight && complete; ++y) {
+            complete = in.readRawData(reinterpret_cast<char *>(image.scanLine(y)), kWidth * 3) == kWidth * 3;
+        }
+        if (complete) frames.insert(ms, image);
+        else in.resetStatus();
+    }
+    return frames;
+}
+
+QMap<qint64, qint64> ThumbnailCache::append(const QString &file, const QMap<qint64, QImage> &frames) {
+    QMap<qint64, qint64> offsets;
+    QMutexLocker lock(&diskMutex());
+    QFile f(file);
+    if (!f.open(QIODevice::ReadWrite)) return offsets;
+    QDataStream out(&f);
+    if (f.size() == 0) out << kMagic << kVersion;
+    else f.seek(f.size());
+    for (auto it = frames.cbegin(); it != frames.cend(); ++it) {
+        QImage image = it.value();
+        if (image.format() != QImage::Format_RGB888 || image.size() != QSize(kWidth, kHeight)) {
+            image = image.convertToFormat(QImage::Format_RGB888).scaled(kWidth, kHeight);
+        }
+        const qint64 offset = f.pos();
+        out << kFrameRecord << it.key();
+        for (int y = 0; y < kHeight; ++y) {
+            out.writeRawData(reinterpret_cast<const char *>(image.constScanLine(y)), kWidth * 3);
+        }
+        if (out.status() != QDataStream::Ok) break;
+        offsets.insert(it.key(), offset);
+    }
+    f.flush();
+    return offsets;
+}
+
+void ThumbnailCache::appendPass(const QString &file, const Pass &pass) {
+    QMutexLocker lock(&diskMutex());
+    QFile f(file);
+    if (!f.open(QIODevice::ReadWrite)) return;
+    QDataStream out(&f);
+    if (f.size() == 0) out << kMagic << kVersion;
+    else f.seek(f.size());
+    out << kPassRecord << pass.fromMs << pass.toMs << pass.spacingMs;
+}
+
+bool ThumbnailCache::isAttached(const QString &path) const {
+    const auto it = m_sources.constFind(path);
+    return it != m_sources.constEnd() && it->attached;
+}
+
+void ThumbnailCache::markOpening(const QString &path) {
+    m_sources.insert(path, Source());
+}
+
+void ThumbnailCache::attach(const QString &path, const DiskIndex &index) {
+    Source &source = m_sources[path];
+    source.attached = true;
+    source.file = index.file;
+    source.onDisk = index.offsets;
+}
+
+void ThumbnailCache::insert(const QString &path, const QMap<qint64, QImage> &frames) {
+    QMap<qint64, QImage> &stored = m_frames[path];
+    QMap<qint64, quint64> &lastUse = m_lastUse[path];
+    ++m_clock;
+    for (auto it = frames.cbegin(); it != frames.cend(); ++it) {
+        const auto old = stored.constFind(it.key());
+        if (old != stored.constEnd()) m_bytes -= old->sizeInBytes();
+        stored.insert(it.key(), it.value());
+        lastUse.insert(it.key(), m_clock);
+        m_bytes += it.value().sizeInBytes();
+    }
+    trim();
+}
+
+void ThumbnailCache::addOnDisk(const QString &path, const QMap<qint64, qint64> &offsets) {
+    const auto it = m_sources.find(path);
+    if (it != m_sources.end()) it->onDisk.insert(offsets);
+}
+
+void ThumbnailCache::loaded(const QString &path, const QMap<qint64, qint64> &requested,
+                            const QMap<qint64, QImage> &frames) {
+    const auto it = m_sources.find(path);
+    if (it != m_sources.end()) {
+        for (auto req = requested.cbegin(); req != requested.cend(); ++req) {
+            if (frames.contains(req.key())) continue;
+            it->onDisk.remove(req.key());
+            m_lost[path].append(req.key());
+        }
+    }
+    insert(path, frames);
+}
+
+QMap<qint64, qint64> ThumbnailCache::missing(const QString &path, qint64 fromMs, qint64 toMs, qint64 spacingMs) const {
+    QMap<qint64, qint64> wanted;
+    const auto source = m_sources.constFind(path);
+    if (source == m_sources.constEnd()) return wanted;
+    const QMap<qint64, QImage> stored = m_frames.value(path);
+    qint64 lastKept = std::numeric_limits<qint64>::min() / 2;
+    for (auto it = source->onDisk.lowerBound(fromMs); it != source->onDisk.cend() && it.key() < toMs; ++it) {
+        if (stored.contains(it.key())) {
+            lastKept = it.key();
+        } else if (it.key() - lastKept >= spacingMs) {
+            wanted.insert(it.key(), it.value());
+            lastKept = it.key();
+        }
+    }
+    return wanted;
+}
+
+void ThumbnailCache::touch(const QString &path, qint64 fromMs, qint64 toMs) {
+    const auto it = m_lastUse.find(path);
+    if (it == m_lastUse.end()) return;
+    ++m_clock;
+    for (auto use = it->lowerBound(fromMs); use != it->end() && use.key() < toMs; ++use) use.value() = m_clock;
+}
+
+QHash<QString, QList<qint64>> ThumbnailCache::takeLost() {
+    return std::exchange(m_lost, {});
+}
+
+void ThumbnailCache::clear() {
+    m_sources.clear();
+    m_frames.clear();
+    m_lastUse.clear();
+    m_lost.clear();
+    m_bytes = 0;
+}
+
+// Evicts least recently shown frames down to 3/4 of the budget, so a
+// steady stream of new frames doesn't pay for a sort each.
+void ThumbnailCache::trim() {
+    if (m_bytes <= kMemoryBudgetBytes) return;
+    struct Entry {
+        quint64 lastUse;
+        QString path;
+        qint64 ms;
+    };
+    std::vector<Entry> entries;
+    for (auto path = m_lastUse.cbegin(); path != m_lastUse.cend(); ++path) {
+        for (auto use = path->cbegin(); use != path->cend(); ++use) entries.push_back({use.value(), path.key(), use.key()});
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.lastUse < b.lastUse; });
+    for (const Entry &entry : entries) {
+        if (m_bytes <= kMemoryBudgetBytes / 4 * 3) break;
+        QMap<qint64, QImage> &stored = m_frames[entry.path];
+        m_bytes -= stored.value(entry.ms).sizeInBytes();
+        stored.remove(entry.ms);
+        m_lastUse[entry.path].remove(entry.ms);
+        const auto source = m_sources.constFind(entry.path);
+        if (source == m_sources.constEnd() || !source->onDisk.contains(entry.ms)) m_lost[entry.path].append(entry.ms);
+    }
+}
@@ -0,0 +1,80 @@
+#include "../Includes/timelineModel.h"
+
+void TimelineModel::setSegments(const QList<Segment> &segments) {
+    m_segments = segments;
+    emit segmentsReset();
+}
+
+void TimelineModel::insertSegment(int index, const Segment &segment) {
+    index = qBound(0, index, static_cast<int>(m_segments.size()));
+    m_segments.insert(index, segment);
+    emit segmentsInserted(index, index);
+}
+
+void TimelineModel::removeSegments(int first, int last) {
+    if (first < 0 || last >= m_segments.size() || first > last) return;
+    m_segments.remove(first, last - first + 1);
+    emit segmentsRemoved(first, last);
+}
+
+void TimelineModel::setSources(const QList<SourceClip> &sources) {
+    m_sources = sources;
+    emit sourcesReset();
+}
+
+void TimelineModel::appendSource(const SourceClip &source) {
+    m_sources.append(source);
+    const int index = static_cast<int>(m_sources.size()) - 1;
+    emit sourcesInserted(index, index);
+}
+
+void TimelineModel::setOverlays(const QList<OverlayClip> &overlays) {
+    m_overlays = overlays;
+    emit overlaysReset();
+}
+
+void TimelineModel::insertOverlay(int index, const OverlayClip &overlay) {
+    index = qBound(0, index, static_cast<int>(m_overlays.size()));
+    m_overlays.insert(index, overlay);
+    emit overlaysInserted(index, index);
+}
+
+void TimelineModel::removeOverlays(int first, int last) {
+    if (first < 0 || last >= m_overlays.size() || first > last) return;
+    m_overlays.remove(first, last - first + 1);
+    emit overlaysRemoved(first, last);
+}
+
+void TimelineModel::setMarkers(const QList<qint64> &markers) {
+    m_markers = markers;
+    emit markersChanged();
+}
+
+void TimelineModel::addMarker(qint64 timeMs) {
+    m_markers.insert(std::upper_bound(m_markers.begin(), m_markers.end(), timeMs), timeMs);
+    emit markersChanged();
+}
+
+void TimelineModel::removeMarker(int index) {
+    if (index < 0 || index >= m_markers.size()) return;
+    m_markers.removeAt(index);
+    emit markersChanged();
+}
+
+void TimelineModel::setSegment(int index, const Segment &segment, Fields fields) {
+    if (index < 0 || index >= m_segments.size()) return;
+    m_segments[index] = segment;
+    emit segmentsChanged(index, index, fields);
+}
+
+void TimelineModel::setSource(int index, const SourceClip &source) {
+    if (index < 0 || index >= m_sources.size()) return;
+    m_sources[index] = source;
+    emit sourcesChanged(index, index);
+}
+
+void TimelineModel::setOverlay(int index, const OverlayClip &overlay, Fields fields) {
+    if (index < 0 || index >= m_overlays.size()) return;
+    m_overlays[index] = overlay;
+    emit overlaysChanged(index, index, fields);
+}
@@ -0,0 +1,238 @@
+#include "../Includes/timelinewidget.h"
+#include "../Includes/mediautils.h"
+#include "../Includes/workerPools.h"
+
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QTimer>
+#include <algorithm>
+#include <functional>
+
+namespace {
+// ffmpeg scales and crops to ThumbnailCache's size (the 84x54 slot's
+// aspect, with headroom for high-dpi screens); the GUI thread only wraps.
+constexpr int kThumbWidth = ThumbnailCache::kWidth;
+constexpr int kThumbHeight = ThumbnailCache::kHeight;
+constexpr int kThumbSlotPx = 88; // the tiles' thumbnail pitch
+// Spacing runs up a ladder of 500 ms * 2^k so nearby zoom levels share
+// passes. Keyframes rarely come closer than this anyway.
+constexpr qint64 kMinThumbSpacingMs = 500;
+// Frames reach the timeline (and the disk cache) in batches so the tiles
+// aren't redrawn per frame.
+constexpr qint64 kThumbBatchMs = 250;
+
+qint64 ladderSpacing(double spacingMs) {
+    qint64 spacing = kMinThumbSpacingMs;
+    while (spacing * 2 <= spacingMs) spacing *= 2;
+    return spacing;
+}
+
+// One streaming pass over [fromMs, toMs) of `path`: the decoder skips every
+// frame but keyframes, select keeps one per spacingMs, and the survivors
+// come out of stdout as fixed-size RGB frames. showinfo logs each one's
+// timestamp to stderr in the same order. Each batch is appended to
+// `cacheFile` (if any) before it's delivered. Returns false if cancelled.
+bool extractKeyframes(const QString &path, const QString &cacheFile, qint64 fromMs, qint64 toMs, qint64 spacingMs,
+                      const std::atomic_bool &cancel,
+                      const std::function<void(const QMap<qint64, QImage> &, const QMap<qint64, qint64> &)> &deliver) {
+    QProcess ffmpeg;
+    ffmpeg.start(MediaUtils::ffToolPath("ffmpeg"), {
+        "-hide_banner", "-nostats", "-loglevel", "info",
+        "-skip_frame", "nokey",
+        "-ss", QString::number(fromMs / 1000.0, 'f', 3),
+        "-t", QString::number((toMs - fromMs) / 1000.0, 'f', 3),
+        "-i", path,
+        "-map", "0:v:0", "-an", "-sn", "-dn",
+        "-vf", QString("select=isnan(prev_selected_t)+gte(t-prev_selected_t\\,%1),showinfo,"
+                       "scale=%2:%3:force_original_aspect_ratio=increase,crop=%2:%3")
+                   .arg(spacingMs / 1000.0, 0, 'f', 3).arg(kThumbWidth).arg(kThumbHeight),
+        "-vsync", "0", "-f", "rawvideo", "-pix_fmt", "rgb24", "-"
+    });
+    if (!ffmpeg.waitForStarted(5000)) return true;
+
+    static const QRegularExpression ptsTime("pts_time:(-?[0-9.]+)");
+    const int frameBytes = kThumbWidth * kThumbHeight * 3;
+    QByteArray pending, log;
+    QList<qint64> times; // source ms of frames logged but not read yet
+    QMap<qint64, QImage> batch;
+    QElapsedTimer sinceDelivery;
+    sinceDelivery.start();
+
+    while (!cancel.load()) {
+        const bool ready = ffmpeg.waitForReadyRead(100);
+        pending += ffmpeg.readAllStandardOutput();
+        log += ffmpeg.readAllStandardError();
+        for (int eol = log.indexOf('\n'); eol >= 0; eol = log.indexOf('\n')) {
+            const auto match = ptsTime.match(QString::fromLatin1(log.constData(), eol));
+            if (match.hasMatch()) times.append(fromMs + qRound64(match.captured(1).toDouble() * 1000.0));
+            log.remove(0, eol + 1);
+        }
+        while (pending.size() >= frameBytes && !times.isEmpty()) {
+            const QImage frame(reinterpret_cast<const uchar *>(pending.constData()),
+                               kThumbWidth, kThumbHeight, kThumbWidth * 3, QImage::Format_RGB888);
+            batch.insert(times.takeFirst(), frame.copy());
+            pending.remove(0, frameBytes);
+        }
+        const bool done = !ready && ffmpeg.state() == QProcess::NotRunning;
+        if (!batch.isEmpty() && (done || sinceDelivery.elapsed() >= kThumbBatchMs)) {
+            deliver(batch, cacheFile.isEmpty() ? QMap<qint64, qint64>() : ThumbnailCache::append(cacheFile, batch));
+            batch.clear();
+            sinceDelivery.restart();
+        }
+        if (done) return true;
+    }
+    ffmpeg.kill();
+    ffmpeg.waitForFinished(2000);
+    return false;
+}
+}
+
+void TimelineWidget::scheduleThumbnails() {
+    thumbnailTimer->start();
+}
+
+// Sizes the work to the view: thumbnails one slot apart over the visible
+// range plus half a view either side, per source file. What the disk tier
+// has there is loaded; what finished passes at that spacing or finer
+// haven't covered is extracted. One load and one pass run at a time and
+// each calls back here when it ends, so zooming in keeps refining until
+// the view is covered.
+void TimelineWidget::requestThumbnails() {
+    const int viewWidth = width() - sidebarWidth;
+    if (durationMs <= 0 || viewWidth <= 0) return;
+    const double pxPerMs = static_cast<double>(viewWidth) * zoomFactor / durationMs;
+    const qint64 spacingMs = ladderSpacing(kThumbSlotPx / pxPerMs);
+    const qint64 viewMs = static_cast<qint64>(viewWidth / pxPerMs);
+    const qint64 windowStart = static_cast<qint64>(scrollOffset / pxPerMs) - viewMs / 2;
+    const qint64 windowEnd = windowStart + viewMs * 2;
+
+    QList<ThumbnailCache::Pass> wanted;
+    for (const SourceClip &src : model->sources()) {
+        if (src.path.isEmpty() || src.durationMs <= 0) continue;
+        // Nothing is extracted before the disk tier has had its say.
+        if (!thumbnailCache.isAttached(src.path)) {
+            openThumbnailCache(src.path);
+            continue;
+        }
+        ThumbnailCache::Pass pass{src.path, qMax<qint64>(0, windowStart - src.offsetMs),
+                                  qMin(src.durationMs, windowEnd - src.offsetMs), spacingMs};
+        if (pass.fromMs >= pass.toMs) continue;
+        thumbnailCache.touch(src.path, pass.fromMs, pass.toMs);
+        if (!thumbnailLoadActive) {
+            const QMap<qint64, qint64> onDisk = thumbnailCache.missing(src.path, pass.fromMs, pass.toMs, spacingMs);
+            if (!onDisk.isEmpty()) loadThumbnails(src.path, onDisk);
+        }
+        for (bool trimmed = true; trimmed && pass.fromMs < pass.toMs;) {
+            trimmed = false;
+            for (const ThumbnailCache::Pass &done : thumbnailPasses) {
+                if (done.path != pass.path || done.spacingMs > spacingMs) continue;
+                if (done.fromMs <= pass.fromMs && done.toMs > pass.fromMs) {
+                    pass.fromMs = done.toMs;
+                    trimmed = true;
+                }
+                if (done.toMs >= pass.toMs && done.fromMs < pass.toMs) {
+                    pass.toMs = done.fromMs;
+                    trimmed = true;
+                }
+            }
+        }
+        if (pass.fromMs < pass.toMs) wanted.append(pass);
+    }
+
+    if (thumbnailPassActive) {
+        // Zoomed or panned away from the running pass: stop it early.
+        const ThumbnailCache::Pass &running = thumbnailActivePass;
+        const bool stillWanted = std::any_of(wanted.cbegin(), wanted.cend(), [&running](const ThumbnailCache::Pass &pass) {
+            return pass.path == running.path && pass.fromMs < running.toMs && pass.toMs > running.fromMs;
+        });
+        if (!stillWanted) thumbnailCancel->store(true);
+        return;
+    }
+    if (wanted.isEmpty()) return;
+
+    const ThumbnailCache::Pass pass = wanted.first();
+    const QString cacheFile = thumbnailCache.fileOf(pass.path);
+    thumbnailPassActive = true;
+    thumbnailActivePass = pass;
+    thumbnailCancel = QSharedPointer<std::atomic_bool>::create(false);
+    const QSharedPointer<std::atomic_bool> cancel = thumbnailCancel;
+    const quint64 generation = thumbnailGeneration;
+    QPointer<TimelineWidget> self(this);
+    (void)WorkerPools::run(WorkerPools::Analysis, [self, pass, cacheFile, cancel, generation]() {
+        const bool finished = extractKeyframes(pass.path, cacheFile, pass.fromMs, pass.toMs, pass.spacingMs, *cancel,
+            [self, pass, generation](const QMap<qint64, QImage> &batch, const QMap<qint64, qint64> &offsets) {
+            QMetaObject::invokeMethod(self, [self, pass, generation, batch, offsets]() {
+                if (!self || generation != self->thumbnailGeneration) return;
+                self->thumbnailCache.addOnDisk(pass.path, offsets);
+                self->thumbnailCache.insert(pass.path, batch);
+                self->dropLostThumbnailPasses();
+                self->invalidateScene();
+            }, Qt::QueuedConnection);
+        });
+        if (finished && !cacheFile.isEmpty()) ThumbnailCache::appendPass(cacheFile, pass);
+        QMetaObject::invokeMethod(self, [self, pass, generation, finished]() {
+            if (!self || generation != self->thumbnailGeneration) return;
+            self->thumbnailPassActive = false;
+            if (finished) self->thumbnailPasses.append(pass);
+            self->requestThumbnails();
+        }, Qt::QueuedConnection);
+    });
+}
+
+// Identifies the source's content and indexes its disk cache file. The
+// passes recorded there count as done, so a reopened recording only loads.
+void TimelineWidget::openThumbnailCache(const QString &path) {
+    if (thumbnailCache.isKnown(path)) return;
+    thumbnailCache.markOpening(path);
+    const quint64 generation = thumbnailGeneration;
+    QPointer<TimelineWidget> self(this);
+    (void)WorkerPools::run(WorkerPools::FileIO, [self, path, generation]() {
+        const QString file = ThumbnailCache::fileFor(path);
+        ThumbnailCache::DiskIndex index = file.isEmpty() ? ThumbnailCache::DiskIndex() : ThumbnailCache::scan(file);
+        QMetaObject::invokeMethod(self, [self, path, generation, index]() {
+            if (!self || generation != self->thumbnailGeneration) return;
+            self->thumbnailCache.attach(path, index);
+            for (ThumbnailCache::Pass pass : index.passes) {
+                pass.path = path;
+                self->thumbnailPasses.append(pass);
+            }
+            self->requestThumbnails();
+        }, Qt::QueuedConnection);
+    });
+}
+
+void TimelineWidget::loadThumbnails(const QString &path, const QMap<qint64, qint64> &offsets) {
+    thumbnailLoadActive = true;
+    const QString file = thumbnailCache.fileOf(path);
+    const quint64 generation = thumbnailGeneration;
+    QPointer<TimelineWidget> self(this);
+    (void)WorkerPools::run(WorkerPools::FileIO, [self, path, file, offsets, generation]() {
+        const QMap<qint64, QImage> frames = ThumbnailCache::load(file, offsets);
+        QMetaObject::invokeMethod(self, [self, path, offsets, frames, generation]() {
+            if (!self || generation != self->thumbnailGeneration) return;
+            self->thumbnailLoadActive = false;
+            self->thumbnailCache.loaded(path, offsets, frames);
+            self->dropLostThumbnailPasses();
+            self->invalidateScene();
+            self->requestThumbnails();
+        }, Qt::QueuedConnection);
+    });
+}
+
+// A pass only counts as done while its frames are in one tier or the
+// other. Once any of them is gone from both (evicted with no disk file,
+// or the file pruned under us), the pass goes so the range is extracted
+// again.
+void TimelineWidget::dropLostThumbnailPasses() {
+    const QHash<QString, QList<qint64>> lost = thumbnailCache.takeLost();
+    if (lost.isEmpty()) return;
+    thumbnailPasses.removeIf([&lost](const ThumbnailCache::Pass &pass) {
+        const auto times = lost.constFind(pass.path);
+        if (times == lost.constEnd()) return false;
+        return std::any_of(times->cbegin(), times->cend(), [&pass](qint64 ms) {
+            return ms >= pass.fromMs && ms < pass.toMs;
+        });
+    });
+}
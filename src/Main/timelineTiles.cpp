@@ -0,0 +1,504 @@
+#include "../Includes/timelinewidget.h"
+#include "../Includes/workerPools.h"
+
+#include <QFileInfo>
+#include <QPainter>
+#include <QPointer>
+#include <QTimer>
+#include <QtMath>
+#include <cmath>
+
+namespace {
+QString formatTimelineDuration(qint64 ms) {
+    ms = qMax<qint64>(0, ms);
+    if (ms >= 60000) {
+        const qint64 totalSeconds = ms / 1000;
+        return QString("%1:%2").arg(totalSeconds / 60).arg(totalSeconds % 60, 2, 10, QLatin1Char('0'));
+    }
+    return QString("%1.%2s").arg(ms / 1000).arg(ms % 1000, 3, 10, QLatin1Char('0'));
+}
+
+// Widest anything drawn for an item reaches past its own span: ruler
+// labels run 104 px right of their tick, thumbnails 88 px right of their
+// slot, markers and strokes a few px either way.
+constexpr int kTileBleed = 104;
+
+// Players report positions every few tens of ms, not evenly. Between
+// reports the playhead runs on, at most this far past the last one...
+constexpr qint64 kPlayheadMaxExtrapolationMs = 250;
+// ...and a report at most this far behind what's drawn is jitter, not a seek.
+constexpr qint64 kPlayheadMaxLeadMs = 100;
+}
+
+void TimelineWidget::invalidateScene() {
+    ++sceneRevision;
+    update();
+}
+
+void TimelineWidget::updatePlayhead() {
+    if (durationMs <= 0) return;
+    const int contentWidth = (width() - sidebarWidth) * zoomFactor;
+    const double pxPerMs = static_cast<double>(contentWidth) / durationMs;
+    auto xAt = [&](qint64 ms) { return sidebarWidth - scrollOffset + static_cast<int>(ms * pxPerMs); };
+    const qint64 newMs = playheadDrawMs();
+    const int oldX = xAt(paintedPlayheadMs);
+    const int newX = xAt(newMs);
+    paintedPlayheadMs = newMs;
+    // Zoomed out, most display frames don't move it a whole pixel.
+    if (oldX == newX) return;
+    // The arrow is 16 px wide, the line 2 px; a little extra for antialiasing.
+    update(QRect(oldX - 10, 0, 20, height()));
+    update(QRect(newX - 10, 0, 20, height()));
+}
+
+// Where the playhead is drawn: the position, or while playing, the last
+// reported one carried on by the clock. Code that moves currentPosMs
+// itself (a click, a key) wins until the next report.
+qint64 TimelineWidget::playheadDrawMs() const {
+    if (!playheadRunning || currentPosMs != playheadAnchorMs) return currentPosMs;
+    qint64 ms = playheadAnchorMs + qMin<qint64>(kPlayheadMaxExtrapolationMs,
+                                                static_cast<qint64>(playheadClock.nsecsElapsed() / 1e6 * playheadRate));
+    // Playback jumps cuts; the report after the jump moves the playhead.
+    const int seg = segmentIndexAtTime(playheadAnchorMs);
+    if (seg >= 0) ms = qMin(ms, model->segments()[seg].endMs);
+    return qBound(playheadHoldMs, ms, durationMs);
+}
+
+void TimelineWidget::anchorPlayhead(qint64 reportedMs) {
+    if (playheadRunning) {
+        // Slightly behind what's on screen: hold the playhead until the
+        // clock catches up rather than step it back. Anything else is a
+        // seek and is shown as one.
+        const qint64 shown = playheadDrawMs();
+        playheadHoldMs = (shown > reportedMs && shown - reportedMs < kPlayheadMaxLeadMs) ? shown : -1;
+    }
+    playheadAnchorMs = reportedMs;
+    playheadClock.restart();
+}
+
+void TimelineWidget::setPlaybackClock(bool playing, double rate) {
+    playheadRate = rate > 0.0 ? rate : 1.0;
+    playheadHoldMs = -1;
+    playheadAnchorMs = currentPosMs;
+    playheadClock.restart();
+    playheadRunning = playing;
+    if (playing) {
+        // Asked again on every start: the window may have changed screens.
+        const qreal hz = screen() ? screen()->refreshRate() : 60.0;
+        playheadTimer->start(qBound(4, qRound(1000.0 / qMax<qreal>(1.0, hz)), 33));
+    } else {
+        playheadTimer->stop();
+    }
+    updatePlayhead();
+}
+
+// Snapshot of everything the tiles draw, rebuilt at most once per
+// invalidateScene().
+// Qt containers are implicitly shared, so this costs a few reference counts
+// until the widget next edits one of them.
+QSharedPointer<const TimelineWidget::TileScene> TimelineWidget::currentTileScene() {
+    // Stylesheet colours and fonts don't come through invalidateScene().
+    if (tileScene && (tileScene->accent != m_accentColor || tileScene->track != m_trackColor ||
+                      tileScene->background != m_backgroundColor || tileScene->font != font())) {
+        ++sceneRevision;
+    }
+    if (tileScene && tileSceneRevision == sceneRevision) return tileScene;
+    ensureRenderRanges();
+
+    auto scene = QSharedPointer<TileScene>::create();
+    scene->durationMs = durationMs;
+    scene->contentWidth = tileGeometry.contentWidth;
+    scene->rulerHeight = rulerHeight;
+    scene->trackHeight = trackHeight;
+    scene->vTop = videoTrackTop() + 8;
+    scene->aTop = scene->vTop + trackHeight + 15;
+    scene->lanesTop = overlayLanesTop();
+    scene->laneCount = overlayLaneCount();
+    scene->lanes = computeOverlayLanes();
+    scene->accent = m_accentColor;
+    scene->track = m_trackColor;
+    scene->background = m_backgroundColor;
+    scene->font = font();
+    scene->segments = segments;
+    scene->sources = sources;
+    scene->overlays = overlays;
+    scene->markers = markers;
+    scene->renderRanges = renderRanges;
+    scene->segmentIndex = ensureSegmentIndex();
+    scene->overlayIndex = ensureOverlayIndex();
+    scene->thumbnails = thumbnailCache.frames();
+    for (int i = 0; i < sources.size(); ++i) {
+        scene->waveforms.append(sourceWaveform(i)
+            ? waveforms.value(waveformKey(model->sources()[i].path, i == 0 ? currentAudioTrack : 0))
+            : QSharedPointer<const WaveformPyramid>());
+    }
+    scene->hasWaveforms = !waveforms.isEmpty();
+    scene->waveformPeak = waveformPeak;
+
+    tileScene = scene;
+    tileSceneRevision = sceneRevision;
+    return tileScene;
+}
+
+// Blits the tiles under `contentRect` (content coordinates; the painter is
+// already translated to them).
+void TimelineWidget::paintTiles(QPainter &painter, const QRect &contentRect) {
+    const TileGeometry geometry{static_cast<int>((width() - sidebarWidth) * zoomFactor), height(), devicePixelRatioF()};
+    if (!(geometry == tileGeometry)) {
+        tiles.clear();
+        tilesInFlight.clear();
+        tileGeometry = geometry;
+        ++tileGeneration;
+        tileScene.reset();
+    }
+    const QSharedPointer<const TileScene> scene = currentTileScene();
+
+    const int first = qMax(0, contentRect.left() / kTileWidth);
+    const int last = qMax(first, contentRect.right() / kTileWidth);
+    for (int index = first; index <= last; ++index) {
+        auto it = tiles.find(index);
+        if (it == tiles.end()) {
+            it = tiles.insert(index, Tile{renderTile(*scene, geometry, index), tileSceneRevision});
+        } else if (it->revision != tileSceneRevision) {
+            requestTile(index, scene);
+        }
+        painter.drawImage(QPointF(index * kTileWidth, 0), it->image);
+    }
+
+    // Keep a viewport either side warm, forget everything past that.
+    const int viewWidth = width() - sidebarWidth;
+    const int viewFirst = qMax(0, scrollOffset / kTileWidth);
+    const int viewLast = (scrollOffset + viewWidth) / kTileWidth;
+    const int span = viewLast - viewFirst + 1;
+    const int lastTile = qMax(0, (geometry.contentWidth - 1) / kTileWidth);
+    for (int index = qMax(0, viewFirst - span); index <= qMin(lastTile, viewLast + span); ++index) {
+        const auto it = tiles.constFind(index);
+        if (it == tiles.constEnd() || it->revision != tileSceneRevision) requestTile(index, scene);
+    }
+    for (auto it = tiles.begin(); it != tiles.end();) {
+        if (it.key() < viewFirst - span || it.key() > viewLast + span) it = tiles.erase(it);
+        else ++it;
+    }
+}
+
+void TimelineWidget::requestTile(int index, const QSharedPointer<const TileScene> &scene) {
+    if (tilesInFlight.contains(index)) return;
+    tilesInFlight.insert(index);
+    const TileGeometry geometry = tileGeometry;
+    const quint64 generation = tileGeneration;
+    const quint64 revision = tileSceneRevision;
+    QPointer<TimelineWidget> self(this);
+    (void)WorkerPools::run(WorkerPools::Interface, [self, scene, geometry, generation, revision, index]() {
+        const QImage image = renderTile(*scene, geometry, index);
+        QMetaObject::invokeMethod(self, [self, generation, revision, index, image]() {
+            if (!self || generation != self->tileGeneration) return;
+            self->tilesInFlight.remove(index);
+            const auto it = self->tiles.constFind(index);
+            if (it != self->tiles.constEnd() && it->revision >= revision) return;
+            self->tiles.insert(index, Tile{image, revision});
+            self->update(QRect(self->sidebarWidth - self->scrollOffset + index * kTileWidth, 0,
+                                        kTileWidth, self->height()));
+        }, Qt::QueuedConnection);
+    });
+}
+
+QImage TimelineWidget::renderTile(const TileScene &scene, const TileGeometry &geometry, int index) {
+    QImage image(qCeil(kTileWidth * geometry.dpr), qCeil(geometry.height * geometry.dpr),
+                 QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(geometry.dpr);
+    image.fill(scene.background);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setFont(scene.font);
+    const int x0 = index * kTileWidth;
+    painter.translate(-x0, 0);
+    paintStaticLayer(painter, scene, x0, x0 + kTileWidth);
+    return image;
+}
+
+// The static part of the timeline, in content coordinates, for items that
+// reach into [x0, x1). Runs on the interface pool: only `scene` may be read.
+void TimelineWidget::paintStaticLayer(QPainter &painter, const TileScene &scene, int x0, int x1) {
+    const QColor accent = scene.accent;
+    const int contentWidth = scene.contentWidth;
+    const int trackHeight = scene.trackHeight;
+    const int rulerHeight = scene.rulerHeight;
+    const int vTop = scene.vTop;
+    const int aTop = scene.aTop;
+    const double pxPerMs = static_cast<double>(contentWidth) / scene.durationMs;
+    auto visible = [&](double left, double right) { return right >= x0 - kTileBleed && left <= x1 + kTileBleed; };
+    // The same window in time, for the index lookups.
+    const qint64 tLo = qMax<qint64>(0, static_cast<qint64>(std::floor((x0 - kTileBleed) / pxPerMs)));
+    const qint64 tHi = static_cast<qint64>(std::ceil((x1 + kTileBleed) / pxPerMs));
+
+    // --- Lane bands: separate video/audio lanes like an NLE timeline ---
+    painter.fillRect(QRectF(0, vTop - 6, contentWidth, trackHeight + 12), scene.track.lighter(112));
+    if (scene.hasWaveforms) {
+        painter.fillRect(QRectF(0, aTop - 6, contentWidth, trackHeight + 12), scene.track);
+    }
+
+    // --- Overlay lanes (effects / text) above the video track ---
+    if (!scene.overlays.isEmpty()) {
+        for (int l = 0; l < scene.laneCount; ++l) {
+            const int y = scene.lanesTop + l * (overlayLaneHeight + overlayLaneGap);
+            painter.fillRect(QRectF(0, y, contentWidth, overlayLaneHeight), scene.track.darker(108));
+        }
+
+        QFont ovFont = painter.font();
+        ovFont.setPointSizeF(7.5);
+        ovFont.setBold(true);
+        painter.setFont(ovFont);
+
+        for (int i : scene.overlayIndex.touching(tLo, tHi)) {
+            const auto &ov = scene.overlays[i];
+            const int y = scene.lanesTop + scene.lanes[i] * (overlayLaneHeight + overlayLaneGap);
+            QRectF r(ov.startMs * pxPerMs, y, qMax(6.0, (ov.endMs - ov.startMs) * pxPerMs), overlayLaneHeight);
+            if (!visible(r.left(), r.right())) continue;
+            paintOverlayClip(painter, ov, r, false, pxPerMs);
+        }
+    }
+
+    // --- Ruler: tick marks + timecodes along the top, like an NLE ruler ---
+    {
+        static const qint64 kNiceIntervalsMs[] = {40, 100, 200, 500, 1000, 2000, 5000, 10000, 30000, 60000, 120000, 300000, 600000};
+        qint64 interval = kNiceIntervalsMs[0];
+        for (qint64 candidate : kNiceIntervalsMs) {
+            interval = candidate;
+            if (candidate * pxPerMs >= 76) break;
+        }
+
+        QFont tickFont = painter.font();
+        tickFont.setPointSizeF(7.5);
+        painter.setFont(tickFont);
+
+        const qint64 firstTick = qMax<qint64>(0, static_cast<qint64>((x0 - kTileBleed) / pxPerMs) / interval * interval);
+        for (qint64 t = firstTick; t <= scene.durationMs && t * pxPerMs <= x1; t += interval) {
+            const int x = static_cast<int>(t * pxPerMs);
+            painter.setPen(QPen(QColor(255, 255, 255, 55), 1));
+            painter.drawLine(x, rulerHeight - 8, x, rulerHeight);
+            painter.setPen(QColor(255, 255, 255, 115));
+            painter.drawText(QRect(x + 4, 1, 100, rulerHeight - 2), Qt::AlignLeft | Qt::AlignVCenter, formatTimelineDuration(t));
+        }
+        painter.setPen(QPen(QColor(255, 255, 255, 30), 1));
+        painter.drawLine(0, rulerHeight, contentWidth, rulerHeight);
+    }
+
+    // --- Markers: small triangles in the ruler, snap targets for trims/overlays ---
+    if (!scene.markers.isEmpty()) {
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(accent);
+        for (auto m = std::lower_bound(scene.markers.cbegin(), scene.markers.cend(), tLo);
+             m != scene.markers.cend() && *m <= tHi; ++m) {
+            const int x = static_cast<int>(*m * pxPerMs);
+            if (!visible(x, x)) continue;
+            QPolygon tri;
+            tri << QPoint(x - 5, rulerHeight - 1) << QPoint(x + 5, rulerHeight - 1) << QPoint(x, rulerHeight - 9);
+            painter.drawPolygon(tri);
+        }
+    }
+
+    drawRenderBar(painter, scene.renderRanges, rulerHeight + 2, pxPerMs);
+
+    const int lastSeg = scene.segmentIndex.firstStartAfter(tHi);
+    for (int i = scene.segmentIndex.firstEndAtOrAfter(tLo); i < lastSeg; ++i) {
+        const Segment &seg = scene.segments[i];
+        QRectF clipRect(seg.startMs * pxPerMs, vTop, (seg.endMs - seg.startMs) * pxPerMs, trackHeight);
+        if (!visible(clipRect.left(), clipRect.right())) continue;
+
+        painter.setPen(QPen(accent.darker(160), 1.0));
+        painter.setBrush(QColor(accent.red(), accent.green(), accent.blue(), 25));
+        painter.drawRoundedRect(clipRect, 6, 6);
+
+        // Thumbnail slots that can reach into this tile.
+        const int thumbW = 88;
+        const int slotOrigin = static_cast<int>(clipRect.left()) + 4;
+        const int firstSlot = slotOrigin + qMax(0, (x0 - thumbW - slotOrigin) / thumbW) * thumbW;
+        const int slotEnd = qMin(static_cast<int>(std::ceil(clipRect.right())), x1);
+
+        const bool knownSource = seg.sourceIdx >= 0 && seg.sourceIdx < scene.sources.size();
+        const auto thumbs = knownSource ? scene.thumbnails.constFind(scene.sources[seg.sourceIdx].path)
+                                        : scene.thumbnails.constEnd();
+        if (thumbs != scene.thumbnails.constEnd() && !thumbs->isEmpty()) {
+            const qint64 sourceOffsetMs = scene.sources[seg.sourceIdx].offsetMs;
+            painter.save();
+            painter.setClipRect(clipRect.adjusted(2, 2, -2, -2));
+            painter.setOpacity(0.42);
+            for (int x = firstSlot; x < slotEnd; x += thumbW) {
+                // The keyframe nearest the middle of the slot.
+                const qint64 timeAtX = qBound<qint64>(seg.startMs, static_cast<qint64>((x + thumbW / 2) / pxPerMs), seg.endMs);
+                const qint64 sourceMs = timeAtX - sourceOffsetMs;
+                auto thumb = thumbs->upperBound(sourceMs);
+                if (thumb == thumbs->constEnd()
+                    || (thumb != thumbs->constBegin() && sourceMs - std::prev(thumb).key() <= thumb.key() - sourceMs)) {
+                    --thumb;
+                }
+                QRect target(x, static_cast<int>(clipRect.top()) + 3, thumbW - 4, trackHeight - 6);
+                painter.drawImage(target, *thumb);
+            }
+            painter.restore();
+        }
+
+        // Appended clips: the source filename as a label.
+        if (seg.sourceIdx > 0 && knownSource) {
+            const int srcIdx = seg.sourceIdx;
+            painter.save();
+            QFont srcFont = painter.font();
+            srcFont.setPointSizeF(8);
+            srcFont.setBold(true);
+            painter.setFont(srcFont);
+            painter.setPen(QColor(255, 255, 255, 190));
+            const QString name = QFileInfo(scene.sources[srcIdx].path).fileName();
+            painter.drawText(clipRect.adjusted(10, 0, -10, 0), Qt::AlignVCenter | Qt::AlignLeft,
+                             painter.fontMetrics().elidedText(name, Qt::ElideMiddle, static_cast<int>(clipRect.width()) - 20));
+            painter.restore();
+        }
+
+        if (seg.cropTop > 0.001f || seg.cropBottom < 0.999f || seg.cropLeft > 0.001f || seg.cropRight < 0.999f) {
+            painter.save();
+            painter.setPen(Qt::NoPen);
+            painter.setBrush(QColor(accent.red(), accent.green(), accent.blue(), 95));
+            painter.drawRoundedRect(QRectF(clipRect.left() + 6, clipRect.top() + 6, 36, 14), 4, 4);
+            QFont fxFont = painter.font();
+            fxFont.setPointSizeF(7);
+            fxFont.setBold(true);
+            painter.setFont(fxFont);
+            painter.setPen(Qt::white);
+            painter.drawText(QRectF(clipRect.left() + 6, clipRect.top() + 5, 36, 15), Qt::AlignCenter, "CROP");
+            painter.restore();
+        }
+
+        // Draw Gain Label (Visual Feedback)
+        if (seg.gain != 1.0f) {
+            painter.save();
+            painter.setPen(Qt::white);
+            QFont labelFont = painter.font(); labelFont.setPointSizeF(7);
+            painter.setFont(labelFont);
+            painter.drawText(clipRect.adjusted(5, 2, 0, 0), Qt::AlignTop | Qt::AlignLeft,
+                             QString("%1x").arg(seg.gain, 0, 'f', 1));
+            painter.restore();
+        }
+
+        // Waveform, one column per pixel of this tile read from the source's
+        // pyramid: the min/max envelope behind, RMS body on top, both scaled
+        // by the segment's gain.
+        const WaveformPyramid *wave = seg.sourceIdx >= 0 && seg.sourceIdx < scene.waveforms.size()
+            ? scene.waveforms[seg.sourceIdx].data() : nullptr;
+        if (wave && scene.waveformPeak > 0.0f) {
+            const QColor bodyColor = accent.darker(180);
+            QColor envelopeColor = bodyColor;
+            envelopeColor.setAlphaF(0.45f);
+            const float gain = seg.gain;
+            const float peak = scene.waveformPeak;
+            const float mid = aTop + trackHeight / 2.0f;
+            const float half = (trackHeight - 10) / 2.0f;
+            // Signed, so a bin that never crosses zero stays on its own side.
+            auto extent = [&](float amplitude) {
+                return std::copysign(std::pow(qMin(1.0f, std::abs(amplitude) / peak * gain), 0.6f) * half,
+                                     amplitude);
+            };
+
+            const qint64 offset = scene.sources[seg.sourceIdx].offsetMs;
+            const int wx0 = qMax(static_cast<int>(clipRect.left()), x0);
+            const int wx1 = qMin(static_cast<int>(std::ceil(clipRect.right())), x1);
+            QVector<QLineF> envelope, body;
+            envelope.reserve(qMax(0, wx1 - wx0));
+            body.reserve(qMax(0, wx1 - wx0));
+            for (int x = wx0; x < wx1; ++x) {
+                const qint64 t0 = qMax(seg.startMs, static_cast<qint64>(x / pxPerMs));
+                const qint64 t1 = qMin(seg.endMs, static_cast<qint64>((x + 1) / pxPerMs));
+                const WaveformPyramid::Range r = wave->range(t0 - offset, t1 - offset);
+                if (!r.valid) continue;
+                const double cx = x + 0.5;
+                envelope.append(QLineF(cx, mid - extent(r.max), cx, mid - extent(r.min)));
+                const float rms = extent(r.rms);
+                body.append(QLineF(cx, mid - rms, cx, mid + rms));
+            }
+            painter.setPen(QPen(envelopeColor, 1));
+            painter.drawLines(envelope);
+            painter.setPen(QPen(bodyColor, 1));
+            painter.drawLines(body);
+        }
+    }
+}
+
+// One overlay clip in its lane rect; the painter's font is the lane label's.
+void TimelineWidget::paintOverlayClip(QPainter &painter, const OverlayClip &ov, const QRectF &r, bool selected,
+                                      double pxPerMs) {
+    // Per-type hue so lanes read at a glance
+    QColor base;
+    QString label;
+    switch (ov.type) {
+        case 0:  base = QColor("#5B8DEF"); label = "BLUR"; break;
+        case 1:  base = QColor("#9B6BE8"); label = "PIXEL"; break;
+        case 2:  base = QColor("#666B75"); label = "BLACK"; break;
+        case 6:  base = QColor("#D08C3F");
+                 label = ov.imagePath.isEmpty() ? "NO IMAGE" : QFileInfo(ov.imagePath).fileName().left(24).toUpper(); break;
+        default: base = QColor("#3FB68B");
+                 label = ov.text.isEmpty() ? "TEXT" : ov.text.left(24).toUpper(); break;
+    }
+    QColor fill = base; fill.setAlpha(selected ? 200 : 120);
+    painter.setPen(selected ? QPen(Qt::white, 1.4) : QPen(base.lighter(115), 1));
+    painter.setBrush(fill);
+    painter.drawRoundedRect(r, 6, 6);
+
+    // Motion-tracked: a tick per keyframe along the bottom edge
+    if (!ov.keyframes.isEmpty()) {
+        painter.save();
+        painter.setClipRect(r);
+        painter.setPen(QPen(QColor(255, 255, 255, 150), 1));
+        double lastX = -1e9;
+        for (const auto &key : ov.keyframes) {
+            const double x = key.timeMs * pxPerMs;
+            if (x - lastX < 3.0) continue;
+            lastX = x;
+            painter.drawLine(QPointF(x, r.bottom() - 4), QPointF(x, r.bottom() - 1));
+        }
+        painter.restore();
+    }
+
+    painter.setPen(QColor(255, 255, 255, selected ? 255 : 210));
+    painter.drawText(r.adjusted(8, 0, -8, 0), Qt::AlignVCenter | Qt::AlignLeft,
+                     painter.fontMetrics().elidedText(label, Qt::ElideRight, static_cast<int>(r.width()) - 14));
+}
+
+// The selection, over the tiles in content coordinates, so clicking around
+// repaints without retiring them.
+void TimelineWidget::paintSelection(QPainter &painter, const QRect &contentRect) {
+    const double pxPerMs = static_cast<double>(tileGeometry.contentWidth) / durationMs;
+    const QList<Segment> &segs = model->segments();
+    const QList<OverlayClip> &ovs = model->overlays();
+
+    QSet<int> selected = selectedSegmentIndices;
+    if (selectedSegmentIdx >= 0) selected.insert(selectedSegmentIdx);
+    const int vTop = videoTrackTop() + 8;
+    painter.setPen(QPen(m_accentColor, 2.5));
+    painter.setBrush(QColor(m_accentColor.red(), m_accentColor.green(), m_accentColor.blue(), 40));
+    for (int idx : selected) {
+        if (idx < 0 || idx >= segs.size()) continue;
+        const QRectF clipRect(segs[idx].startMs * pxPerMs, vTop, (segs[idx].endMs - segs[idx].startMs) * pxPerMs,
+                              trackHeight);
+        if (!clipRect.adjusted(-2, -2, 2, 2).intersects(contentRect)) continue;
+        painter.drawRoundedRect(clipRect, 6, 6);
+    }
+
+    // The selected overlay, restyled, with its trim handles
+    if (selectedOverlayIdx >= 0 && selectedOverlayIdx < ovs.size() && selectedOverlayIdx < tileScene->lanes.size()) {
+        const auto &ov = ovs[selectedOverlayIdx];
+        const int y = overlayLanesTop() + tileScene->lanes[selectedOverlayIdx] * (overlayLaneHeight + overlayLaneGap);
+        QRectF r(ov.startMs * pxPerMs, y, qMax(6.0, (ov.endMs - ov.startMs) * pxPerMs), overlayLaneHeight);
+        if (r.adjusted(-2, -2, 2, 2).intersects(contentRect)) {
+            painter.save();
+            QFont ovFont = tileScene->font;
+            ovFont.setPointSizeF(7.5);
+            ovFont.setBold(true);
+            painter.setFont(ovFont);
+            paintOverlayClip(painter, ov, r, true, pxPerMs);
+            painter.restore();
+
+            painter.setBrush(Qt::white);
+            painter.setPen(Qt::NoPen);
+            painter.drawRoundedRect(QRectF(r.left() + 2, r.top() + 4, 3, r.height() - 8), 1.5, 1.5);
+            painter.drawRoundedRect(QRectF(r.right() - 5, r.top() + 4, 3, r.height() - 8), 1.5, 1.5);
+        }
+    }
+}
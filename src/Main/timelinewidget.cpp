@@ -3,37 +3,23 @@
 #include <QPainter>
 #include <QStyle>
 #include <QFile>
-#include <QVideoFrame>
 #include <QTimer>
 #include <QProcess>
 #include <QCoreApplication>
 #include <QMimeData>
 #include <QDragEnterEvent>
 #include <QFileInfo>
-#include <QDir>
 #include <algorithm>
+#include <cmath>
 
-namespace {
-QString formatTimelineDuration(qint64 ms) {
-    ms = qMax<qint64>(0, ms);
-    if (ms >= 60000) {
-        const qint64 totalSeconds = ms / 1000;
-        return QString("%1:%2").arg(totalSeconds / 60).arg(totalSeconds % 60, 2, 10, QLatin1Char('0'));
-    }
-    return QString("%1.%2s").arg(ms / 1000).arg(ms % 1000, 3, 10, QLatin1Char('0'));
-}
-}
-
-TimelineWidget::TimelineWidget(QWidget* parent) : QWidget(parent) {
+TimelineWidget::TimelineWidget(QWidget* parent)
+    : QWidget(parent), model(new TimelineModel(this)), sources(model->sources()),
+      overlays(model->overlays()), markers(model->markers()), segments(model->segments()) {
     setMinimumHeight(180);
     setMouseTracking(true);
     setFocusPolicy(Qt::StrongFocus);
     setAcceptDrops(true);
 
-    videoSink = new QVideoSink(this);
-    thumbPlayer = new QMediaPlayer(this);
-    thumbPlayer->setVideoOutput(videoSink);
-
     audioGain = 1.0f;
     selectedSegmentIdx = -1;
     zoomFactor = 1.0;
@@ -45,10 +31,79 @@ TimelineWidget::TimelineWidget(QWidget* parent) : QWidget(parent) {
     this->style()->unpolish(this);
     this->style()->polish(this);
 
-    connect(videoSink, &QVideoSink::videoFrameChanged, this, &TimelineWidget::processVideoFrame);
+    // The overlay index follows clip edits in place unless a reset already
+    // has it waiting for a rebuild. Only timing edits move schedule
+    // boundaries.
+    connect(model, &TimelineModel::segmentsInserted, this, [this]() { ++segmentRevision; renderRangesDirty = true; });
+    connect(model, &TimelineModel::segmentsRemoved, this, [this]() { ++segmentRevision; renderRangesDirty = true; });
+    connect(model, &TimelineModel::segmentsReset, this, [this]() { ++segmentRevision; renderRangesDirty = true; });
+    connect(model, &TimelineModel::segmentsChanged, this, [this](int, int, TimelineModel::Fields fields) {
+        if (fields & (TimelineModel::Timing | TimelineModel::Speed)) ++segmentRevision;
+        // Crop and speed aren't baked into render-cache clips.
+        if (fields & TimelineModel::Timing) renderRangesDirty = true;
+    });
+    connect(model, &TimelineModel::sourcesInserted, this, [this]() { renderRangesDirty = true; });
+    connect(model, &TimelineModel::sourcesChanged, this, [this]() { renderRangesDirty = true; });
+    connect(model, &TimelineModel::sourcesReset, this, [this]() { renderRangesDirty = true; });
+    connect(model, &TimelineModel::overlaysInserted, this, [this](int first, int last) {
+        overlayScheduleDirty = true;
+        renderRangesDirty = true;
+        if (overlayIndexDirty) return;
+        for (int i = first; i <= last; ++i) overlayIndex.insert(i, model->overlays()[i].startMs, model->overlays()[i].endMs);
+    });
+    connect(model, &TimelineModel::overlaysRemoved, this, [this](int first, int last) {
+        overlayScheduleDirty = true;
+        renderRangesDirty = true;
+        if (overlayIndexDirty) return;
+        for (int i = last; i >= first; --i) overlayIndex.remove(i);
+    });
+    connect(model, &TimelineModel::overlaysChanged, this, [this](int first, int last, TimelineModel::Fields fields) {
+        // Every overlay field is baked into render-cache clips.
+        renderRangesDirty = true;
+        if (!(fields & TimelineModel::Timing)) return;
+        overlayScheduleDirty = true;
+        if (overlayIndexDirty) return;
+        for (int i = first; i <= last; ++i) overlayIndex.move(i, model->overlays()[i].startMs, model->overlays()[i].endMs);
+    });
+    connect(model, &TimelineModel::overlaysReset, this, [this]() {
+        overlayScheduleDirty = true;
+        renderRangesDirty = true;
+        overlayIndexDirty = true;
+    });
+    // Every edit to the model changes what the tiles draw.
+    connect(model, &TimelineModel::segmentsInserted, this, &TimelineWidget::invalidateScene);
+    connect(model, &TimelineModel::segmentsRemoved, this, &TimelineWidget::invalidateScene);
+    connect(model, &TimelineModel::segmentsChanged, this, &TimelineWidget::invalidateScene);
+    connect(model, &TimelineModel::segmentsReset, this, &TimelineWidget::invalidateScene);
+    connect(model, &TimelineModel::sourcesInserted, this, &TimelineWidget::invalidateScene);
+    connect(model, &TimelineModel::sourcesChanged, this, &TimelineWidget::invalidateScene);
+    connect(model, &TimelineModel::sourcesReset, this, &TimelineWidget::invalidateScene);
+    connect(model, &TimelineModel::overlaysInserted, this, &TimelineWidget::invalidateScene);
+    connect(model, &TimelineModel::overlaysRemoved, this, &TimelineWidget::invalidateScene);
+    connect(model, &TimelineModel::overlaysChanged, this, &TimelineWidget::invalidateScene);
+    connect(model, &TimelineModel::overlaysReset, this, &TimelineWidget::invalidateScene);
+    connect(model, &TimelineModel::markersChanged, this, &TimelineWidget::invalidateScene);
+
+    renderIdleTimer = new QTimer(this);
+    renderIdleTimer->setSingleShot(true);
+    renderIdleTimer->setInterval(3000);
+    connect(renderIdleTimer, &QTimer::timeout, this, [this]() {
+        if (!isExporting) renderStaleRanges();
+    });
+
+    // Zoom and scroll settle before a thumbnail pass is sized to them.
+    thumbnailTimer = new QTimer(this);
+    thumbnailTimer->setSingleShot(true);
+    thumbnailTimer->setInterval(150);
+    connect(thumbnailTimer, &QTimer::timeout, this, &TimelineWidget::requestThumbnails);
+
+    playheadTimer = new QTimer(this);
+    playheadTimer->setTimerType(Qt::PreciseTimer);
+    connect(playheadTimer, &QTimer::timeout, this, &TimelineWidget::updatePlayhead);
 }
 
 void TimelineWidget::setCurrentPosition(qint64 ms) {
+    anchorPlayhead(ms);
     const int oldSegment = segmentIndexAtTime(currentPosMs);
     currentPosMs = ms;
     const int newSegment = segmentIndexAtTime(currentPosMs);
@@ -56,8 +111,10 @@ void TimelineWidget::setCurrentPosition(qint64 ms) {
         selectedSegmentIdx = newSegment;
         selectedSegmentIndices.clear();
         emitVisualStateForCurrentContext();
+        update();
+        return;
     }
-    update();
+    updatePlayhead();
 }
 
 void TimelineWidget::splitAtPlayhead() {
@@ -66,10 +123,12 @@ void TimelineWidget::splitAtPlayhead() {
         if (currentPosMs > segments[i].startMs + splitGuard && currentPosMs < segments[i].endMs - splitGuard) {
             Segment splitSegment = segments[i];
             qint64 originalEnd = splitSegment.endMs;
-            segments[i].endMs = currentPosMs;
+            Segment head = segments[i];
+            head.endMs = currentPosMs;
+            model->setSegment(i, head, TimelineModel::Timing);
             splitSegment.startMs = currentPosMs;
             splitSegment.endMs = originalEnd;
-            segments.insert(i + 1, splitSegment);
+            model->insertSegment(i + 1, splitSegment);
             selectedSegmentIdx = i + 1;
             showNotification("CLIP SPLIT ✂️");
             emit clipTrimmed();
@@ -104,21 +163,24 @@ void TimelineWidget::addOverlayAt(int type, qint64 timeMs) {
         clip.l = 0.30f; clip.t = 0.30f; clip.r = 0.70f; clip.b = 0.60f;
     } else if (type == 5) {
         clip.l = 0.0f; clip.t = 0.0f; clip.r = 1.0f; clip.b = 1.0f;
+    } else if (type == 6) { // watermark corner; resized to the image's aspect once one is picked
+        clip.l = 0.80f; clip.t = 0.05f; clip.r = 0.96f; clip.b = 0.20f;
+        clip.opacity = 0.8f;
     }
-    overlays.append(clip);
+    model->insertOverlay(overlays.size(), clip);
     selectedOverlayIdx = overlays.size() - 1;
 
     relayout();
     update();
     emit overlaysChanged();
     if (type == 3) emit requestEditTextOverlay(selectedOverlayIdx);
-    else if (type == 4 || type == 5) emit requestEditOverlayProperties(selectedOverlayIdx);
+    else if (type == 4 || type == 5 || type == 6) emit requestEditOverlayProperties(selectedOverlayIdx);
 }
 
 void TimelineWidget::deleteSelectedOverlay() {
     if (selectedOverlayIdx < 0 || selectedOverlayIdx >= overlays.size()) return;
     saveState("Delete overlay");
-    overlays.removeAt(selectedOverlayIdx);
+    model->removeOverlays(selectedOverlayIdx, selectedOverlayIdx);
     selectedOverlayIdx = -1;
     showNotification("OVERLAY DELETED");
     relayout();
@@ -126,28 +188,43 @@ void TimelineWidget::deleteSelectedOverlay() {
     emit overlaysChanged();
 }
 
+void TimelineWidget::setOverlayKeyframes(int index, const QVector<RegionKeyframe> &keyframes) {
+    if (index < 0 || index >= overlays.size()) return;
+    saveState(keyframes.isEmpty() ? "Clear motion track" : "Track motion");
+    OverlayClip ov = overlays[index];
+    if (keyframes.isEmpty()) {
+        // Leave the region where it is on screen right now.
+        const QRectF here = ov.regionAt(currentPosMs);
+        ov.l = here.left(); ov.t = here.top();
+        ov.r = here.right(); ov.b = here.bottom();
+    }
+    ov.keyframes = keyframes;
+    model->setOverlay(index, ov, TimelineModel::Geometry);
+    update();
+    emit overlaysChanged();
+}
+
 void TimelineWidget::toggleMarkerAtPlayhead() {
     if (durationMs <= 0) return;
     const qint64 tolerance = 300;
     for (int i = 0; i < markers.size(); ++i) {
-        if (std::abs(markers[i] - currentPosMs) <= tolerance) {
+        if (std::abs(model->markers()[i] - currentPosMs) <= tolerance) {
             saveState("Remove marker");
-            markers.removeAt(i);
+            model->removeMarker(i);
             showNotification("MARKER REMOVED");
             update();
             return;
         }
     }
     saveState("Add marker");
-    markers.append(currentPosMs);
-    std::sort(markers.begin(), markers.end());
+    model->addMarker(currentPosMs);
     showNotification("MARKER ADDED");
     update();
 }
 
-// Snaps a candidate time to the nearest playhead/marker/segment-edge within a
-// small pixel tolerance, so dragging a trim handle or overlay edge feels
-// magnetic near those reference points instead of requiring pixel-perfect aim.
+// Snaps a candidate time to the nearest playhead/snap target within a small
+// pixel tolerance, so dragging a trim handle or overlay edge feels magnetic
+// near those reference points instead of requiring pixel-perfect aim.
 qint64 TimelineWidget::snappedTime(qint64 t, double pxPerMs) const {
     const qint64 toleranceMs = static_cast<qint64>(8.0 / qMax(0.0001, pxPerMs));
     qint64 best = t;
@@ -157,51 +234,109 @@ qint64 TimelineWidget::snappedTime(qint64 t, double pxPerMs) const {
         if (dist <= toleranceMs && dist < bestDist) { bestDist = dist; best = candidate; }
     };
     consider(currentPosMs);
-    for (qint64 m : markers) consider(m);
-    for (const auto &seg : segments) { consider(seg.startMs); consider(seg.endMs); }
+    for (auto it = std::lower_bound(snapTargets.cbegin(), snapTargets.cend(), t - toleranceMs);
+         it != snapTargets.cend() && *it <= t + toleranceMs; ++it) {
+        consider(*it);
+    }
     return best;
 }
 
-QList<int> TimelineWidget::overlaysAtTime(qint64 timeMs) const {
-    QList<int> hits;
+void TimelineWidget::buildSnapTargets(int skipSegment, int skipOverlay) {
+    snapTargets.clear();
+    snapTargets.reserve(markers.size() + 2 * (segments.size() + overlays.size()));
+    snapTargets.append(markers);
+    for (int i = 0; i < segments.size(); ++i) {
+        if (i == skipSegment) continue;
+        snapTargets.append(model->segments().at(i).startMs);
+        snapTargets.append(model->segments().at(i).endMs);
+    }
     for (int i = 0; i < overlays.size(); ++i) {
-        if (timeMs >= overlays[i].startMs && timeMs < overlays[i].endMs) hits.append(i);
+        if (i == skipOverlay) continue;
+        snapTargets.append(model->overlays().at(i).startMs);
+        snapTargets.append(model->overlays().at(i).endMs);
+    }
+    // Onsets anywhere in each source, cut or not: extending a trim out to
+    // where speech starts is the point.
+    for (int i = 0; i < sources.size(); ++i) {
+        if (const WaveformPyramid *wave = sourceWaveform(i)) {
+            for (qint64 onset : wave->onsetsMs()) snapTargets.append(model->sources().at(i).offsetMs + onset);
+        }
     }
-    return hits;
+    std::sort(snapTargets.begin(), snapTargets.end());
+    snapTargets.erase(std::unique(snapTargets.begin(), snapTargets.end()), snapTargets.end());
 }
 
-// Greedy first-fit lane assignment so overlapping overlays stack instead of
-// drawing on top of each other (like calendar events).
-QVector<int> TimelineWidget::computeOverlayLanes() const {
-    QVector<int> lanes(overlays.size(), 0);
-    QList<int> order;
-    for (int i = 0; i < overlays.size(); ++i) order.append(i);
-    std::sort(order.begin(), order.end(), [this](int a, int b) {
-        return overlays[a].startMs < overlays[b].startMs;
+QList<int> TimelineWidget::overlaysAtTime(qint64 timeMs) const {
+    return ensureOverlayIndex().at(timeMs);
+}
+
+// Sweep over the sorted boundaries: at each one, drop the overlays ending
+// there and add the ones starting there (a zero-length overlay does both, so
+// it is never active, same as the [start, end) test it replaces).
+void TimelineWidget::ensureOverlaySchedule() const {
+    if (!overlayScheduleDirty) return;
+    overlayScheduleDirty = false;
+    ++overlayScheduleRev;
+
+    struct Boundary { qint64 timeMs; int idx; bool start; };
+    QVector<Boundary> boundaries;
+    boundaries.reserve(model->overlays().size() * 2);
+    for (int i = 0; i < model->overlays().size(); ++i) {
+        boundaries.append({model->overlays()[i].startMs, i, true});
+        boundaries.append({model->overlays()[i].endMs, i, false});
+    }
+    std::sort(boundaries.begin(), boundaries.end(), [](const Boundary &a, const Boundary &b) {
+        return a.timeMs < b.timeMs;
     });
 
-    QList<qint64> laneEnds;
-    for (int idx : order) {
-        int lane = -1;
-        for (int l = 0; l < laneEnds.size(); ++l) {
-            if (overlays[idx].startMs >= laneEnds[l]) { lane = l; break; }
+    overlayCuts.clear();
+    overlaySlots.clear();
+    QList<int> active;
+    for (int b = 0; b < boundaries.size();) {
+        const qint64 t = boundaries[b].timeMs;
+        for (; b < boundaries.size() && boundaries[b].timeMs == t; ++b) {
+            const int idx = boundaries[b].idx;
+            const auto pos = std::lower_bound(active.begin(), active.end(), idx);
+            const bool present = pos != active.end() && *pos == idx;
+            const bool live = model->overlays()[idx].startMs <= t && t < model->overlays()[idx].endMs;
+            if (live && !present) active.insert(pos, idx);
+            else if (!live && present) active.erase(pos);
         }
-        if (lane == -1) {
-            laneEnds.append(0);
-            lane = laneEnds.size() - 1;
-        }
-        laneEnds[lane] = overlays[idx].endMs;
-        lanes[idx] = lane;
+        overlayCuts.append(t);
+        overlaySlots.append(active);
     }
-    return lanes;
+}
+
+int TimelineWidget::overlaySlotAt(qint64 timeMs) const {
+    ensureOverlaySchedule();
+    const auto it = std::upper_bound(overlayCuts.cbegin(), overlayCuts.cend(), timeMs);
+    return static_cast<int>(it - overlayCuts.cbegin()) - 1;
+}
+
+const QList<int> &TimelineWidget::overlaysInSlot(int slot) const {
+    static const QList<int> none;
+    ensureOverlaySchedule();
+    return (slot >= 0 && slot < overlaySlots.size()) ? overlaySlots[slot] : none;
+}
+
+// Overlapping overlays stack on lanes instead of drawing on top of each
+// other (like calendar events); see OverlayIndex for how lanes are kept.
+const OverlayIndex &TimelineWidget::ensureOverlayIndex() const {
+    if (!overlayIndexDirty) return overlayIndex;
+    overlayIndexDirty = false;
+    QVector<OverlayIndex::Span> spans;
+    spans.reserve(model->overlays().size());
+    for (const auto &ov : model->overlays()) spans.append({ov.startMs, ov.endMs});
+    overlayIndex.rebuild(spans);
+    return overlayIndex;
+}
+
+QVector<int> TimelineWidget::computeOverlayLanes() const {
+    return ensureOverlayIndex().lanes();
 }
 
 int TimelineWidget::overlayLaneCount() const {
-    if (overlays.isEmpty()) return 0;
-    const QVector<int> lanes = computeOverlayLanes();
-    int maxLane = 0;
-    for (int l : lanes) maxLane = qMax(maxLane, l);
-    return maxLane + 1;
+    return ensureOverlayIndex().laneCount();
 }
 
 int TimelineWidget::videoTrackTop() const {
@@ -217,15 +352,15 @@ void TimelineWidget::relayout() {
     const int contentBottom = vTop + trackHeight + 15 + trackHeight + 18;
     setMinimumHeight(qMax(180, contentBottom));
     updateGeometry();
-    update();
+    invalidateScene();
 }
 
 double TimelineWidget::estimatedExportSizeMB() const {
-    if (sources.isEmpty()) return 0.0;
+    if (model->sources().isEmpty()) return 0.0;
     double estBytes = 0.0;
-    for (const auto &seg : segments) {
-        const int srcIdx = qBound(0, seg.sourceIdx, static_cast<int>(sources.size()) - 1);
-        const auto &src = sources[srcIdx];
+    for (const auto &seg : model->segments()) {
+        const int srcIdx = qBound(0, seg.sourceIdx, static_cast<int>(model->sources().size()) - 1);
+        const auto &src = model->sources()[srcIdx];
         if (src.durationMs <= 0) continue;
         const double timeRatio = static_cast<double>(seg.endMs - seg.startMs) / src.durationMs;
         const double spatial = (seg.cropRight - seg.cropLeft) * (seg.cropBottom - seg.cropTop);
@@ -236,18 +371,23 @@ double TimelineWidget::estimatedExportSizeMB() const {
 
 int TimelineWidget::overlayIndexAt(const QPoint &pos, OverlayDragMode *edge) const {
     if (edge) *edge = OvNone;
-    if (overlays.isEmpty() || durationMs <= 0) return -1;
+    if (model->overlays().isEmpty() || durationMs <= 0) return -1;
 
     const int viewWidth = width() - sidebarWidth;
     const double pxPerMs = static_cast<double>(viewWidth) * zoomFactor / durationMs;
     const int drawX = pos.x() - sidebarWidth + scrollOffset;
-    const QVector<int> lanes = computeOverlayLanes();
-
-    for (int i = overlays.size() - 1; i >= 0; --i) {
+    const OverlayIndex &index = ensureOverlayIndex();
+    const QVector<int> &lanes = index.lanes();
+
+    // Only clips within the grab margin of the cursor's time can be hit.
+    const QList<int> near = index.touching(static_cast<qint64>((drawX - 7) / pxPerMs),
+                                           static_cast<qint64>(std::ceil((drawX + 7) / pxPerMs)));
+    for (auto it = near.crbegin(); it != near.crend(); ++it) {
+        const int i = *it;
         const int laneY = overlayLanesTop() + lanes[i] * (overlayLaneHeight + overlayLaneGap);
         if (pos.y() < laneY || pos.y() > laneY + overlayLaneHeight) continue;
-        const int x1 = static_cast<int>(overlays[i].startMs * pxPerMs);
-        const int x2 = static_cast<int>(overlays[i].endMs * pxPerMs);
+        const int x1 = static_cast<int>(model->overlays()[i].startMs * pxPerMs);
+        const int x2 = static_cast<int>(model->overlays()[i].endMs * pxPerMs);
         if (drawX < x1 - 6 || drawX > x2 + 6) continue;
         if (edge) {
             if (qAbs(drawX - x1) < 8) *edge = OvStart;
@@ -261,46 +401,9 @@ int TimelineWidget::overlayIndexAt(const QPoint &pos, OverlayDragMode *edge) con
 
 // ============================ Multi-source ============================
 
-// Loads (or generates, via the same ffmpeg tile command the media bin uses)
-// a 10-frame filmstrip for an appended source so its timeline clip shows
-// thumbnails like the primary clip does.
-void TimelineWidget::ensureSourceFilmstrip(int sourceIdx) {
-    if (sourceIdx <= 0 || sourceIdx >= sources.size()) return;
-    if (sourceFilmstrips.contains(sourceIdx)) return;
-
-    const QString path = sources[sourceIdx].path;
-    const QString cachePath = QDir::tempPath() + "/potato_cache_" + QFileInfo(path).baseName() + ".jpg";
-
-    QImage strip;
-    if (QFile::exists(cachePath) && strip.load(cachePath)) {
-        sourceFilmstrips[sourceIdx] = strip;
-        update();
-        return;
-    }
-
-    auto *ffmpeg = new QProcess(this);
-    QStringList args;
-    args << "-y" << "-ss" << "0" << "-t" << "10" << "-i" << path
-         << "-vf" << "fps=1,scale=160:-1,tile=10x1"
-         << "-frames:v" << "1" << "-preset" << "ultrafast" << cachePath;
-    connect(ffmpeg, &QProcess::finished, this, [this, ffmpeg, sourceIdx, cachePath]() {
-        QImage loaded;
-        if (loaded.load(cachePath)) {
-            sourceFilmstrips[sourceIdx] = loaded;
-            update();
-        }
-        ffmpeg->deleteLater();
-    });
-#ifdef Q_OS_WIN
-    ffmpeg->start(QCoreApplication::applicationDirPath() + "/ffmpeg.exe", args);
-#else
-    ffmpeg->start("ffmpeg", args);
-#endif
-}
-
 int TimelineWidget::sourceIndexForTimelineTime(qint64 timeMs) const {
-    for (int i = sources.size() - 1; i >= 0; --i) {
-        if (timeMs >= sources[i].offsetMs) return i;
+    for (int i = model->sources().size() - 1; i >= 0; --i) {
+        if (timeMs >= model->sources()[i].offsetMs) return i;
     }
     return 0;
 }
@@ -310,7 +413,7 @@ void TimelineWidget::appendMediaSource(const QString &path) {
         showNotification("LOAD A CLIP FIRST");
         return;
     }
-    for (const auto &src : sources) {
+    for (const auto &src : model->sources()) {
         if (src.path == path) {
             showNotification("THAT FILE IS ALREADY ON THE TIMELINE");
             return;
@@ -348,8 +451,7 @@ void TimelineWidget::appendMediaSource(const QString &path) {
         src.fileSizeBytes = QFileInfo(path).size();
         src.hasVideo = srcHasVideo;
         src.hasAudio = srcHasAudio;
-        sources.append(src);
-        ensureSourceFilmstrip(sources.size() - 1);
+        model->appendSource(src);
 
         Segment seg;
         seg.startMs = src.offsetMs;
@@ -357,7 +459,7 @@ void TimelineWidget::appendMediaSource(const QString &path) {
         seg.sourceIdx = sources.size() - 1;
         seg.cropTop = 0.0f; seg.cropBottom = 1.0f;
         seg.cropLeft = 0.0f; seg.cropRight = 1.0f;
-        segments.append(seg);
+        model->insertSegment(segments.size(), seg);
 
         durationMs += src.durationMs;
         if (src.hasAudio) appendAudioWaveform(path);
@@ -379,7 +481,7 @@ void TimelineWidget::appendMediaSource(const QString &path) {
 void TimelineWidget::deleteSelectedSegment() {
     if (selectedSegmentIdx >= 0 && selectedSegmentIdx < segments.size()) {
         saveState("Delete clip");
-        segments.removeAt(selectedSegmentIdx);
+        model->removeSegments(selectedSegmentIdx, selectedSegmentIdx);
         selectedSegmentIdx = -1;
         showNotification("CLIP DELETED 🗑️");
         validatePlayheadPosition();
@@ -399,7 +501,7 @@ void TimelineWidget::deleteActiveSelection() {
     std::sort(sortedIndices.begin(), sortedIndices.end(), std::greater<int>());
     for (int idx : sortedIndices) {
         if (idx >= 0 && idx < static_cast<int>(segments.size())) {
-            segments.erase(segments.begin() + idx);
+            model->removeSegments(idx, idx);
         }
     }
 
@@ -414,51 +516,30 @@ void TimelineWidget::deleteActiveSelection() {
 void TimelineWidget::validatePlayheadPosition() {
     if (segments.isEmpty()) return;
 
-    int currentClipIdx = -1;
-    for (int i = 0; i < segments.size(); ++i) {
-        if (currentPosMs >= segments[i].startMs && currentPosMs < segments[i].endMs) {
-            currentClipIdx = i;
-            break;
-        }
-    }
+    const SegmentIndex &index = ensureSegmentIndex();
+    const int currentClipIdx = index.firstEndAfter(currentPosMs);
+    const bool inside = currentClipIdx < index.size() && index.startAt(currentClipIdx) <= currentPosMs;
 
-    if (currentClipIdx == -1) {
-        qint64 nextStart = -1;
-        for (const auto& clip : segments) {
-            if (clip.startMs >= currentPosMs) {
-                nextStart = clip.startMs;
-                break;
-            }
-        }
+    if (!inside) {
+        const int next = index.firstStartAtOrAfter(currentPosMs);
+        const qint64 nextStart = next < index.size() ? index.startAt(next) : -1;
 
         if (nextStart != -1) {
             currentPosMs = nextStart;
         } else {
-            currentPosMs = segments.first().startMs;
+            currentPosMs = model->segments().first().startMs;
         }
         emitVisualStateForCurrentContext();
         emit playheadMoved(currentPosMs);
     }
 }
 
-void TimelineWidget::paintEvent(QPaintEvent*) {
+void TimelineWidget::paintEvent(QPaintEvent *event) {
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
 
-    // Get Device Pixel Ratio for Windows High DPI Scaling
-    double dpr = this->devicePixelRatioF();
-
-    QColor accent = m_accentColor;
-    QColor secondary = m_secondaryColor;
-    QColor bg = m_backgroundColor;
-
     // ALWAYS draw background so widget is never invisible
-    painter.fillRect(rect(), bg);
-
-    int viewWidth = width() - sidebarWidth;
-    int contentWidth = viewWidth * zoomFactor;
-    const int vTop = videoTrackTop() + 8;
-    const int aTop = vTop + trackHeight + 15;
+    painter.fillRect(event->rect(), m_backgroundColor);
 
     // Safety check: if no duration, don't draw clips
     if (durationMs <= 0 || segments.isEmpty()) return;
@@ -467,220 +548,18 @@ void TimelineWidget::paintEvent(QPaintEvent*) {
     painter.setClipRect(sidebarWidth, 0, width() - sidebarWidth, height());
     painter.translate(sidebarWidth - scrollOffset, 0);
 
-    double pxPerMs = static_cast<double>(contentWidth) / durationMs;
-
-    // --- Lane bands: separate video/audio lanes like an NLE timeline ---
-    painter.fillRect(QRectF(0, vTop - 6, contentWidth, trackHeight + 12), m_trackColor.lighter(112));
-    if (!audioSamples.empty()) {
-        painter.fillRect(QRectF(0, aTop - 6, contentWidth, trackHeight + 12), m_trackColor);
-    }
-
-    // --- Overlay lanes (effects / text) above the video track ---
-    if (!overlays.isEmpty()) {
-        const QVector<int> lanes = computeOverlayLanes();
-        const int laneCount = overlayLaneCount();
-        for (int l = 0; l < laneCount; ++l) {
-            const int y = overlayLanesTop() + l * (overlayLaneHeight + overlayLaneGap);
-            painter.fillRect(QRectF(0, y, contentWidth, overlayLaneHeight), m_trackColor.darker(108));
-        }
-
-        QFont ovFont = painter.font();
-        ovFont.setPointSizeF(7.5);
-        ovFont.setBold(true);
-        painter.setFont(ovFont);
-
-        for (int i = 0; i < overlays.size(); ++i) {
-            const auto &ov = overlays[i];
-            const int y = overlayLanesTop() + lanes[i] * (overlayLaneHeight + overlayLaneGap);
-            QRectF r(ov.startMs * pxPerMs, y, qMax(6.0, (ov.endMs - ov.startMs) * pxPerMs), overlayLaneHeight);
-
-            // Per-type hue so lanes read at a glance
-            QColor base;
-            QString label;
-            switch (ov.type) {
-                case 0:  base = QColor("#5B8DEF"); label = "BLUR"; break;
-                case 1:  base = QColor("#9B6BE8"); label = "PIXEL"; break;
-                case 2:  base = QColor("#666B75"); label = "BLACK"; break;
-                default: base = QColor("#3FB68B");
-                         label = ov.text.isEmpty() ? "TEXT" : ov.text.left(24).toUpper(); break;
-            }
-            const bool sel = (i == selectedOverlayIdx);
-            QColor fill = base; fill.setAlpha(sel ? 200 : 120);
-            painter.setPen(sel ? QPen(Qt::white, 1.4) : QPen(base.lighter(115), 1));
-            painter.setBrush(fill);
-            painter.drawRoundedRect(r, 6, 6);
-
-            // Trim handles on the selected overlay
-            if (sel) {
-                painter.setBrush(Qt::white);
-                painter.setPen(Qt::NoPen);
-                painter.drawRoundedRect(QRectF(r.left() + 2, r.top() + 4, 3, r.height() - 8), 1.5, 1.5);
-                painter.drawRoundedRect(QRectF(r.right() - 5, r.top() + 4, 3, r.height() - 8), 1.5, 1.5);
-            }
-
-            painter.setPen(QColor(255, 255, 255, sel ? 255 : 210));
-            painter.drawText(r.adjusted(8, 0, -8, 0), Qt::AlignVCenter | Qt::AlignLeft,
-                             painter.fontMetrics().elidedText(label, Qt::ElideRight, static_cast<int>(r.width()) - 14));
-        }
-    }
-
-    // --- Ruler: tick marks + timecodes along the top, like an NLE ruler ---
-    {
-        static const qint64 kNiceIntervalsMs[] = {40, 100, 200, 500, 1000, 2000, 5000, 10000, 30000, 60000, 120000, 300000, 600000};
-        qint64 interval = kNiceIntervalsMs[0];
-        for (qint64 candidate : kNiceIntervalsMs) {
-            interval = candidate;
-            if (candidate * pxPerMs >= 76) break;
-        }
-
-        QFont tickFont = painter.font();
-        tickFont.setPointSizeF(7.5);
-        painter.setFont(tickFont);
-
-        for (qint64 t = 0; t <= durationMs; t += interval) {
-            const int x = static_cast<int>(t * pxPerMs);
-            painter.setPen(QPen(QColor(255, 255, 255, 55), 1));
-            painter.drawLine(x, rulerHeight - 8, x, rulerHeight);
-            painter.setPen(QColor(255, 255, 255, 115));
-            painter.drawText(QRect(x + 4, 1, 100, rulerHeight - 2), Qt::AlignLeft | Qt::AlignVCenter, formatTimelineDuration(t));
-        }
-        painter.setPen(QPen(QColor(255, 255, 255, 30), 1));
-        painter.drawLine(0, rulerHeight, contentWidth, rulerHeight);
-    }
-
-    // --- Markers: small triangles in the ruler, snap targets for trims/overlays ---
-    if (!markers.isEmpty()) {
-        painter.setPen(Qt::NoPen);
-        painter.setBrush(accent);
-        for (qint64 m : markers) {
-            const int x = static_cast<int>(m * pxPerMs);
-            QPolygon tri;
-            tri << QPoint(x - 5, rulerHeight - 1) << QPoint(x + 5, rulerHeight - 1) << QPoint(x, rulerHeight - 9);
-            painter.drawPolygon(tri);
-        }
-    }
-
-    for (int i = 0; i < segments.size(); ++i) {
-        QRectF clipRect(segments[i].startMs * pxPerMs, vTop, (segments[i].endMs - segments[i].startMs) * pxPerMs, trackHeight);
-        bool isSel = (i == selectedSegmentIdx) || selectedSegmentIndices.contains(i);
-
-        if (isSel) {
-            painter.setPen(QPen(accent, 2.5));
-            painter.setBrush(QColor(accent.red(), accent.green(), accent.blue(), 60));
-        } else {
-            painter.setPen(QPen(accent.darker(160), 1.0));
-            painter.setBrush(QColor(accent.red(), accent.green(), accent.blue(), 25));
-        }
-
-        painter.drawRoundedRect(clipRect, 6, 6);
-
-        if (!thumbnailCache.isEmpty() && segments[i].sourceIdx == 0) {
-            painter.save();
-            painter.setClipRect(clipRect.adjusted(2, 2, -2, -2));
-            painter.setOpacity(isSel ? 0.62 : 0.42);
-            const int thumbW = 88;
-            for (int x = static_cast<int>(clipRect.left()) + 4; x < clipRect.right(); x += thumbW) {
-                const qint64 timeAtX = qBound<qint64>(segments[i].startMs,
-                    static_cast<qint64>(x / pxPerMs), segments[i].endMs);
-                const int sec = static_cast<int>(timeAtX / 1000);
-                if (!thumbnailCache.contains(sec)) continue;
-                QRect target(x, static_cast<int>(clipRect.top()) + 3, thumbW - 4, trackHeight - 6);
-                painter.drawImage(target, thumbnailCache.value(sec));
-            }
-            painter.restore();
-        }
-
-        // Appended clips: filmstrip slices (10 frames over the source's first
-        // 10 s) + the source filename as a label.
-        if (segments[i].sourceIdx > 0 && segments[i].sourceIdx < sources.size()) {
-            const int srcIdx = segments[i].sourceIdx;
-            if (sourceFilmstrips.contains(srcIdx)) {
-                const QImage &strip = sourceFilmstrips[srcIdx];
-                const int frameW = qMax(1, strip.width() / 10);
-                painter.save();
-                painter.setClipRect(clipRect.adjusted(2, 2, -2, -2));
-                painter.setOpacity(isSel ? 0.62 : 0.42);
-                const int thumbW = 88;
-                for (int x = static_cast<int>(clipRect.left()) + 4; x < clipRect.right(); x += thumbW) {
-                    const qint64 timeAtX = qBound<qint64>(segments[i].startMs,
-                        static_cast<qint64>(x / pxPerMs), segments[i].endMs);
-                    const int localSec = static_cast<int>((timeAtX - sources[srcIdx].offsetMs) / 1000);
-                    const int frameIdx = qBound(0, localSec, 9);
-                    QRect target(x, static_cast<int>(clipRect.top()) + 3, thumbW - 4, trackHeight - 6);
-                    painter.drawImage(target, strip, QRect(frameIdx * frameW, 0, frameW, strip.height()));
-                }
-                painter.restore();
-            }
-            painter.save();
-            QFont srcFont = painter.font();
-            srcFont.setPointSizeF(8);
-            srcFont.setBold(true);
-            painter.setFont(srcFont);
-            painter.setPen(QColor(255, 255, 255, 190));
-            const QString name = QFileInfo(sources[segments[i].sourceIdx].path).fileName();
-            painter.drawText(clipRect.adjusted(10, 0, -10, 0), Qt::AlignVCenter | Qt::AlignLeft,
-                             painter.fontMetrics().elidedText(name, Qt::ElideMiddle, static_cast<int>(clipRect.width()) - 20));
-            painter.restore();
-        }
-
-        if (segments[i].cropTop > 0.001f || segments[i].cropBottom < 0.999f ||
-            segments[i].cropLeft > 0.001f || segments[i].cropRight < 0.999f) {
-            painter.save();
-            painter.setPen(Qt::NoPen);
-            painter.setBrush(QColor(accent.red(), accent.green(), accent.blue(), 95));
-            painter.drawRoundedRect(QRectF(clipRect.left() + 6, clipRect.top() + 6, 36, 14), 4, 4);
-            QFont fxFont = painter.font();
-            fxFont.setPointSizeF(7);
-            fxFont.setBold(true);
-            painter.setFont(fxFont);
-            painter.setPen(Qt::white);
-            painter.drawText(QRectF(clipRect.left() + 6, clipRect.top() + 5, 36, 15), Qt::AlignCenter, "CROP");
-            painter.restore();
-        }
-
-        // Draw Gain Label (Visual Feedback)
-        if (segments[i].gain != 1.0f) {
-            painter.save();
-            painter.setPen(Qt::white);
-            QFont labelFont = painter.font(); labelFont.setPointSizeF(7);
-            painter.setFont(labelFont);
-            painter.drawText(clipRect.adjusted(5, 2, 0, 0), Qt::AlignTop | Qt::AlignLeft,
-                             QString("%1x").arg(segments[i].gain, 0, 'f', 1));
-            painter.restore();
-        }
-
-        // Waveforms using segment-specific gain
-        if (!audioSamples.empty()) {
-            QColor currentWaveColor = isSel ? accent : accent.darker(180);
-            painter.setPen(QPen(currentWaveColor, 1));
-
-            int startIdx = (segments[i].startMs * audioSamples.size()) / durationMs;
-            int endIdx = (segments[i].endMs * audioSamples.size()) / durationMs;
-
-            // PERFORMANCE OPTIMIZATION: Only draw one line per pixel to save CPU/GPU cycles
-            // especially important on 4K displays where the timeline can be very wide.
-            double samplesPerPixel = (double)audioSamples.size() / contentWidth;
-            int step = qMax(1, (int)samplesPerPixel);
-
-            for (int s = startIdx; s < endIdx && s < (int)audioSamples.size(); s += step) {
-                int x = (s * (double)contentWidth) / audioSamples.size();
-                
-                // Find max in this pixel range for a better visual representation
-                float maxInStep = 0.0f;
-                for (int j = 0; j < step && (s + j) < endIdx && (s + j) < (int)audioSamples.size(); ++j) {
-                    maxInStep = qMax(maxInStep, audioSamples[s + j]);
-                }
-
-                float norm = (maxInStep / maxAmplitude) * segments[i].gain;
-                int h = qMin((float)trackHeight, norm * (trackHeight - 10));
-                painter.drawLine(x, aTop + (trackHeight/2) - h/2, x, aTop + (trackHeight/2) + h/2);
-            }
-        }
-    }
-
-    // Playhead
-    int playheadX = currentPosMs * pxPerMs;
-    QColor pulseColor = secondary;
+    // Static layers come from the tile cache (timelineTiles.cpp); only the
+    // selection and what moves every frame are drawn here.
+    const QRect contentRect = event->rect().translated(scrollOffset - sidebarWidth, 0);
+    paintTiles(painter, contentRect);
+    paintSelection(painter, contentRect);
+    const double pxPerMs = static_cast<double>(tileGeometry.contentWidth) / durationMs;
+
+    // Playhead. A partial repaint draws it exactly where updatePlayhead()
+    // put the strips; asking the clock again here could land it outside.
+    if (event->rect().contains(rect())) paintedPlayheadMs = playheadDrawMs();
+    int playheadX = paintedPlayheadMs * pxPerMs;
+    QColor pulseColor = m_secondaryColor;
     pulseColor.setAlphaF(pulseAlpha);
 
     painter.setPen(Qt::NoPen);
@@ -692,7 +571,6 @@ void TimelineWidget::paintEvent(QPaintEvent*) {
     painter.setPen(QPen(pulseColor, 2));
     painter.drawLine(playheadX, 12, playheadX, height());
     painter.restore();
-
 }
 
 void TimelineWidget::updateCropValues(float t, float b, float l, float r) {
@@ -700,33 +578,64 @@ void TimelineWidget::updateCropValues(float t, float b, float l, float r) {
     cropBottom = b;
     cropLeft = l;
     cropRight = r;
-    for (int idx : targetVisualSegments()) {
+    const QSet<int> targets = targetVisualSegments();
+    for (int idx : targets) {
         if (idx >= 0 && idx < segments.size()) {
-            segments[idx].cropTop = cropTop;
-            segments[idx].cropBottom = cropBottom;
-            segments[idx].cropLeft = cropLeft;
-            segments[idx].cropRight = cropRight;
+            Segment seg = segments[idx];
+            seg.cropTop = cropTop;
+            seg.cropBottom = cropBottom;
+            seg.cropLeft = cropLeft;
+            seg.cropRight = cropRight;
+            model->setSegment(idx, seg, TimelineModel::Geometry);
         }
     }
     update();
 }
 
+const SegmentIndex &TimelineWidget::ensureSegmentIndex() const {
+    if (segmentIndexRevision == segmentRevision) return segmentIndex;
+    segmentIndexRevision = segmentRevision;
+    QVector<SegmentIndex::Span> spans;
+    spans.reserve(model->segments().size());
+    for (const auto &seg : model->segments()) spans.append({seg.startMs, seg.endMs, seg.speedStart, seg.speedEnd});
+    segmentIndex.rebuild(spans);
+    return segmentIndex;
+}
+
 int TimelineWidget::segmentIndexAtTime(qint64 timeMs) const {
-    for (int i = 0; i < segments.size(); ++i) {
-        if (timeMs >= segments[i].startMs && timeMs <= segments[i].endMs) return i;
+    return ensureSegmentIndex().indexAt(timeMs);
+}
+
+// First segment with an edge within grabbing distance of drawX (content
+// pixels), as the trim handles are hit-tested; -1 if none.
+int TimelineWidget::segmentEdgeAt(int drawX, double pxPerMs, bool *isStart) const {
+    const SegmentIndex &index = ensureSegmentIndex();
+    const qint64 lo = static_cast<qint64>((drawX - 13) / pxPerMs);
+    const qint64 hi = static_cast<qint64>(std::ceil((drawX + 13) / pxPerMs));
+    const int first = qMin(index.firstStartAtOrAfter(lo), index.firstEndAtOrAfter(lo));
+    const int last = qMax(index.firstStartAfter(hi), index.firstEndAfter(hi));
+    for (int i = first; i < last; ++i) {
+        if (std::abs(drawX - static_cast<int>(index.startAt(i) * pxPerMs)) < 12) {
+            *isStart = true;
+            return i;
+        }
+        if (std::abs(drawX - static_cast<int>(index.endAt(i) * pxPerMs)) < 12) {
+            *isStart = false;
+            return i;
+        }
     }
     return -1;
 }
 
 int TimelineWidget::activeVisualSegmentIndex() const {
-    if (selectedSegmentIdx >= 0 && selectedSegmentIdx < segments.size()) return selectedSegmentIdx;
+    if (selectedSegmentIdx >= 0 && selectedSegmentIdx < model->segments().size()) return selectedSegmentIdx;
     if (!selectedSegmentIndices.isEmpty()) return *selectedSegmentIndices.constBegin();
     return segmentIndexAtTime(currentPosMs);
 }
 
 QSet<int> TimelineWidget::targetVisualSegments() const {
     QSet<int> targets = selectedSegmentIndices;
-    if (selectedSegmentIdx >= 0 && selectedSegmentIdx < segments.size()) targets.insert(selectedSegmentIdx);
+    if (selectedSegmentIdx >= 0 && selectedSegmentIdx < model->segments().size()) targets.insert(selectedSegmentIdx);
     if (targets.isEmpty()) {
         const int activeIdx = segmentIndexAtTime(currentPosMs);
         if (activeIdx >= 0) targets.insert(activeIdx);
@@ -745,10 +654,12 @@ void TimelineWidget::applyCurrentVisualsToSelection(bool allSegments) {
 
     for (int idx : targets) {
         if (idx < 0 || idx >= segments.size()) continue;
-        segments[idx].cropTop = cropTop;
-        segments[idx].cropBottom = cropBottom;
-        segments[idx].cropLeft = cropLeft;
-        segments[idx].cropRight = cropRight;
+        Segment seg = segments[idx];
+        seg.cropTop = cropTop;
+        seg.cropBottom = cropBottom;
+        seg.cropLeft = cropLeft;
+        seg.cropRight = cropRight;
+        model->setSegment(idx, seg, TimelineModel::Geometry);
     }
 
     showNotification(allSegments ? "CROP APPLIED TO ALL CLIPS" : "CROP APPLIED TO CLIP");
@@ -767,10 +678,12 @@ void TimelineWidget::clearVisualsForSelection(bool allSegments) {
 
     for (int idx : targets) {
         if (idx < 0 || idx >= segments.size()) continue;
-        segments[idx].cropTop = 0.0f;
-        segments[idx].cropBottom = 1.0f;
-        segments[idx].cropLeft = 0.0f;
-        segments[idx].cropRight = 1.0f;
+        Segment seg = segments[idx];
+        seg.cropTop = 0.0f;
+        seg.cropBottom = 1.0f;
+        seg.cropLeft = 0.0f;
+        seg.cropRight = 1.0f;
+        model->setSegment(idx, seg, TimelineModel::Geometry);
     }
 
     emitVisualStateForCurrentContext();
@@ -790,8 +703,10 @@ void TimelineWidget::applySpeedRampToSelection(float speedStart, float speedEnd,
 
     for (int idx : targets) {
         if (idx < 0 || idx >= segments.size()) continue;
-        segments[idx].speedStart = qMax(0.1f, speedStart);
-        segments[idx].speedEnd = qMax(0.1f, speedEnd);
+        Segment seg = segments[idx];
+        seg.speedStart = qMax(0.1f, speedStart);
+        seg.speedEnd = qMax(0.1f, speedEnd);
+        model->setSegment(idx, seg, TimelineModel::Speed);
     }
 
     showNotification(allSegments ? "SPEED RAMP APPLIED TO ALL CLIPS" : "SPEED RAMP APPLIED TO CLIP");
@@ -801,8 +716,8 @@ void TimelineWidget::applySpeedRampToSelection(float speedStart, float speedEnd,
 
 bool TimelineWidget::visualStateForCurrentContext(float &t, float &b, float &l, float &r) const {
     const int idx = activeVisualSegmentIndex();
-    if (idx < 0 || idx >= segments.size()) return false;
-    const auto &seg = segments[idx];
+    if (idx < 0 || idx >= model->segments().size()) return false;
+    const auto &seg = model->segments()[idx];
     t = seg.cropTop;
     b = seg.cropBottom;
     l = seg.cropLeft;
@@ -829,6 +744,7 @@ void TimelineWidget::setZoomFactor(double z) {
                           qMax(0, static_cast<int>(viewWidth * zoomFactor) - viewWidth));
     emit zoomChanged(zoomFactor);
     update();
+    scheduleThumbnails();
 }
 
 void TimelineWidget::resetZoomView() {
@@ -836,6 +752,7 @@ void TimelineWidget::resetZoomView() {
     scrollOffset = 0;
     emit zoomChanged(zoomFactor);
     update();
+    scheduleThumbnails();
 }
 
 void TimelineWidget::forceFitToDuration() {
@@ -844,12 +761,15 @@ void TimelineWidget::forceFitToDuration() {
         this->scrollOffset = 0;
 
         if (!segments.isEmpty()) {
-            segments[0].startMs = 0;
-            segments[0].endMs = durationMs;
+            Segment first = segments[0];
+            first.startMs = 0;
+            first.endMs = durationMs;
+            model->setSegment(0, first, TimelineModel::Timing);
         }
 
         emit clipTrimmed();
         this->update();
+        scheduleThumbnails();
     }
 }
 
@@ -898,14 +818,14 @@ void TimelineWidget::dropEvent(QDropEvent *event) {
 void TimelineWidget::mouseDoubleClickEvent(QMouseEvent *event) {
     OverlayDragMode edge;
     const int idx = overlayIndexAt(event->pos(), &edge);
-    if (idx != -1 && overlays[idx].type == 3) {
+    if (idx != -1 && model->overlays()[idx].type == 3) {
         selectedOverlayIdx = idx;
         update();
         emit overlaysChanged();
         emit requestEditTextOverlay(idx);
         return;
     }
-    if (idx != -1 && (overlays[idx].type == 4 || overlays[idx].type == 5)) {
+    if (idx != -1 && (model->overlays()[idx].type == 4 || model->overlays()[idx].type == 5 || model->overlays()[idx].type == 6)) {
         selectedOverlayIdx = idx;
         update();
         emit overlaysChanged();
@@ -27,9 +27,9 @@ void TimelineWidget::undo() {
     currentState.label = previousState.label;
     redoStack.append(currentState);
 
-    this->segments = previousState.segments;
-    this->overlays = previousState.overlays;
-    this->markers = previousState.markers;
+    model->setSegments(previousState.segments);
+    model->setOverlays(previousState.overlays);
+    model->setMarkers(previousState.markers);
 
     selectedSegmentIndices.clear();
     selectedSegmentIdx = -1;
@@ -54,9 +54,9 @@ void TimelineWidget::redo() {
     currentState.label = futureState.label;
     undoStack.append(currentState);
 
-    this->segments = futureState.segments;
-    this->overlays = futureState.overlays;
-    this->markers = futureState.markers;
+    model->setSegments(futureState.segments);
+    model->setOverlays(futureState.overlays);
+    model->setMarkers(futureState.markers);
 
     if (selectedOverlayIdx >= overlays.size()) selectedOverlayIdx = -1;
     relayout();
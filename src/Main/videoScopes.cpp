@@ -0,0 +1,279 @@
+#include "../Includes/videoScopes.h"
+#include "../Includes/workerPools.h"
+
+#include <QPainter>
+#include <QPainterPath>
+#include <QThread>
+#include <QtConcurrent>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VIDEO_SCOPES_SSE2 1
+#include <emmintrin.h>
+#endif
+
+using namespace VideoScopes;
+
+namespace {
+
+// BT.709 full-range RGB -> Y'CbCr in 8.8 fixed point (rows sum to 256 / 0).
+constexpr int kYr = 54, kYg = 183, kYb = 19;
+constexpr int kCbr = 29, kCbg = 99;  // Cb = (128 b - 29 r - 99 g) / 256
+constexpr int kCrg = 116, kCrb = 12; // Cr = (128 r - 116 g - 12 b) / 256
+
+// (d + 128) >> 8 without the 16-bit overflow of adding first.
+inline int roundShift8(int d) { return ((d >> 7) + 1) >> 1; }
+
+inline quint8 chromaByte(int d) { return static_cast<quint8>(qMin(255, roundShift8(d) + 128)); }
+
+// One row of 0xAARRGGBB pixels to separate Y / Cb / Cr byte rows. The
+// per-pixel bin increments that follow are scattered writes; this is the
+// arithmetic part, eight pixels per step in 16-bit lanes.
+void convertRow(const quint32 *px, int n, quint8 *luma, quint8 *cb, quint8 *cr) {
+    int x = 0;
+#ifdef VIDEO_SCOPES_SSE2
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i half = _mm_set1_epi16(128);
+    const __m128i yr = _mm_set1_epi16(kYr), yg = _mm_set1_epi16(kYg), yb = _mm_set1_epi16(kYb);
+    const __m128i cbr = _mm_set1_epi16(kCbr), cbg = _mm_set1_epi16(kCbg);
+    const __m128i crg = _mm_set1_epi16(kCrg), crb = _mm_set1_epi16(kCrb);
+    for (; x + 8 <= n; x += 8) {
+        const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(px + x));
+        const __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(px + x + 4));
+        const __m128i b = _mm_packs_epi32(_mm_and_si128(p0, mask), _mm_and_si128(p1, mask));
+        const __m128i g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), mask),
+                                          _mm_and_si128(_mm_srli_epi32(p1, 8), mask));
+        const __m128i r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), mask),
+                                          _mm_and_si128(_mm_srli_epi32(p1, 16), mask));
+        // Luma tops out at 255 * 256 + 128, which still fits unsigned 16 bits.
+        const __m128i y = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(r, yr), _mm_mullo_epi16(g, yg)),
+                                                       _mm_add_epi16(_mm_mullo_epi16(b, yb), half)), 8);
+        const __m128i dcb = _mm_sub_epi16(_mm_slli_epi16(b, 7), _mm_add_epi16(_mm_mullo_epi16(r, cbr), _mm_mullo_epi16(g, cbg)));
+        const __m128i dcr = _mm_sub_epi16(_mm_slli_epi16(r, 7), _mm_add_epi16(_mm_mullo_epi16(g, crg), _mm_mullo_epi16(b, crb)));
+        const __m128i u = _mm_add_epi16(_mm_srai_epi16(_mm_add_epi16(_mm_srai_epi16(dcb, 7), one), 1), half);
+        const __m128i v = _mm_add_epi16(_mm_srai_epi16(_mm_add_epi16(_mm_srai_epi16(dcr, 7), one), 1), half);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(luma + x), _mm_packus_epi16(y, y));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(cb + x), _mm_packus_epi16(u, u));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(cr + x), _mm_packus_epi16(v, v));
+    }
+#endif
+    for (; x < n; ++x) {
+        const int r = (px[x] >> 16) & 0xFF, g = (px[x] >> 8) & 0xFF, b = px[x] & 0xFF;
+        luma[x] = static_cast<quint8>((kYr * r + kYg * g + kYb * b + 128) >> 8);
+        cb[x] = chromaByte(128 * b - kCbr * r - kCbg * g);
+        cr[x] = chromaByte(128 * r - kCrg * g - kCrb * b);
+    }
+}
+
+// Counts -> premultiplied trace color. sqrt keeps sparse traces visible
+// without letting dense areas saturate the whole plot.
+void renderDensity(const quint32 *counts, QImage &img, int columns, int rows, bool columnMajor, double fullAt,
+                   QRgb color) {
+    std::array<QRgb, 256> shades;
+    for (int a = 0; a < 256; ++a) shades[a] = qPremultiply(qRgba(qRed(color), qGreen(color), qBlue(color), a));
+    const double scale = 1.0 / qMax(1.0, fullAt);
+    for (int row = 0; row < rows; ++row) {
+        QRgb *line = reinterpret_cast<QRgb *>(img.scanLine(row));
+        for (int col = 0; col < columns; ++col) {
+            // Top row is the highest level.
+            const quint32 count = columnMajor ? counts[col * rows + (rows - 1 - row)] : counts[(rows - 1 - row) * columns + col];
+            line[col] = count ? shades[qMin(255, qMax(40, int(std::sqrt(count * scale) * 255)))] : 0u;
+        }
+    }
+}
+
+}
+
+ScopeAnalyzer::ScopeAnalyzer(QObject *parent) : QObject(parent) {
+    m_clock.start();
+}
+
+ScopeAnalyzer::~ScopeAnalyzer() {
+    while (m_busy.loadAcquire()) QThread::yieldCurrentThread();
+}
+
+void ScopeAnalyzer::setRate(int perSecond) {
+    m_rate.store(qMax(0, perSecond), std::memory_order_relaxed);
+}
+
+void ScopeAnalyzer::offer(const QImage &frame) {
+    const int perSecond = rate();
+    if (perSecond <= 0 || frame.isNull() || frame.depth() != 32) return;
+    if (m_busy.loadAcquire()) return;
+    const qint64 now = m_clock.elapsed();
+    if (m_lastSampleMs >= 0 && now - m_lastSampleMs < 1000 / perSecond) return;
+    m_lastSampleMs = now;
+
+    // Nearest-sampled copy a few hundred pixels wide: enough for every scope
+    // here, and cheap enough to take on the worker right after it publishes.
+    const int sw = qMin(kMaxSampleWidth, frame.width());
+    const int sh = qMax(1, int(qint64(frame.height()) * sw / frame.width()));
+    if (m_sample.size() != QSize(sw, sh)) m_sample = QImage(sw, sh, QImage::Format_RGB32);
+    const quint32 step = (quint32(frame.width()) << 16) / sw;
+    for (int y = 0; y < sh; ++y) {
+        const quint32 *src = reinterpret_cast<const quint32 *>(frame.constScanLine(int(qint64(y) * frame.height() / sh)));
+        quint32 *dst = reinterpret_cast<quint32 *>(m_sample.scanLine(y));
+        quint32 pos = 0;
+        for (int x = 0; x < sw; ++x, pos += step) dst[x] = src[pos >> 16];
+    }
+
+    m_busy.storeRelease(1);
+    (void)WorkerPools::run(WorkerPools::Analysis, [this]() {
+        analyze();
+        m_busy.storeRelease(0);
+    });
+}
+
+void ScopeAnalyzer::analyze() {
+    const int w = m_sample.width();
+    const int h = m_sample.height();
+    const int columns = qMin(kWaveformColumns, w);
+    if (int(m_luma.size()) < w) {
+        m_luma.resize(w);
+        m_cb.resize(w);
+        m_cr.resize(w);
+    }
+    if (int(m_columnBin.size()) != w) {
+        m_columnBin.resize(w);
+        for (int x = 0; x < w; ++x) m_columnBin[x] = (x * columns / w) * kLevels;
+    }
+    m_waveCounts.assign(size_t(columns) * kLevels, 0);
+    m_vectorCounts.assign(size_t(kVectorSize) * kVectorSize, 0);
+
+    VideoScopes::ScopeFrame &out = m_results.back();
+    for (auto &channel : out.histogram) channel.fill(0);
+    quint32 *red = out.histogram[0].data();
+    quint32 *green = out.histogram[1].data();
+    quint32 *blue = out.histogram[2].data();
+    quint32 *wave = m_waveCounts.data();
+    quint32 *vector = m_vectorCounts.data();
+    constexpr int chromaShift = 1; // 256 levels -> kVectorSize bins
+    static_assert(kVectorSize == (256 >> chromaShift), "vectorscope bins");
+
+    for (int y = 0; y < h; ++y) {
+        const quint32 *row = reinterpret_cast<const quint32 *>(m_sample.constScanLine(y));
+        convertRow(row, w, m_luma.data(), m_cb.data(), m_cr.data());
+        for (int x = 0; x < w; ++x) {
+            const quint32 px = row[x];
+            ++red[(px >> 16) & 0xFF];
+            ++green[(px >> 8) & 0xFF];
+            ++blue[px & 0xFF];
+            ++wave[m_columnBin[x] + m_luma[x]];
+            ++vector[(m_cr[x] >> chromaShift) * kVectorSize + (m_cb[x] >> chromaShift)];
+        }
+    }
+
+    quint32 peak = 1;
+    for (const auto &channel : out.histogram) peak = qMax(peak, *std::max_element(channel.begin() + 1, channel.end() - 1));
+    out.histogramPeak = peak;
+
+    if (out.waveform.size() != QSize(columns, kLevels)) {
+        out.waveform = QImage(columns, kLevels, QImage::Format_ARGB32_Premultiplied);
+    }
+    if (out.vectorscope.isNull()) out.vectorscope = QImage(kVectorSize, kVectorSize, QImage::Format_ARGB32_Premultiplied);
+    // A cell holding ~1/48 of its column (waveform) or ~1/1024 of the frame
+    // (vectorscope) reads at full brightness.
+    renderDensity(wave, out.waveform, columns, kLevels, true, double(w) * h / columns / 48.0, qRgb(150, 255, 170));
+    renderDensity(vector, out.vectorscope, kVectorSize, kVectorSize, false, double(w) * h / 1024.0, qRgb(235, 235, 245));
+    out.valid = true;
+
+    m_results.publish();
+    emit updated();
+}
+
+ScopesWidget::ScopesWidget(ScopeAnalyzer *analyzer, QWidget *parent) : QWidget(parent), m_analyzer(analyzer) {
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    connect(m_analyzer, &ScopeAnalyzer::updated, this, [this]() {
+        if (m_analyzer->takeLatest()) update();
+    });
+}
+
+void ScopesWidget::setRefreshRate(int perSecond) {
+    m_refreshRate = qBound(1, perSecond, 60);
+    if (isVisible()) m_analyzer->setRate(m_refreshRate);
+}
+
+void ScopesWidget::showEvent(QShowEvent *event) {
+    QWidget::showEvent(event);
+    m_analyzer->setRate(m_refreshRate);
+}
+
+void ScopesWidget::hideEvent(QHideEvent *event) {
+    QWidget::hideEvent(event);
+    m_analyzer->setRate(0);
+}
+
+void ScopesWidget::paintEvent(QPaintEvent *) {
+    QPainter p(this);
+    p.fillRect(rect(), QColor("#0B0B0E"));
+    const QColor gridColor("#2A2A33");
+    const QColor labelColor("#8B8B97");
+    QFont labelFont = font();
+    labelFont.setPointSize(8);
+    labelFont.setBold(true);
+    p.setFont(labelFont);
+
+    // Vectorscope square on the right, waveform and histogram share the rest.
+    const int pad = 8;
+    const QRect inner = rect().adjusted(pad, pad, -pad, -pad);
+    const int side = inner.height();
+    const QRect vectorRect(inner.right() - side + 1, inner.top(), side, side);
+    const int rest = vectorRect.left() - pad - inner.left();
+    const QRect waveRect(inner.left(), inner.top(), rest * 3 / 5, inner.height());
+    const QRect histRect(waveRect.right() + pad + 1, inner.top(), rest - waveRect.width() - pad, inner.height());
+
+    const VideoScopes::ScopeFrame &scopes = m_analyzer->latest();
+    p.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    // Waveform: graticule every 25% of the luma range.
+    p.setPen(gridColor);
+    p.drawRect(waveRect.adjusted(0, 0, -1, -1));
+    for (int i = 1; i < 4; ++i) {
+        const int y = waveRect.top() + waveRect.height() * i / 4;
+        p.drawLine(waveRect.left(), y, waveRect.right(), y);
+    }
+    if (scopes.valid) p.drawImage(waveRect, scopes.waveform);
+
+    // Histogram: the three channels added on top of each other.
+    p.setPen(gridColor);
+    p.drawRect(histRect.adjusted(0, 0, -1, -1));
+    if (scopes.valid && histRect.width() > 2) {
+        p.save();
+        p.setRenderHint(QPainter::Antialiasing);
+        p.setCompositionMode(QPainter::CompositionMode_Plus);
+        p.setPen(Qt::NoPen);
+        const QColor channelColors[3] = {QColor(220, 60, 60, 170), QColor(60, 200, 80, 170), QColor(70, 110, 235, 170)};
+        const qreal xStep = qreal(histRect.width()) / (kLevels - 1);
+        for (int c = 0; c < 3; ++c) {
+            QPainterPath path(QPointF(histRect.left(), histRect.bottom() + 1));
+            for (int i = 0; i < kLevels; ++i) {
+                const qreal level = qMin(1.0, qreal(scopes.histogram[c][i]) / scopes.histogramPeak);
+                path.lineTo(histRect.left() + i * xStep, histRect.bottom() + 1 - level * histRect.height());
+            }
+            path.lineTo(histRect.right() + 1, histRect.bottom() + 1);
+            path.closeSubpath();
+            p.setBrush(channelColors[c]);
+            p.drawPath(path);
+        }
+        p.restore();
+    }
+
+    // Vectorscope: saturation rings at 50% and 100%, neutral crosshair.
+    p.save();
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setPen(gridColor);
+    p.drawEllipse(QRectF(vectorRect).adjusted(0.5, 0.5, -0.5, -0.5));
+    p.drawEllipse(QRectF(vectorRect).center(), side / 4.0, side / 4.0);
+    p.drawLine(QPointF(vectorRect.center().x() + 0.5, vectorRect.top()), QPointF(vectorRect.center().x() + 0.5, vectorRect.bottom()));
+    p.drawLine(QPointF(vectorRect.left(), vectorRect.center().y() + 0.5), QPointF(vectorRect.right(), vectorRect.center().y() + 0.5));
+    p.restore();
+    if (scopes.valid) p.drawImage(vectorRect, scopes.vectorscope);
+
+    p.setPen(labelColor);
+    p.drawText(waveRect.adjusted(6, 4, 0, 0), Qt::AlignLeft | Qt::AlignTop, "WAVEFORM");
+    p.drawText(histRect.adjusted(6, 4, 0, 0), Qt::AlignLeft | Qt::AlignTop, "RGB");
+    p.drawText(vectorRect.adjusted(6, 4, 0, 0), Qt::AlignLeft | Qt::AlignTop, "VECTOR");
+}
@@ -0,0 +1,176 @@
+#include "../Includes/waveformPyramid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WAVEFORM_PYRAMID_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Min, max and sum of squares of `count` samples: eight per step in 16-bit
+// lanes, squares summed pairwise by madd and widened to 64 bits (a pair of
+// full-scale samples is 2^31, which only fits unsigned).
+void summarize(const qint16 *pcm, qsizetype count, int &lo, int &hi, qint64 &energy) {
+    lo = pcm[0];
+    hi = pcm[0];
+    energy = 0;
+    qsizetype i = 0;
+#ifdef WAVEFORM_PYRAMID_SSE2
+    if (count >= 8) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i vmin = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pcm));
+        __m128i vmax = vmin;
+        __m128i vsum = zero;
+        for (; i + 8 <= count; i += 8) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pcm + i));
+            vmin = _mm_min_epi16(vmin, v);
+            vmax = _mm_max_epi16(vmax, v);
+            const __m128i squares = _mm_madd_epi16(v, v);
+            vsum = _mm_add_epi64(vsum, _mm_unpacklo_epi32(squares, zero));
+            vsum = _mm_add_epi64(vsum, _mm_unpackhi_epi32(squares, zero));
+        }
+        vmin = _mm_min_epi16(vmin, _mm_shuffle_epi32(vmin, _MM_SHUFFLE(1, 0, 3, 2)));
+        vmin = _mm_min_epi16(vmin, _mm_shuffle_epi32(vmin, _MM_SHUFFLE(2, 3, 0, 1)));
+        vmin = _mm_min_epi16(vmin, _mm_shufflelo_epi16(vmin, _MM_SHUFFLE(2, 3, 0, 1)));
+        vmax = _mm_max_epi16(vmax, _mm_shuffle_epi32(vmax, _MM_SHUFFLE(1, 0, 3, 2)));
+        vmax = _mm_max_epi16(vmax, _mm_shuffle_epi32(vmax, _MM_SHUFFLE(2, 3, 0, 1)));
+        vmax = _mm_max_epi16(vmax, _mm_shufflelo_epi16(vmax, _MM_SHUFFLE(2, 3, 0, 1)));
+        vsum = _mm_add_epi64(vsum, _mm_unpackhi_epi64(vsum, vsum));
+        lo = qint16(_mm_cvtsi128_si32(vmin));
+        hi = qint16(_mm_cvtsi128_si32(vmax));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(&energy), vsum);
+    }
+#endif
+    for (; i < count; ++i) {
+        const int v = pcm[i];
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+        energy += qint64(v) * v;
+    }
+}
+
+// Bins [first, first + count) of one level folded into a single bin of the
+// next.
+template <typename Level>
+auto fold(const Level &bins, qsizetype first, qsizetype count) {
+    auto out = bins[first];
+    double energy = double(out.rms) * out.rms;
+    for (qsizetype i = first + 1; i < first + count; ++i) {
+        out.min = std::min(out.min, bins[i].min);
+        out.max = std::max(out.max, bins[i].max);
+        energy += double(bins[i].rms) * bins[i].rms;
+    }
+    out.rms = quint16(std::lround(std::sqrt(energy / count)));
+    return out;
+}
+}
+
+qint64 WaveformPyramid::binSamples(int level) {
+    return qint64(kBaseBinSamples) << (2 * level); // kFanIn == 4
+}
+
+void WaveformPyramid::push(int level, const Bin &bin) {
+    if (m_levels.size() <= level) m_levels.resize(level + 1);
+    Level &bins = m_levels[level];
+    bins.append(bin);
+    if (bins.size() % kFanIn == 0) push(level + 1, fold(bins, bins.size() - kFanIn, kFanIn));
+}
+
+void WaveformPyramid::addBaseBin(const qint16 *pcm, qsizetype count) {
+    int lo, hi;
+    qint64 energy;
+    summarize(pcm, count, lo, hi, energy);
+    m_peak = std::min(32767, std::max({m_peak, std::abs(lo), std::abs(hi)}));
+    push(0, Bin{qint16(lo), qint16(hi), quint16(std::lround(std::sqrt(double(energy) / count)))});
+}
+
+void WaveformPyramid::append(const qint16 *samples, qsizetype count) {
+    m_samples += count;
+    if (!m_tail.empty()) {
+        const qsizetype take = std::min<qsizetype>(count, kBaseBinSamples - qsizetype(m_tail.size()));
+        m_tail.insert(m_tail.end(), samples, samples + take);
+        samples += take;
+        count -= take;
+        if (m_tail.size() < size_t(kBaseBinSamples)) return;
+        addBaseBin(m_tail.data(), kBaseBinSamples);
+        m_tail.clear();
+    }
+    for (; count >= kBaseBinSamples; samples += kBaseBinSamples, count -= kBaseBinSamples)
+        addBaseBin(samples, kBaseBinSamples);
+    if (count > 0) m_tail.insert(m_tail.end(), samples, samples + count);
+}
+
+void WaveformPyramid::finish() {
+    // A short last bin, summarized like any other.
+    if (!m_tail.empty()) {
+        addBaseBin(m_tail.data(), qsizetype(m_tail.size()));
+        m_tail.clear();
+    }
+    // Fold each level's leftover (< kFanIn) bins upward until one bin covers
+    // the whole track.
+    for (int level = 0; level < m_levels.size() && m_levels[level].size() > 1; ++level) {
+        const Level &bins = m_levels[level];
+        const qsizetype covered = level + 1 < m_levels.size() ? m_levels[level + 1].size() * kFanIn : 0;
+        if (bins.size() > covered) push(level + 1, fold(bins, covered, bins.size() - covered));
+    }
+    detectOnsets();
+}
+
+// Energy onsets on the 10 ms level: a frame well above a noise floor that
+// drops fast and rises slowly (~0.5 s), clearly louder than 30 ms before,
+// and at least 150 ms after the previous onset. Its time is then refined to
+// the first 2.5 ms base bin reaching half the frame's level.
+void WaveformPyramid::detectOnsets() {
+    m_onsets.clear();
+    if (m_levels.size() < 2) return;
+    constexpr double kRiseOverFloor = 4.0;  // ~12 dB
+    constexpr double kRiseOverRecent = 2.0; // ~6 dB
+    constexpr double kMinFloor = 30.0;      // ~-60 dBFS
+    constexpr int kMinLevel = 330;          // ~-40 dBFS
+    constexpr int kLookBack = 3;
+    constexpr int kMinGap = 15;
+
+    const Level &frames = m_levels[1];
+    const Level &base = m_levels[0];
+    double floor = frames.isEmpty() ? 0.0 : frames[0].rms;
+    int last = -kMinGap;
+    for (int i = 0; i < frames.size(); ++i) {
+        const double level = frames[i].rms;
+        const double recent = frames[std::max(0, i - kLookBack)].rms;
+        if (level >= kMinLevel && level > std::max(floor, kMinFloor) * kRiseOverFloor &&
+            level > recent * kRiseOverRecent && i - last >= kMinGap) {
+            qsizetype bin = std::max<qsizetype>(0, qsizetype(i - 1) * kFanIn);
+            const qsizetype end = std::min<qsizetype>(base.size(), qsizetype(i + 1) * kFanIn);
+            while (bin + 1 < end && base[bin].rms < level / 2) ++bin;
+            m_onsets.append(qint64(bin) * kBaseBinSamples * 1000 / kSampleRate);
+            last = i;
+        }
+        floor += (level < floor ? 0.5 : 0.02) * (level - floor);
+    }
+}
+
+WaveformPyramid::Range WaveformPyramid::range(qint64 fromMs, qint64 toMs) const {
+    Range out;
+    if (isEmpty()) return out;
+    const qint64 binned = qint64(m_levels[0].size()) * kBaseBinSamples;
+    const qint64 fromS = std::max<qint64>(0, fromMs * kSampleRate / 1000);
+    const qint64 toS = std::min(binned, std::max(fromS + 1, toMs * kSampleRate / 1000));
+    if (fromS >= toS) return out;
+
+    // Coarsest level with at least two bins across the span, stepped back
+    // down where it hasn't been built that far yet (still decoding).
+    int level = 0;
+    while (level + 1 < m_levels.size() && binSamples(level + 1) * 2 <= toS - fromS) ++level;
+    while (level > 0 && (toS - 1) / binSamples(level) >= m_levels[level].size()) --level;
+
+    const qsizetype first = qsizetype(fromS / binSamples(level));
+    const qsizetype last = qsizetype((toS - 1) / binSamples(level));
+    const Bin b = fold(m_levels[level], first, last - first + 1);
+    out.min = b.min / 32768.0f;
+    out.max = b.max / 32767.0f;
+    out.rms = b.rms / 32768.0f;
+    out.valid = true;
+    return out;
+}
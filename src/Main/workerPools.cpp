@@ -0,0 +1,131 @@
+#include "../Includes/workerPools.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace {
+
+struct PoolState {
+    QThreadPool pool;
+    std::atomic<int> queued{0};
+    std::atomic<int> peakQueued{0};
+    std::atomic<quint64> started{0};
+    std::atomic<quint64> completed{0};
+    std::atomic<qint64> totalWaitNs{0};
+    std::atomic<qint64> maxWaitNs{0};
+};
+
+// Automatic sizes. The preview pool gets every core: one runs the frame
+// worker, the rest take its band jobs. Analysis gets half, at low priority,
+// so it soaks up idle cores without competing with playback. File I/O
+// threads mostly sleep in the kernel; two keep one slow disk write from
+// holding up the next. Interface work is short and bursty (a screenful of
+// timeline tiles); two threads at normal priority keep it off the GUI
+// thread without crowding the preview.
+int automaticThreadCount(WorkerPools::Kind kind) {
+    const int cores = qMax(1, QThread::idealThreadCount());
+    switch (kind) {
+        case WorkerPools::Preview:  return qMax(2, cores);
+        case WorkerPools::Analysis: return qMax(1, cores / 2);
+        default:                    return 2;
+    }
+}
+
+QThread::Priority defaultPriority(WorkerPools::Kind kind) {
+    switch (kind) {
+        case WorkerPools::Preview:  return QThread::HighPriority;
+        case WorkerPools::Analysis: return QThread::LowPriority;
+        default:                    return QThread::NormalPriority;
+    }
+}
+
+PoolState &state(WorkerPools::Kind kind) {
+    static PoolState states[WorkerPools::KindCount];
+    static const bool initialized = [] {
+        for (int k = 0; k < WorkerPools::KindCount; ++k) {
+            const auto kind = static_cast<WorkerPools::Kind>(k);
+            states[k].pool.setObjectName(WorkerPools::name(kind));
+            states[k].pool.setMaxThreadCount(automaticThreadCount(kind));
+            states[k].pool.setThreadPriority(defaultPriority(kind));
+        }
+        return true;
+    }();
+    (void)initialized;
+    return states[qBound(0, int(kind), WorkerPools::KindCount - 1)];
+}
+
+void updateMax(std::atomic<int> &peak, int value) {
+    int seen = peak.load(std::memory_order_relaxed);
+    while (value > seen && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+}
+
+void updateMax(std::atomic<qint64> &peak, qint64 value) {
+    qint64 seen = peak.load(std::memory_order_relaxed);
+    while (value > seen && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+}
+
+}
+
+namespace WorkerPools {
+
+QThreadPool *pool(Kind kind) {
+    return &state(kind).pool;
+}
+
+QString name(Kind kind) {
+    switch (kind) {
+        case Preview:  return "Preview";
+        case Analysis:  return "Analysis";
+        case Interface: return "Interface";
+        default:        return "FileIO";
+    }
+}
+
+void setThreadCount(Kind kind, int threadCount) {
+    state(kind).pool.setMaxThreadCount(threadCount > 0 ? threadCount : automaticThreadCount(kind));
+}
+
+// Applies to threads the pool starts from now on; idle ones expire (30 s)
+// and come back at the new priority.
+void setPriority(Kind kind, QThread::Priority priority) {
+    state(kind).pool.setThreadPriority(priority);
+}
+
+PoolStats stats(Kind kind) {
+    PoolState &s = state(kind);
+    PoolStats out;
+    out.maxThreads = s.pool.maxThreadCount();
+    out.activeThreads = s.pool.activeThreadCount();
+    out.queued = s.queued.load(std::memory_order_relaxed);
+    out.peakQueued = s.peakQueued.load(std::memory_order_relaxed);
+    out.completed = s.completed.load(std::memory_order_relaxed);
+    const quint64 started = s.started.load(std::memory_order_relaxed);
+    if (started > 0) out.avgWaitMs = s.totalWaitNs.load(std::memory_order_relaxed) / 1e6 / started;
+    out.maxWaitMs = s.maxWaitNs.load(std::memory_order_relaxed) / 1e6;
+    return out;
+}
+
+qint64 nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void noteQueued(Kind kind) {
+    PoolState &s = state(kind);
+    updateMax(s.peakQueued, s.queued.fetch_add(1, std::memory_order_relaxed) + 1);
+}
+
+void noteStarted(Kind kind, qint64 queuedAtNs) {
+    PoolState &s = state(kind);
+    const qint64 waitNs = qMax<qint64>(0, nowNs() - queuedAtNs);
+    s.queued.fetch_sub(1, std::memory_order_relaxed);
+    s.started.fetch_add(1, std::memory_order_relaxed);
+    s.totalWaitNs.fetch_add(waitNs, std::memory_order_relaxed);
+    updateMax(s.maxWaitNs, waitNs);
+}
+
+void noteFinished(Kind kind) {
+    state(kind).completed.fetch_add(1, std::memory_order_relaxed);
+}
+
+}